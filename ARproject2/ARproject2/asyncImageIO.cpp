@@ -0,0 +1,641 @@
+#include "asyncImageIO.h"
+#include "qoi.h"
+#include "tracing.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define ASYNC_IO_URING
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+// Jedan zahtjev za citanje ili upisivanje fajla; zivi od poziva load()/save() do poziva callback funkcije
+struct AsyncImageIO::Request {
+    enum Kind { Load, Save } kind;
+    std::string path;
+    std::vector<uint8_t> data;  // sadrzaj fajla (bafer iz bazena)
+    size_t size = 0;            // broj bajtova za citanje ili upis
+    size_t done = 0;            // koliko je vec procitano ili upisano
+    int fd = -1;
+    int error = 0;              // errno prve greske, 0 ako je sve uspjelo
+    std::string message;        // opis greske koja nije samo errno (npr. neispravan QOI fajl)
+    Image image = Image(0, 0);  // za upis QOI fajla (kodira se u bazenu niti)
+#ifdef ASYNC_IO_URING
+    iovec vector;
+#endif
+    std::function<void(AsyncLoadResult&)> onLoad;
+    std::function<void(bool)> onSave;
+
+    Request(Kind k, const std::string& p) : kind(k), path(p) {}
+};
+
+#ifdef ASYNC_IO_URING
+/*
+    Minimalan io_uring bez biblioteke liburing: dva prstena dijeljena sa jezgrom (submission i completion),
+    mapirana preko mmap. Zahtjev se upisuje u slobodan SQE, njegov indeks u niz prstena, a zatim se pomjera
+    rep prstena (store-release), tako da jezgro vidi potpun zahtjev. Zavrseni zahtjevi se citaju od glave
+    completion prstena do repa (load-acquire), a glava se zatim pomjera da jezgro moze ponovo koristiti mjesta.
+*/
+struct AsyncImageIO::Ring {
+    int fd = -1;
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqMask = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned sqEntries = 0;
+    io_uring_sqe* sqes = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned* cqMask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+
+    void* sqRing = MAP_FAILED;
+    void* cqRing = MAP_FAILED;
+    size_t sqRingSize = 0, cqRingSize = 0, sqesSize = 0;
+    unsigned queued = 0;  // pripremljeni, a jos nepredati zahtjevi
+
+    bool open(unsigned entries) {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0)
+            return false;
+
+        sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMap)
+            sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+
+        sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sqRing == MAP_FAILED)
+            return false;
+        cqRing = singleMap ? sqRing : mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED)
+            return false;
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqesMap = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (sqesMap == MAP_FAILED)
+            return false;
+
+        char* sq = static_cast<char*>(sqRing);
+        char* cq = static_cast<char*>(cqRing);
+        sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sqEntries = params.sq_entries;
+        sqes = static_cast<io_uring_sqe*>(sqesMap);
+        cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    ~Ring() {
+        if (sqes)
+            munmap(sqes, sqesSize);
+        if (cqRing != MAP_FAILED && cqRing != sqRing)
+            munmap(cqRing, cqRingSize);
+        if (sqRing != MAP_FAILED)
+            munmap(sqRing, sqRingSize);
+        if (fd >= 0)
+            close(fd);
+    }
+
+    // Broj slobodnih mjesta u submission prstenu (jezgro oslobadja mjesto kada preuzme zahtjev)
+    unsigned space() const {
+        return sqEntries - (*sqTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE));
+    }
+
+    /*
+        Sljedeci slobodan SQE (popunjen nulama) ili nullptr ako je prsten pun. Broj zahtjeva u letu je ogranicen,
+        ali nakon djelimicnog predavanja (enter preuzme manje zahtjeva nego sto ih je pripremljeno)
+        nepreuzeti zahtjevi i dalje zauzimaju mjesta, pa pozivalac mora provjeriti rezultat.
+    */
+    io_uring_sqe* next() {
+        if (space() == 0)
+            return nullptr;
+        unsigned tail = *sqTail;
+        unsigned index = tail & *sqMask;
+        io_uring_sqe* sqe = &sqes[index];
+        memset(sqe, 0, sizeof(*sqe));
+        sqArray[index] = index;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        ++queued;
+        return sqe;
+    }
+
+    // Predaje pripremljene zahtjeve i ceka bar `minComplete` zavrsenih
+    int enter(unsigned minComplete) {
+        int result;
+        do {
+            result = static_cast<int>(syscall(__NR_io_uring_enter, fd, queued, minComplete, minComplete ? IORING_ENTER_GETEVENTS : 0, nullptr, 0));
+        } while (result < 0 && errno == EINTR);
+        if (result >= 0)
+            queued -= std::min(queued, static_cast<unsigned>(result));
+        return result;
+    }
+
+    // Broj zavrsenih zahtjeva koji cekaju u completion prstenu
+    unsigned completions() const {
+        return __atomic_load_n(cqTail, __ATOMIC_ACQUIRE) - *cqHead;
+    }
+
+    // Pripremljeni zahtjevi koje jezgro nije preuzelo se uklanjaju iz prstena (handler dobija user_data svakog)
+    template <typename Handler>
+    void discardQueued(Handler handler) {
+        unsigned head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+        for (unsigned i = head; i != *sqTail; ++i)
+            handler(sqes[sqArray[i & *sqMask]].user_data);
+        __atomic_store_n(sqTail, head, __ATOMIC_RELEASE);
+        queued = 0;
+    }
+
+    template <typename Handler>
+    void drain(Handler handler) {
+        unsigned head = *cqHead;
+        while (head != __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+            const io_uring_cqe& cqe = cqes[head & *cqMask];
+            handler(cqe.user_data, cqe.res);
+            ++head;
+        }
+        __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+    }
+};
+#else
+struct AsyncImageIO::Ring {
+    bool open(unsigned) { return false; }
+};
+#endif
+
+AsyncImageIO::AsyncImageIO(int queueDepth) : depth(std::max(1, queueDepth)), outstanding(0), stopping(false), ringFailed(false), wakeFd(-1) {
+    const char* backend = std::getenv("CONVOLUTION_IO_BACKEND");
+    bool forceThreads = backend && std::string(backend) == "threads";
+
+    ring.reset(new Ring());
+    if (forceThreads || !ring->open(static_cast<unsigned>(depth) + 1))
+        ring.reset();
+#ifdef ASYNC_IO_URING
+    if (ring) {
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wakeFd < 0)
+            ring.reset();
+    }
+#endif
+
+    // Uz io_uring niti samo dekodiraju; bez njega svaka nit drzi jedan blokirajuci zahtjev
+    unsigned hardware = std::max(2u, std::thread::hardware_concurrency());
+    int workerCount = ring ? static_cast<int>(hardware) : std::min(depth, 256);
+    for (int i = 0; i < workerCount; ++i)
+        workers.emplace_back(&AsyncImageIO::workerLoop, this);
+    if (ring)
+        ioThread = std::thread(&AsyncImageIO::ioLoop, this);
+}
+
+AsyncImageIO::~AsyncImageIO() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskReady.notify_all();
+    wake();
+    if (ioThread.joinable())
+        ioThread.join();
+    for (std::thread& worker : workers)
+        worker.join();
+#ifdef ASYNC_IO_URING
+    if (wakeFd >= 0)
+        close(wakeFd);
+#endif
+}
+
+bool AsyncImageIO::usingIoUring() const {
+    return ring != nullptr;
+}
+
+const char* AsyncImageIO::backendName() const {
+    return ring ? "io_uring" : "bazen niti";
+}
+
+std::vector<uint8_t> AsyncImageIO::acquireBuffer() {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    if (freeBuffers.empty())
+        return std::vector<uint8_t>();
+    std::vector<uint8_t> buffer = std::move(freeBuffers.back());
+    freeBuffers.pop_back();
+    return buffer;
+}
+
+// Bafer se vraca u bazen sa zadrzanim kapacitetom; bazen ne drzi vise bafera nego sto ih moze biti u letu
+void AsyncImageIO::releaseBuffer(std::vector<uint8_t>&& buffer) {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    if (freeBuffers.size() < static_cast<size_t>(depth) * 2)
+        freeBuffers.push_back(std::move(buffer));
+}
+
+void AsyncImageIO::post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    taskReady.notify_one();
+}
+
+void AsyncImageIO::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            taskReady.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty())
+                return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void AsyncImageIO::wake() {
+#ifdef ASYNC_IO_URING
+    if (wakeFd >= 0) {
+        uint64_t one = 1;
+        ssize_t written = write(wakeFd, &one, sizeof(one));
+        (void)written;
+    }
+#endif
+}
+
+// Zahtjev ide I/O niti (io_uring) ili direktno u bazen niti (blokirajuci nacin, QOI fajlovi i nakon greske io_uring-a)
+void AsyncImageIO::submit(Request* request) {
+    bool queued = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++outstanding;
+        if (ring && !ringFailed && !isQOIPath(request->path)) {
+            pending.push_back(request);
+            queued = true;
+        }
+    }
+
+    if (queued)
+        wake();
+    else if (request->kind == Request::Load) {
+        post([this, request] { loadBlocking(request); });
+    }
+    else {
+        post([this, request] { saveBlocking(request); });
+    }
+}
+
+void AsyncImageIO::load(const std::string& path, std::function<void(AsyncLoadResult&)> callback) {
+    Request* request = new Request(Request::Load, path);
+    request->onLoad = std::move(callback);
+    submit(request);
+}
+
+std::future<AsyncLoadResult> AsyncImageIO::load(const std::string& path) {
+    std::shared_ptr<std::promise<AsyncLoadResult>> promise(new std::promise<AsyncLoadResult>());
+    load(path, [promise](AsyncLoadResult& result) { promise->set_value(std::move(result)); });
+    return promise->get_future();
+}
+
+void AsyncImageIO::save(const std::string& path, const Image& image, std::function<void(bool)> callback) {
+    Request* request = new Request(Request::Save, path);
+    request->onSave = std::move(callback);
+    if (isQOIPath(path)) {
+        request->image = image;
+    }
+    else {
+        request->data = acquireBuffer();
+        encodeBMP(ConstImageView(image), request->data);
+        request->size = request->data.size();
+    }
+    submit(request);
+}
+
+std::future<bool> AsyncImageIO::save(const std::string& path, const Image& image) {
+    std::shared_ptr<std::promise<bool>> promise(new std::promise<bool>());
+    save(path, image, [promise](bool ok) { promise->set_value(ok); });
+    return promise->get_future();
+}
+
+void AsyncImageIO::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return outstanding == 0; });
+}
+
+/*
+    I/O nit (samo uz io_uring). Uzima zahtjeve iz reda dok ih u letu nema `depth`, otvara fajlove i predaje
+    citanja i upise jezgru, a zatim jednim sistemskim pozivom predaje nove i ceka zavrsene zahtjeve.
+    Da bi nit mogla da se probudi i kada stigne novi zahtjev (a ne samo kada se zavrsi neki u letu),
+    u prstenu je uvijek i POLL zahtjev nad eventfd-om, u koji load()/save() upisuju (user_data == 0).
+    Nepotpuno citanje ili upis se nastavlja novim zahtjevom od mjesta gdje je stao.
+    Ako jezgro odbije predavanje (osim privremenog EBUSY/EAGAIN dok ima zavrsenih zahtjeva za preuzimanje),
+    svi zahtjevi u prstenu se zavrsavaju sa tom greskom, a oni koji jos nisu poceli i svi novi idu u bazen niti,
+    tako da wait() i destruktor nikada ne cekaju zahtjev koji se nece zavrsiti.
+*/
+void AsyncImageIO::ioLoop() {
+#ifdef ASYNC_IO_URING
+    int inFlight = 0;
+    bool pollArmed = false;
+
+    while (true) {
+        if (!pollArmed) {
+            io_uring_sqe* sqe = ring->next();
+            if (sqe) {
+                sqe->opcode = IORING_OP_POLL_ADD;
+                sqe->fd = wakeFd;
+                sqe->poll_events = POLLIN;
+                sqe->user_data = 0;
+                pollArmed = true;
+            }
+        }
+
+        // Novi zahtjev zauzima jedno mjesto u prstenu; ako mjesta nema, ceka sljedeci krug
+        std::vector<Request*> ready;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping && pending.empty() && inFlight == 0)
+                break;
+            unsigned space = ring->space();
+            while (inFlight + static_cast<int>(ready.size()) < depth && ready.size() < space && !pending.empty()) {
+                ready.push_back(pending.front());
+                pending.pop_front();
+            }
+        }
+        for (Request* request : ready) {
+            if (start(request))
+                ++inFlight;
+            else
+                finish(request);
+        }
+
+        if (ring->enter(1) < 0) {
+            int error = errno;
+            if ((error != EBUSY && error != EAGAIN) || ring->completions() == 0) {
+                failRing(error, inFlight);
+                return;
+            }
+        }
+
+        ring->drain([&](uint64_t userData, int result) {
+            if (userData == 0) {
+                uint64_t count;
+                ssize_t received = read(wakeFd, &count, sizeof(count));
+                (void)received;
+                pollArmed = false;
+                return;
+            }
+
+            Request* request = reinterpret_cast<Request*>(userData);
+            if (result < 0 || (result == 0 && request->done < request->size))
+                request->error = result < 0 ? -result : EIO;
+            else
+                request->done += result;
+
+            if (request->error == 0 && request->done < request->size) {
+                io_uring_sqe* sqe = ring->next();
+                if (sqe) {
+                    request->vector.iov_base = request->data.data() + request->done;
+                    request->vector.iov_len = request->size - request->done;
+                    sqe->opcode = request->kind == Request::Load ? IORING_OP_READV : IORING_OP_WRITEV;
+                    sqe->fd = request->fd;
+                    sqe->addr = reinterpret_cast<uint64_t>(&request->vector);
+                    sqe->len = 1;
+                    sqe->off = request->done;
+                    sqe->user_data = userData;
+                    return;
+                }
+                request->error = EBUSY;
+            }
+
+            --inFlight;
+            finish(request);
+        });
+    }
+#endif
+}
+
+/*
+    Obrada greske io_uring_enter (samo I/O nit). Zahtjevi koje jezgro nije preuzelo i oni koji su u letu
+    se zavrsavaju sa greskom `error` (na one u letu se ceka, jer jezgro jos koristi njihove bafere),
+    a zahtjevi koji jos nisu poceli se prebacuju u bazen niti, kao i svi kasniji zahtjevi.
+*/
+void AsyncImageIO::failRing(int error, int& inFlight) {
+#ifdef ASYNC_IO_URING
+    std::cerr << "io_uring nije dostupan (" << strerror(error) << "), prelazi se na bazen niti." << std::endl;
+
+    std::deque<Request*> notStarted;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ringFailed = true;
+        notStarted.swap(pending);
+    }
+    for (Request* request : notStarted) {
+        if (request->kind == Request::Load)
+            post([this, request] { loadBlocking(request); });
+        else
+            post([this, request] { saveBlocking(request); });
+    }
+
+    ring->discardQueued([&](uint64_t userData) {
+        if (userData == 0)
+            return;
+        Request* request = reinterpret_cast<Request*>(userData);
+        request->error = error;
+        --inFlight;
+        finish(request);
+    });
+
+    while (inFlight > 0) {
+        if (ring->completions() == 0) {
+            pollfd entry = { ring->fd, POLLIN, 0 };
+            if (poll(&entry, 1, -1) < 0 && errno != EINTR)
+                break;
+        }
+        ring->drain([&](uint64_t userData, int result) {
+            if (userData == 0)
+                return;
+            Request* request = reinterpret_cast<Request*>(userData);
+            if (result < 0)
+                request->error = -result;
+            else if (request->done + result < request->size)
+                request->error = error;
+            --inFlight;
+            finish(request);
+        });
+    }
+#else
+    (void)error;
+    (void)inFlight;
+#endif
+}
+
+// Otvaranje fajla i priprema prvog zahtjeva; vraca false (uz postavljen `error`) ako fajl nije moguce otvoriti
+bool AsyncImageIO::start(Request* request) {
+#ifdef ASYNC_IO_URING
+    if (request->kind == Request::Load) {
+        request->fd = open(request->path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat info;
+        if (request->fd < 0 || fstat(request->fd, &info) != 0) {
+            request->error = errno;
+            return false;
+        }
+        request->size = static_cast<size_t>(info.st_size);
+        if (request->size == 0) {
+            request->error = EIO;
+            return false;
+        }
+        request->data = acquireBuffer();
+        request->data.resize(request->size);
+    }
+    else {
+        request->fd = open(request->path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (request->fd < 0) {
+            request->error = errno;
+            return false;
+        }
+    }
+
+    io_uring_sqe* sqe = ring->next();
+    if (!sqe) {
+        request->error = EBUSY;
+        return false;
+    }
+    request->vector.iov_base = request->data.data();
+    request->vector.iov_len = request->size;
+    sqe->opcode = request->kind == Request::Load ? IORING_OP_READV : IORING_OP_WRITEV;
+    sqe->fd = request->fd;
+    sqe->addr = reinterpret_cast<uint64_t>(&request->vector);
+    sqe->len = 1;
+    sqe->off = 0;
+    sqe->user_data = reinterpret_cast<uint64_t>(request);
+    return true;
+#else
+    request->error = ENOSYS;
+    return false;
+#endif
+}
+
+// Zatvaranje fajla u I/O niti; dekodiranje i callback se prepustaju bazenu niti
+void AsyncImageIO::finish(Request* request) {
+#ifdef ASYNC_IO_URING
+    if (request->fd >= 0) {
+        close(request->fd);
+        request->fd = -1;
+    }
+#endif
+    post([this, request] { deliver(request); });
+}
+
+// Dekodiranje procitanog fajla, poziv callback funkcije i oslobadjanje zahtjeva
+void AsyncImageIO::deliver(Request* request) {
+    if (request->kind == Request::Load) {
+        TRACE_SCOPE("asyncLoad");
+        AsyncLoadResult result;
+        result.path = request->path;
+        if (!request->message.empty()) {
+            result.error = request->message;
+        }
+        else if (request->error != 0) {
+            result.error = "Nije moguće pročitati fajl: " + request->path + " (" + strerror(request->error) + ")";
+        }
+        else if (request->data.empty()) {
+            // QOI fajl je vec dekodiran u bazenu niti
+            result.image = std::move(request->image);
+            result.ok = true;
+        }
+        else if (tryDecodeBMP<Color>(request->data.data(), request->size, request->path, result.image, result.error)) {
+            // Neispravan fajl se prijavljuje kroz rezultat; decodeBMP bi prekinuo cijeli program iz niti bazena
+            result.ok = true;
+            TRACE_PIXELS(result.image.pixels.size());
+            TRACE_BYTES_READ(request->size);
+        }
+        releaseBuffer(std::move(request->data));
+        if (request->onLoad)
+            request->onLoad(result);
+    }
+    else {
+        TRACE_SCOPE("asyncSave");
+        bool ok = request->error == 0 && request->message.empty();
+        if (ok) {
+            TRACE_BYTES_WRITTEN(request->size);
+        }
+        else {
+            std::cerr << (request->message.empty() ? "Nije moguće upisati fajl: " + request->path + " (" + strerror(request->error) + ")"
+                : request->message) << std::endl;
+        }
+        releaseBuffer(std::move(request->data));
+        if (request->onSave)
+            request->onSave(ok);
+    }
+    delete request;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (--outstanding == 0)
+        idle.notify_all();
+}
+
+/*
+    Blokirajuce citanje cijelog fajla u bafer iz bazena (kada io_uring nije dostupan, i za QOI fajlove).
+    Greske (i kod QOI fajlova) se prijavljuju kroz rezultat; loadImage bi prekinuo cijeli program iz niti bazena.
+*/
+void AsyncImageIO::loadBlocking(Request* request) {
+    if (isQOIPath(request->path)) {
+        if (!tryLoadQOI<Color>(request->path, request->image, request->message))
+            request->error = EIO;
+        deliver(request);
+        return;
+    }
+
+    errno = 0;
+    std::ifstream file(request->path, std::ios::binary | std::ios::ate);
+    std::error_code status;
+    if (!file) {
+        request->error = errno ? errno : EIO;
+    }
+    else if (!std::filesystem::is_regular_file(request->path, status)) {
+        // Npr. direktorijum: otvara se, ali tellg ne vraca velicinu
+        request->error = status ? status.value() : EISDIR;
+    }
+    else {
+        request->size = static_cast<size_t>(file.tellg());
+        request->data = acquireBuffer();
+        request->data.resize(request->size);
+        file.seekg(0);
+        if (request->size == 0 || !file.read(reinterpret_cast<char*>(request->data.data()), request->size))
+            request->error = EIO;
+    }
+    deliver(request);
+}
+
+void AsyncImageIO::saveBlocking(Request* request) {
+    if (isQOIPath(request->path)) {
+        if (!trySaveQOI(request->path, ConstImageView(request->image), request->message))
+            request->error = EIO;
+    }
+    else {
+        errno = 0;
+        std::ofstream file(request->path, std::ios::binary);
+        if (!file || !file.write(reinterpret_cast<const char*>(request->data.data()), request->size) || !file.flush())
+            request->error = errno ? errno : EIO;
+    }
+    deliver(request);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "image.h"
+
+// Rezultat asinhronog ucitavanja: slika ili opis greske
+struct AsyncLoadResult {
+    std::string path;
+    bool ok = false;
+    Image image = Image(0, 0);
+    std::string error;
+};
+
+/*
+    Asinhrono citanje i upisivanje mnogo malih fajlova slika (batch obrada).
+    Na Linuxu se koristi io_uring: jedna I/O nit drzi do `queueDepth` citanja i upisivanja istovremeno u redu jezgra,
+    pa uredjaj (npr. NVMe) dobija dovoljno zahtjeva da iskoristi svoju dubinu reda, uz jedan sistemski poziv
+    za vise zahtjeva. Fajl se cita cijeli, jednim zahtjevom, u bafer iz bazena (baferi se ponovo koriste),
+    a dekodiranje i pozivi callback funkcija se izvrsavaju u bazenu niti, da I/O nit ne bi cekala.
+    Ako io_uring nije dostupan (drugi OS, stariji kernel, zabranjen u kontejneru) ili je zadano
+    CONVOLUTION_IO_BACKEND=threads, koristi se bazen od `queueDepth` niti sa blokirajucim citanjem,
+    pa je broj zahtjeva u letu jednak broju niti.
+    QOI fajlovi se uvijek citaju i upisuju u bazenu niti (tryLoadQOI / trySaveQOI).
+    Greske (nepostojeci, neispravan ili skracen fajl, neuspio upis) nikada ne prekidaju program,
+    nego se prijavljuju kroz AsyncLoadResult::error, odnosno kao false u callback funkciji upisa.
+*/
+class AsyncImageIO {
+public:
+    explicit AsyncImageIO(int queueDepth = 64);
+    ~AsyncImageIO();
+
+    bool usingIoUring() const;
+    const char* backendName() const;
+
+    // Callback se poziva iz niti bazena; slika u rezultatu se moze premjestiti (std::move)
+    void load(const std::string& , std::function<void(AsyncLoadResult&)> );
+    std::future<AsyncLoadResult> load(const std::string& );
+
+    // Slika se kodira odmah (u pozivajucoj niti), pa se moze mijenjati cim se funkcija vrati
+    void save(const std::string& , const Image& , std::function<void(bool)> );
+    std::future<bool> save(const std::string& , const Image& );
+
+    // Ceka da se zavrse svi zahtjevi, ukljucujuci i one pokrenute iz callback funkcija
+    void wait();
+
+private:
+    struct Request;
+    struct Ring;
+
+    int depth;
+    std::unique_ptr<Ring> ring;
+
+    std::mutex mutex;
+    std::condition_variable idle;
+    size_t outstanding;
+    bool stopping;
+    bool ringFailed;  // io_uring je odbio predavanje; svi zahtjevi idu u bazen niti
+
+    // Zahtjevi koji cekaju I/O nit (io_uring) i probudjivanje te niti (eventfd)
+    std::deque<Request*> pending;
+    int wakeFd;
+    std::thread ioThread;
+
+    // Bazen niti: dekodiranje, callback funkcije i blokirajuce citanje kada io_uring nije dostupan
+    std::deque<std::function<void()>> tasks;
+    std::condition_variable taskReady;
+    std::vector<std::thread> workers;
+
+    // Bazen bafera za sadrzaj fajlova
+    std::mutex bufferMutex;
+    std::vector<std::vector<uint8_t>> freeBuffers;
+
+    std::vector<uint8_t> acquireBuffer();
+    void releaseBuffer(std::vector<uint8_t>&& );
+
+    void post(std::function<void()> );
+    void workerLoop();
+    void wake();
+    void submit(Request* );
+
+    void ioLoop();
+    bool start(Request* );
+    void finish(Request* );
+    void deliver(Request* );
+    void failRing(int , int& );
+
+    void loadBlocking(Request* );
+    void saveBlocking(Request* );
+};
@@ -0,0 +1,370 @@
+#include "autoTuner.h"
+#include "tracing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+
+    typedef std::chrono::steady_clock Clock;
+
+    int maxThreads() {
+#ifdef _OPENMP
+        return omp_get_max_threads();
+#else
+        return 1;
+#endif
+    }
+
+    void setThreads(int threads) {
+#ifdef _OPENMP
+        omp_set_num_threads(std::max(1, threads));
+#else
+        (void)threads;
+#endif
+    }
+
+    bool parseBackend(const std::string& name, ConvolutionBackend& backend) {
+        for (ConvolutionBackend candidate : { ConvolutionBackend::Direct, ConvolutionBackend::Tiled, ConvolutionBackend::Separable }) {
+            if (name == backendName(candidate)) {
+                backend = candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    struct Candidate {
+        ConvolutionBackend backend;
+        int tileSize;
+        int threads;
+    };
+
+    template <typename PixelT>
+    void runCandidate(const Candidate& candidate, const BasicImage<PixelT>& input, const std::vector<float>& kernel,
+        const std::vector<float>& column, const std::vector<float>& row, BasicImage<PixelT>& output, BorderMode border) {
+        switch (candidate.backend) {
+        case ConvolutionBackend::Tiled:
+            convolutionTiled(input, kernel, output, border, candidate.tileSize);
+            break;
+        case ConvolutionBackend::Separable:
+            convolutionSeparable(input, column, row, output, border);
+            break;
+        default:
+            convolution(input, kernel, output, border);
+            break;
+        }
+    }
+
+    int maxDifference(const Image& a, const Image& b) {
+        const uint8_t* x = reinterpret_cast<const uint8_t*>(a.pixels.data());
+        const uint8_t* y = reinterpret_cast<const uint8_t*>(b.pixels.data());
+        int difference = 0;
+        for (size_t i = 0; i < a.pixels.size() * 3; ++i)
+            difference = std::max(difference, std::abs(x[i] - y[i]));
+        return difference;
+    }
+}
+
+const char* backendName(ConvolutionBackend backend) {
+    switch (backend) {
+    case ConvolutionBackend::Tiled:
+        return "tiled";
+    case ConvolutionBackend::Separable:
+        return "separable";
+    default:
+        return "direct";
+    }
+}
+
+bool TuningProfile::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file)
+        return false;
+
+    entries.clear();
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream fields(line);
+        TuningEntry entry;
+        int separable;
+        std::string backend;
+        if (fields >> entry.pixels >> entry.kernelSize >> separable >> backend >> entry.tileSize >> entry.threads >> entry.milliseconds
+            && parseBackend(backend, entry.backend)) {
+            entry.separable = separable != 0;
+            entries.push_back(entry);
+        }
+    }
+    return !entries.empty();
+}
+
+bool TuningProfile::save(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file)
+        return false;
+
+    file << "# Profil podesavanja konvolucije (" << maxThreads() << " niti)" << std::endl
+        << "# piksela velicina_kernela separabilan nacin plocica niti ms" << std::endl;
+    for (const TuningEntry& entry : entries) {
+        file << entry.pixels << " " << entry.kernelSize << " " << (entry.separable ? 1 : 0) << " " << backendName(entry.backend)
+            << " " << entry.tileSize << " " << entry.threads << " " << std::fixed << std::setprecision(3) << entry.milliseconds << std::endl;
+    }
+    return static_cast<bool>(file);
+}
+
+void TuningProfile::add(const TuningEntry& entry) {
+    entries.push_back(entry);
+}
+
+/*
+    Izbor unosa za zadanu sliku i kernel. Separabilan kernel moze koristiti unose izmjerene za separabilne kernele,
+    a ostali samo unose bez separabilnog nacina. Razlika velicina slika se mjeri logaritmom, jer se ponasanje
+    (npr. da li slika staje u kes) mijenja sa redom velicine, a ne sa apsolutnom razlikom u broju piksela.
+*/
+const TuningEntry* TuningProfile::choose(long long pixels, int kernelSize, bool separable) const {
+    const TuningEntry* best = nullptr;
+    double bestDistance = 0.0;
+    for (const TuningEntry& entry : entries) {
+        if (entry.separable != separable)
+            continue;
+        double distance = std::fabs(std::log2(static_cast<double>(std::max(1LL, pixels)) / entry.pixels))
+            + std::fabs(static_cast<double>(kernelSize - entry.kernelSize)) / 2.0;
+        if (best == nullptr || distance < bestDistance) {
+            best = &entry;
+            bestDistance = distance;
+        }
+    }
+    return best;
+}
+
+/*
+    Funkcija automatskog podesavanja. Za svaku velicinu slike i kernela mjeri sve nacine racunanja
+    (direktni, po plocicama za svaku velicinu plocice, separabilni) sa svakim brojem niti, dva puta:
+    sa separabilnim (box) kernelom, gdje su dozvoljeni svi nacini, i sa neseparabilnim (slucajnim) kernelom.
+    Svaki kandidat se prvo provjerava u odnosu na convolution() (dozvoljena razlika je 1 zbog zaokruzivanja),
+    a zatim se uzima najbolje od `repetitions` mjerenja. Pobjednici se cuvaju u profil.
+*/
+int runAutoTune(const AutoTuneOptions& options) {
+    TRACE_SCOPE("autoTune");
+
+    std::vector<int> threadCounts = options.threadCounts;
+    int availableThreads = maxThreads();
+    if (threadCounts.empty()) {
+        for (int threads = 1; threads < availableThreads; threads *= 2)
+            threadCounts.push_back(threads);
+        threadCounts.push_back(availableThreads);
+    }
+
+    std::mt19937 random(12345);
+    TuningProfile profile;
+
+    for (int size : options.imageSizes) {
+        Image input(size, size), reference(size, size), output(size, size);
+        for (Color& pixel : input.pixels)
+            pixel = Color(static_cast<uint8_t>(random()), static_cast<uint8_t>(random()), static_cast<uint8_t>(random()));
+
+        for (int kernelSize : options.kernelSizes) {
+            for (bool separable : { true, false }) {
+                std::vector<float> kernel(static_cast<size_t>(kernelSize) * kernelSize, 1.0f / (kernelSize * kernelSize));
+                if (!separable) {
+                    float sum = 0.0f;
+                    for (float& value : kernel)
+                        sum += value = static_cast<float>(random() % 100 + 1);
+                    for (float& value : kernel)
+                        value /= sum;
+                }
+
+                std::vector<float> column, row;
+                bool canSeparate = separateKernel(kernel, column, row);
+                convolution(input, kernel, reference, BorderMode::Replicate);
+
+                std::vector<Candidate> candidates;
+                for (int threads : threadCounts) {
+                    candidates.push_back({ ConvolutionBackend::Direct, 0, threads });
+                    for (int tileSize : options.tileSizes)
+                        candidates.push_back({ ConvolutionBackend::Tiled, tileSize, threads });
+                    if (canSeparate)
+                        candidates.push_back({ ConvolutionBackend::Separable, 0, threads });
+                }
+
+                TuningEntry best = { static_cast<long long>(size) * size, kernelSize, canSeparate, ConvolutionBackend::Direct, 0, availableThreads, -1.0 };
+                for (const Candidate& candidate : candidates) {
+                    setThreads(candidate.threads);
+                    runCandidate(candidate, input, kernel, column, row, output, BorderMode::Replicate);
+                    if (maxDifference(reference, output) > 1)
+                        continue;
+
+                    double fastest = 0.0;
+                    for (int repetition = 0; repetition < options.repetitions; ++repetition) {
+                        auto start = Clock::now();
+                        runCandidate(candidate, input, kernel, column, row, output, BorderMode::Replicate);
+                        double milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+                        fastest = repetition == 0 ? milliseconds : std::min(fastest, milliseconds);
+                    }
+
+                    if (best.milliseconds < 0.0 || fastest < best.milliseconds) {
+                        best.backend = candidate.backend;
+                        best.tileSize = candidate.tileSize;
+                        best.threads = candidate.threads;
+                        best.milliseconds = fastest;
+                    }
+                }
+                setThreads(availableThreads);
+
+                std::cout << std::setw(5) << size << "x" << std::setw(5) << std::left << size << std::right
+                    << " kernel " << std::setw(2) << kernelSize << "x" << std::setw(2) << std::left << kernelSize << std::right
+                    << (canSeparate ? " separabilan   " : " neseparabilan ") << " -> " << std::setw(9) << std::left << backendName(best.backend) << std::right
+                    << " plocica " << std::setw(3) << best.tileSize << ", niti " << std::setw(2) << best.threads
+                    << ", " << std::fixed << std::setprecision(2) << best.milliseconds << " ms" << std::endl;
+                std::cout.unsetf(std::ios::floatfield);
+
+                // Ako slucajni kernel ispadne separabilan, drugi unos bi samo ponovio prvi
+                if (!separable && canSeparate)
+                    continue;
+                profile.add(best);
+            }
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::path directory = std::filesystem::path(options.profilePath).parent_path();
+    if (!directory.empty())
+        std::filesystem::create_directories(directory, error);
+    if (!profile.save(options.profilePath)) {
+        std::cerr << "Nije moguće sačuvati profil: " << options.profilePath << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (options.profilePath == defaultTuningProfilePath())
+        std::cout << "Profil je sacuvan u " << options.profilePath << " i koristi se automatski na ovoj masini" << std::endl;
+    else
+        std::cout << "Profil je sacuvan u " << options.profilePath << " (koristi se sa CONVOLUTION_TUNING_PROFILE=" << options.profilePath << ")" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+std::string defaultTuningProfilePath() {
+    std::string host = "localhost";
+    std::string directory;
+#ifdef _WIN32
+    if (const char* name = std::getenv("COMPUTERNAME"))
+        host = name;
+    const char* local = std::getenv("LOCALAPPDATA");
+    directory = local && *local ? std::string(local) + "\\convolution" : "convolution";
+    return directory + "\\tuning-" + host + ".txt";
+#else
+    char name[256] = {};
+    if (gethostname(name, sizeof(name) - 1) == 0 && name[0] != '\0')
+        host = name;
+    const char* cache = std::getenv("XDG_CACHE_HOME");
+    const char* home = std::getenv("HOME");
+    if (cache && *cache)
+        directory = std::string(cache) + "/convolution";
+    else if (home && *home)
+        directory = std::string(home) + "/.cache/convolution";
+    else
+        directory = ".convolution";
+    return directory + "/tuning-" + host + ".txt";
+#endif
+}
+
+/*
+    Profil se ucitava iz podrazumijevanog fajla ove masine, koji pravi --autotune, pa svaki cvor koristi svoja mjerenja
+    bez rucnog podesavanja. Fajl koji slucajno postoji u radnom direktorijumu se ne koristi, jer profil mijenja nacin
+    racunanja (a time i rezultat, do +/-1) u meniju, kesu i cjevovodu. CONVOLUTION_TUNING_PROFILE zadaje drugi fajl,
+    a prazna vrijednost iskljucuje profil.
+*/
+const TuningProfile& activeTuningProfile() {
+    static TuningProfile profile = [] {
+        TuningProfile loaded;
+        const char* overridePath = std::getenv("CONVOLUTION_TUNING_PROFILE");
+        if (overridePath != nullptr) {
+            if (*overridePath != '\0' && !loaded.load(overridePath))
+                std::cerr << "Nije moguće učitati profil podešavanja: " << overridePath << std::endl;
+            return loaded;
+        }
+
+        std::string path = defaultTuningProfilePath();
+        std::error_code error;
+        if (std::filesystem::exists(path, error) && !loaded.load(path))
+            std::cerr << "Nije moguće učitati profil podešavanja: " << path << std::endl;
+        return loaded;
+    }();
+    return profile;
+}
+
+/*
+    Funkcija koja bira nacin racunanja prema profilu ove masine. Profil je izmjeren na 24-bitnim slikama,
+    pa se za sive i 32-bitne slike unos bira po kolicini podataka (broj bajtova / 3) umjesto broja piksela.
+    Broj niti se mijenja samo kada je pobjednik mjerenja koristio manje niti nego sto je trenutno dozvoljeno,
+    i to samo za ovaj poziv (omp_set_num_threads vazi za nit koja poziva), a zatim se vraca prethodna vrijednost.
+*/
+template <typename PixelT>
+void convolutionTunedCore(const BasicImage<PixelT>& input, const std::vector<float>& kernel, BasicImage<PixelT>& output, BorderMode border) {
+    const TuningProfile& profile = activeTuningProfile();
+    if (profile.empty()) {
+        convolution(input, kernel, output, border);
+        return;
+    }
+
+    std::vector<float> column, row;
+    bool separable = separateKernel(kernel, column, row);
+    int kernelSize = static_cast<int>(std::sqrt(kernel.size()));
+    long long equivalentPixels = static_cast<long long>(input.width) * input.height * PixelTraits<PixelT>::channels / 3;
+    const TuningEntry* choice = profile.choose(equivalentPixels, kernelSize, separable);
+    if (choice == nullptr) {
+        convolution(input, kernel, output, border);
+        return;
+    }
+
+    Candidate candidate = { choice->backend, choice->tileSize, choice->threads };
+    int previousThreads = maxThreads();
+    if (choice->threads >= previousThreads) {
+        runCandidate(candidate, input, kernel, column, row, output, border);
+        return;
+    }
+
+    setThreads(choice->threads);
+    runCandidate(candidate, input, kernel, column, row, output, border);
+    setThreads(previousThreads);
+}
+
+void convolutionTuned(const Image& input, const std::vector<float>& kernel, Image& output, BorderMode border) {
+    convolutionTunedCore(input, kernel, output, border);
+}
+
+void convolutionTuned(const GrayImage& input, const std::vector<float>& kernel, GrayImage& output, BorderMode border) {
+    convolutionTunedCore(input, kernel, output, border);
+}
+
+void convolutionTuned(const ImageBGRA& input, const std::vector<float>& kernel, ImageBGRA& output, BorderMode border) {
+    convolutionTunedCore(input, kernel, output, border);
+}
+
+ConvolutionBackend tunedBackend(const Image& input, const std::vector<float>& kernel) {
+    const TuningProfile& profile = activeTuningProfile();
+    if (profile.empty())
+        return ConvolutionBackend::Direct;
+
+    std::vector<float> column, row;
+    bool separable = separateKernel(kernel, column, row);
+    int kernelSize = static_cast<int>(std::sqrt(kernel.size()));
+    const TuningEntry* choice = profile.choose(static_cast<long long>(input.width) * input.height, kernelSize, separable);
+    return choice ? choice->backend : ConvolutionBackend::Direct;
+}
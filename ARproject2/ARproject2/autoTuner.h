@@ -0,0 +1,74 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "convolution.h"
+
+// Nacini racunanja konvolucije medju kojima bira automatsko podesavanje
+enum class ConvolutionBackend {
+    Direct,     // convolution(): pikseli redom, sve niti dijele redove
+    Tiled,      // convolutionTiled(): niti uzimaju kvadratne plocice
+    Separable   // convolutionSeparable(): dva jednodimenzionalna prolaza (samo za separabilne kernele)
+};
+
+// Najbolji izmjereni izbor za jednu velicinu slike i kernela
+struct TuningEntry {
+    long long pixels;
+    int kernelSize;
+    bool separable;
+    ConvolutionBackend backend;
+    int tileSize;
+    int threads;
+    double milliseconds;
+};
+
+/*
+    Profil podesavanja: pobjednici mjerenja na ovoj masini, sacuvani u tekstualni fajl.
+    Za zadanu sliku i kernel bira se unos sa najblizom velicinom slike (po logaritmu) i kernela.
+*/
+class TuningProfile {
+public:
+    bool load(const std::string& );
+    bool save(const std::string& ) const;
+
+    void add(const TuningEntry& );
+    const TuningEntry* choose(long long , int , bool ) const;
+    bool empty() const { return entries.empty(); }
+
+private:
+    std::vector<TuningEntry> entries;
+};
+
+/*
+    Podrazumijevani profil ove masine: tuning-<ime racunara>.txt u korisnickom kes direktorijumu
+    ($XDG_CACHE_HOME/convolution ili ~/.cache/convolution, na Windowsu %LOCALAPPDATA%\convolution).
+    Ime racunara je u imenu fajla, pa cvorovi sa zajednickim home direktorijumom (NFS) ne dijele profil.
+*/
+std::string defaultTuningProfilePath();
+
+struct AutoTuneOptions {
+    std::string profilePath = defaultTuningProfilePath();
+    std::vector<int> imageSizes = { 256, 1024, 2048 };  // stranica kvadratne test slike
+    std::vector<int> kernelSizes = { 3, 5, 9, 15 };
+    std::vector<int> tileSizes = { 32, 64, 128 };
+    std::vector<int> threadCounts;                      // prazno = 1, 2, 4, ... do broja jezgara
+    int repetitions = 3;                                // uzima se najbolje od N mjerenja
+};
+
+// Mjeri sve nacine i parametre za svaku kombinaciju velicina i cuva pobjednike u profil
+int runAutoTune(const AutoTuneOptions& );
+
+// Profil koji koristi convolutionTuned(); ucitava se jednom, iz CONVOLUTION_TUNING_PROFILE ako je zadan, inace iz defaultTuningProfilePath()
+const TuningProfile& activeTuningProfile();
+
+// Konvolucija koja koristi nacin, velicinu plocice i broj niti iz profila (bez profila isto kao convolution())
+void convolutionTuned(const Image& , const std::vector<float>& , Image& , BorderMode = BorderMode::Replicate);
+
+void convolutionTuned(const GrayImage& , const std::vector<float>& , GrayImage& , BorderMode = BorderMode::Replicate);
+
+void convolutionTuned(const ImageBGRA& , const std::vector<float>& , ImageBGRA& , BorderMode = BorderMode::Replicate);
+
+// Nacin koji convolutionTuned() bira za ovu sliku i kernel (Direct ako profil nije ucitan ili nema unosa)
+ConvolutionBackend tunedBackend(const Image& , const std::vector<float>& );
+
+const char* backendName(ConvolutionBackend );
@@ -0,0 +1,378 @@
+#include "convLayer.h"
+#include "tracing.h"
+
+#include <algorithm>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CONV_LAYER_SSE
+#endif
+
+namespace {
+    /*
+        Velicine blokova za mnozenje matrica. Mikro-kernel racuna blok MR x NR izlaza u registrima
+        (6 x 8 float vrijednosti = 12 SSE registara akumulatora, uz 2 registra za red matrice B i 1 za element A).
+        KC x NC blok matrice B (256 x 256 float vrijednosti = 256 KB) se pakuje tako da ostaje u L2 kesu
+        dok ga prolaze svi paneli matrice A.
+    */
+    const int MR = 6;
+    const int NR = 8;
+    const int KC = 256;
+    const int NC = 256;
+
+    int roundUp(int value, int multiple) {
+        return (value + multiple - 1) / multiple * multiple;
+    }
+
+    /*
+        Mikro-kernel: C[rows x cols] (+)= A panel (kc x MR) * B panel (kc x NR).
+        Paneli su upakovani tako da se u svakom koraku k cita MR uzastopnih elemenata A i NR uzastopnih elemenata B.
+        Ako blok izlaza nije pun (rub matrice), rezultat se racuna u privremeni blok pa se kopira samo validni dio.
+    */
+    void microKernel(int kc, const float* a, const float* b, float* c, int ldc, int rows, int cols, bool accumulate) {
+        alignas(16) float block[MR * NR];
+
+#ifdef CONV_LAYER_SSE
+        __m128 acc[MR][2];
+        for (int r = 0; r < MR; ++r)
+            acc[r][0] = acc[r][1] = _mm_setzero_ps();
+
+        for (int k = 0; k < kc; ++k) {
+            __m128 b0 = _mm_loadu_ps(b);
+            __m128 b1 = _mm_loadu_ps(b + 4);
+            for (int r = 0; r < MR; ++r) {
+                __m128 value = _mm_set1_ps(a[r]);
+                acc[r][0] = _mm_add_ps(acc[r][0], _mm_mul_ps(value, b0));
+                acc[r][1] = _mm_add_ps(acc[r][1], _mm_mul_ps(value, b1));
+            }
+            a += MR;
+            b += NR;
+        }
+
+        for (int r = 0; r < MR; ++r) {
+            _mm_store_ps(block + r * NR, acc[r][0]);
+            _mm_store_ps(block + r * NR + 4, acc[r][1]);
+        }
+#else
+        std::fill(block, block + MR * NR, 0.0f);
+        for (int k = 0; k < kc; ++k) {
+            for (int r = 0; r < MR; ++r)
+                for (int j = 0; j < NR; ++j)
+                    block[r * NR + j] += a[r] * b[j];
+            a += MR;
+            b += NR;
+        }
+#endif
+
+        for (int r = 0; r < rows; ++r) {
+            float* target = c + static_cast<size_t>(r) * ldc;
+            if (accumulate) {
+                for (int j = 0; j < cols; ++j)
+                    target[j] += block[r * NR + j];
+            }
+            else {
+                std::copy(block + r * NR, block + r * NR + cols, target);
+            }
+        }
+    }
+
+    // Pakovanje cijele matrice A (M x K) u panele od MR redova: packed[(p * K + k) * MR + r] = A[p * MR + r][k]
+    std::vector<float> packA(int M, int K, const float* A) {
+        int panels = (M + MR - 1) / MR;
+        std::vector<float> packed(static_cast<size_t>(panels) * K * MR, 0.0f);
+        for (int p = 0; p < panels; ++p)
+            for (int k = 0; k < K; ++k)
+                for (int r = 0; r < MR && p * MR + r < M; ++r)
+                    packed[(static_cast<size_t>(p) * K + k) * MR + r] = A[static_cast<size_t>(p * MR + r) * K + k];
+        return packed;
+    }
+
+    /*
+        Mnozenje upakovanog bloka: svi paneli A (redovi 0..M) puta upakovani blok B (redovi k0..k0+kc, nc kolona).
+        Za k0 == 0 rezultat se upisuje, a za sljedece blokove po K dodaje.
+    */
+    void multiplyBlock(int M, int K, int k0, int kc, int nc, const float* packedA, const float* packedB, float* C, int ldc) {
+        int panels = (M + MR - 1) / MR;
+        for (int jp = 0; jp * NR < nc; ++jp) {
+            const float* b = packedB + static_cast<size_t>(jp) * kc * NR;
+            for (int p = 0; p < panels; ++p) {
+                const float* a = packedA + (static_cast<size_t>(p) * K + k0) * MR;
+                float* c = C + static_cast<size_t>(p) * MR * ldc + jp * NR;
+                microKernel(kc, a, b, c, ldc, std::min(MR, M - p * MR), std::min(NR, nc - jp * NR), k0 > 0);
+            }
+        }
+    }
+
+    // Pakovanje bloka obicne matrice B (K x N): packed[(jp * kc + kk) * NR + j] = B[k0 + kk][n0 + jp * NR + j]
+    void packB(int N, const float* B, int k0, int kc, int n0, int nc, float* packed) {
+        int width = roundUp(nc, NR);
+        for (int kk = 0; kk < kc; ++kk) {
+            const float* source = B + static_cast<size_t>(k0 + kk) * N + n0;
+            for (int j = 0; j < width; ++j)
+                packed[(static_cast<size_t>(j / NR) * kc + kk) * NR + j % NR] = j < nc ? source[j] : 0.0f;
+        }
+    }
+
+    /*
+        im2col direktno u upakovani oblik bloka B: red k matrice odgovara ulaznom kanalu i elementu kernela (ky, kx),
+        a kolona n izlaznom pikselu (n / outWidth, n % outWidth). Cijela im2col matrica (K x broj izlaznih piksela)
+        se nikad ne pravi; svaka nit pravi samo blok kc x nc koji upravo mnozi, pa blok ostaje u kesu.
+        Pozicije van ulaza (padding) su nule.
+    */
+    void im2colPacked(const Tensor& input, int firstChannel, int kernelSize, const ConvLayerParams& params, int outWidth,
+        int k0, int kc, int n0, int nc, float* packed) {
+        const int area = kernelSize * kernelSize;
+        const int width = roundUp(nc, NR);
+
+        for (int kk = 0; kk < kc; ++kk) {
+            int k = k0 + kk;
+            const float* plane = input.plane(firstChannel + k / area);
+            int offsetY = (k % area) / kernelSize * params.dilation - params.padding;
+            int offsetX = k % kernelSize * params.dilation - params.padding;
+
+            int oy = n0 / outWidth, ox = n0 % outWidth;
+            for (int j = 0; j < width; ++j) {
+                float value = 0.0f;
+                if (j < nc) {
+                    int iy = oy * params.stride + offsetY;
+                    int ix = ox * params.stride + offsetX;
+                    if (iy >= 0 && iy < input.height && ix >= 0 && ix < input.width)
+                        value = plane[static_cast<size_t>(iy) * input.width + ix];
+                    if (++ox == outWidth) {
+                        ox = 0;
+                        ++oy;
+                    }
+                }
+                packed[(static_cast<size_t>(j / NR) * kc + kk) * NR + j % NR] = value;
+            }
+        }
+    }
+
+    // Provjera dimenzija i priprema izlaznog tenzora; vraca false (uz poruku) ako parametri nisu ispravni
+    bool prepareLayer(const Tensor& input, const ConvLayerWeights& weights, const ConvLayerParams& params, Tensor& output) {
+        int outHeight = convLayerOutputSize(input.height, weights.kernelSize, params);
+        int outWidth = convLayerOutputSize(input.width, weights.kernelSize, params);
+
+        if (params.stride < 1 || params.dilation < 1 || params.padding < 0 || params.groups < 1 || weights.kernelSize < 1
+            || input.channels != params.groups * weights.inChannels || weights.outChannels % params.groups != 0
+            || (!weights.bias.empty() && static_cast<int>(weights.bias.size()) != weights.outChannels)
+            || outHeight < 1 || outWidth < 1) {
+            std::cerr << "Neispravni parametri konvolucionog sloja." << std::endl;
+            return false;
+        }
+
+        if (output.channels != weights.outChannels || output.height != outHeight || output.width != outWidth)
+            output = Tensor(weights.outChannels, outHeight, outWidth);
+        return true;
+    }
+}
+
+int convLayerOutputSize(int size, int kernelSize, const ConvLayerParams& params) {
+    int span = (kernelSize - 1) * params.dilation + 1;
+    return (size + 2 * params.padding - span) / params.stride + 1;
+}
+
+/*
+    Mnozenje matrica po blokovima (kao u BLIS/GotoBLAS bibliotekama): A se pakuje jednom, a svaka nit za svoj
+    blok kolona (NC) pakuje blok B po KC redova i mnozi ga sa svim panelima A. Niti dijele samo A (citanje),
+    a svaka pise u svoje kolone matrice C, pa sinhronizacija nije potrebna.
+*/
+void gemm(int M, int N, int K, const float* A, const float* B, float* C) {
+    TRACE_SCOPE("gemm");
+
+    const std::vector<float> packedA = packA(M, K, A);
+    const int blocks = (N + NC - 1) / NC;
+
+    TRACE_PARALLEL_REGION("gemm");
+#pragma omp parallel
+    {
+        TRACE_THREAD_BUSY();
+        std::vector<float> packedB(static_cast<size_t>(KC) * NC);
+
+#pragma omp for schedule(dynamic) nowait
+        for (int block = 0; block < blocks; ++block) {
+            int n0 = block * NC, nc = std::min(NC, N - n0);
+            for (int k0 = 0; k0 < K; k0 += KC) {
+                int kc = std::min(KC, K - k0);
+                packB(N, B, k0, kc, n0, nc, packedB.data());
+                multiplyBlock(M, K, k0, kc, nc, packedA.data(), packedB.data(), C + n0, N);
+            }
+        }
+    }
+}
+
+/*
+    Konvolucioni sloj kao mnozenje matrica (za svaku grupu kanala):
+    izlaz (izlazni kanali x izlazni pikseli) = tezine (izlazni kanali x ulazni kanali * k * k) * im2col (... x izlazni pikseli).
+    Izlazne ravni tenzora su upravo redovi matrice C, pa se rezultat upisuje direktno u izlaz.
+    Posao se dijeli po blokovima izlaznih piksela (i grupama), a svaka nit pravi im2col samo za svoj blok.
+*/
+void convLayerGemm(const Tensor& input, const ConvLayerWeights& weights, const ConvLayerParams& params, Tensor& output) {
+    TRACE_SCOPE("convLayerGemm");
+    if (!prepareLayer(input, weights, params, output))
+        return;
+
+    const int groups = params.groups;
+    const int M = weights.outChannels / groups;
+    const int K = weights.inChannels * weights.kernelSize * weights.kernelSize;
+    const int N = output.height * output.width;
+    const int blocks = (N + NC - 1) / NC;
+    TRACE_PIXELS(static_cast<long long>(N) * weights.outChannels);
+
+    std::vector<std::vector<float>> packedA(groups);
+    for (int g = 0; g < groups; ++g)
+        packedA[g] = packA(M, K, weights.values.data() + static_cast<size_t>(g) * M * K);
+
+    TRACE_PARALLEL_REGION("convLayerGemm");
+#pragma omp parallel
+    {
+        TRACE_THREAD_BUSY();
+        std::vector<float> packedB(static_cast<size_t>(KC) * NC);
+
+#pragma omp for schedule(dynamic) nowait
+        for (int task = 0; task < groups * blocks; ++task) {
+            int g = task / blocks;
+            int n0 = task % blocks * NC, nc = std::min(NC, N - n0);
+            float* C = output.plane(g * M) + n0;
+
+            for (int k0 = 0; k0 < K; k0 += KC) {
+                int kc = std::min(KC, K - k0);
+                im2colPacked(input, g * weights.inChannels, weights.kernelSize, params, output.width, k0, kc, n0, nc, packedB.data());
+                multiplyBlock(M, K, k0, kc, nc, packedA[g].data(), packedB.data(), C, N);
+            }
+
+            if (!weights.bias.empty())
+                for (int o = 0; o < M; ++o)
+                    for (int j = 0; j < nc; ++j)
+                        C[static_cast<size_t>(o) * N + j] += weights.bias[g * M + o];
+        }
+    }
+}
+
+/*
+    Depthwise konvolucija (svaka grupa ima jedan ulazni kanal): mnozenje matrica bi imalo samo k * k redova po grupi,
+    pa je direktna petlja brza. Izlazni red se racuna kao zbir pomjerenih ulaznih redova pomnozenih tezinom;
+    za svaki element kernela se unaprijed odredi opseg izlaznih kolona kojima je ulazna kolona unutar slike,
+    pa unutrasnja petlja nema provjera granica i vektorizuje se (za korak 1).
+*/
+void convLayerDepthwise(const Tensor& input, const ConvLayerWeights& weights, const ConvLayerParams& params, Tensor& output) {
+    TRACE_SCOPE("convLayerDepthwise");
+    if (!prepareLayer(input, weights, params, output))
+        return;
+    if (weights.inChannels != 1) {
+        std::cerr << "Depthwise konvolucija zahtijeva jedan ulazni kanal po grupi." << std::endl;
+        return;
+    }
+
+    const int kernelSize = weights.kernelSize;
+    const int multiplier = weights.outChannels / params.groups;
+    const int outHeight = output.height, outWidth = output.width;
+    TRACE_PIXELS(static_cast<long long>(outHeight) * outWidth * weights.outChannels);
+
+    TRACE_PARALLEL_REGION("convLayerDepthwise");
+#pragma omp parallel
+    {
+        TRACE_THREAD_BUSY();
+#pragma omp for collapse(2) nowait
+        for (int o = 0; o < weights.outChannels; ++o) {
+            for (int oy = 0; oy < outHeight; ++oy) {
+                const float* plane = input.plane(o / multiplier);
+                const float* kernel = &weights.values[static_cast<size_t>(o) * kernelSize * kernelSize];
+                float* target = output.plane(o) + static_cast<size_t>(oy) * outWidth;
+                std::fill(target, target + outWidth, weights.bias.empty() ? 0.0f : weights.bias[o]);
+
+                for (int ky = 0; ky < kernelSize; ++ky) {
+                    int iy = oy * params.stride - params.padding + ky * params.dilation;
+                    if (iy < 0 || iy >= input.height)
+                        continue;
+                    const float* source = plane + static_cast<size_t>(iy) * input.width;
+
+                    for (int kx = 0; kx < kernelSize; ++kx) {
+                        const float weight = kernel[ky * kernelSize + kx];
+                        const int offset = kx * params.dilation - params.padding;
+                        // Izlazne kolone ox za koje je ulazna kolona ox * stride + offset unutar [0, width)
+                        int first = offset >= 0 ? 0 : (-offset + params.stride - 1) / params.stride;
+                        int last = std::min(outWidth - 1, (input.width - 1 - offset) / params.stride);
+                        if (input.width - 1 - offset < 0)
+                            continue;
+
+                        if (params.stride == 1) {
+                            for (int ox = first; ox <= last; ++ox)
+                                target[ox] += weight * source[ox + offset];
+                        }
+                        else {
+                            for (int ox = first; ox <= last; ++ox)
+                                target[ox] += weight * source[ox * params.stride + offset];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Referentna konvolucija: za svaki izlazni element zbir po ulaznim kanalima grupe i elementima kernela
+void convLayerDirect(const Tensor& input, const ConvLayerWeights& weights, const ConvLayerParams& params, Tensor& output) {
+    if (!prepareLayer(input, weights, params, output))
+        return;
+
+    const int kernelSize = weights.kernelSize;
+    const int outPerGroup = weights.outChannels / params.groups;
+
+    for (int o = 0; o < weights.outChannels; ++o) {
+        int firstChannel = o / outPerGroup * weights.inChannels;
+        for (int oy = 0; oy < output.height; ++oy) {
+            for (int ox = 0; ox < output.width; ++ox) {
+                float sum = weights.bias.empty() ? 0.0f : weights.bias[o];
+                for (int i = 0; i < weights.inChannels; ++i) {
+                    for (int ky = 0; ky < kernelSize; ++ky) {
+                        for (int kx = 0; kx < kernelSize; ++kx) {
+                            int iy = oy * params.stride - params.padding + ky * params.dilation;
+                            int ix = ox * params.stride - params.padding + kx * params.dilation;
+                            if (iy < 0 || iy >= input.height || ix < 0 || ix >= input.width)
+                                continue;
+                            sum += input.at(firstChannel + i, iy, ix)
+                                * weights.values[((static_cast<size_t>(o) * weights.inChannels + i) * kernelSize + ky) * kernelSize + kx];
+                        }
+                    }
+                }
+                output.at(o, oy, ox) = sum;
+            }
+        }
+    }
+}
+
+void convLayer(const Tensor& input, const ConvLayerWeights& weights, const ConvLayerParams& params, Tensor& output) {
+    if (weights.inChannels == 1 && params.groups == input.channels)
+        convLayerDepthwise(input, weights, params, output);
+    else
+        convLayerGemm(input, weights, params, output);
+}
+
+Tensor imageToTensor(const Image& image) {
+    Tensor tensor(3, image.height, image.width);
+    float* blue = tensor.plane(0);
+    float* green = tensor.plane(1);
+    float* red = tensor.plane(2);
+    for (size_t i = 0; i < image.pixels.size(); ++i) {
+        blue[i] = image.pixels[i].blue;
+        green[i] = image.pixels[i].green;
+        red[i] = image.pixels[i].red;
+    }
+    return tensor;
+}
+
+void tensorToImage(const Tensor& tensor, Image& image) {
+    if (tensor.channels != 3 || tensor.width != image.width || tensor.height != image.height) {
+        std::cerr << "Tenzor mora imati 3 kanala i dimenzije slike." << std::endl;
+        return;
+    }
+
+    const float* planes[3] = { tensor.plane(0), tensor.plane(1), tensor.plane(2) };
+    for (size_t i = 0; i < image.pixels.size(); ++i) {
+        uint8_t* pixel = reinterpret_cast<uint8_t*>(&image.pixels[i]);
+        for (int c = 0; c < 3; ++c)
+            pixel[c] = static_cast<uint8_t>(std::max(0.0f, std::min(255.0f, planes[c][i])));
+    }
+}
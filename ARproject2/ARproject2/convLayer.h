@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+#include "image.h"
+
+/*
+    Tenzor sa kanalima u odvojenim ravnima (planarni raspored, kao ulaz i izlaz konvolucionih slojeva CNN mreza):
+    vrijednost kanala c u redu y i koloni x je data[(c * height + y) * width + x].
+*/
+struct Tensor {
+    int channels, height, width;
+    std::vector<float> data;
+
+    Tensor() : channels(0), height(0), width(0) {}
+    Tensor(int c, int h, int w) : channels(c), height(h), width(w), data(static_cast<size_t>(c) * h * w) {}
+
+    float* plane(int c) { return data.data() + static_cast<size_t>(c) * height * width; }
+    const float* plane(int c) const { return data.data() + static_cast<size_t>(c) * height * width; }
+
+    float& at(int c, int y, int x) { return plane(c)[static_cast<size_t>(y) * width + x]; }
+    float at(int c, int y, int x) const { return plane(c)[static_cast<size_t>(y) * width + x]; }
+};
+
+// Parametri konvolucionog sloja (isti u oba smjera)
+struct ConvLayerParams {
+    int stride = 1;    // korak izmedju susjednih izlaznih piksela
+    int padding = 0;   // broj redova i kolona nula dodatih sa svake strane ulaza
+    int dilation = 1;  // razmak izmedju susjednih elemenata kernela
+    int groups = 1;    // ulazni i izlazni kanali se dijele u grupe; groups == broj kanala je depthwise konvolucija
+};
+
+// Tezine sloja: values[((o * inChannels + i) * kernelSize + ky) * kernelSize + kx], inChannels je broj ulaznih kanala po grupi
+struct ConvLayerWeights {
+    int outChannels, inChannels, kernelSize;
+    std::vector<float> values;
+    std::vector<float> bias;  // jedna vrijednost po izlaznom kanalu, ili prazno
+
+    ConvLayerWeights(int out, int in, int k) : outChannels(out), inChannels(in), kernelSize(k), values(static_cast<size_t>(out) * in * k * k) {}
+
+    float& at(int o, int i, int ky, int kx) { return values[((static_cast<size_t>(o) * inChannels + i) * kernelSize + ky) * kernelSize + kx]; }
+};
+
+// Dimenzija izlaza sloja za ulaznu dimenziju `size`
+int convLayerOutputSize(int , int , const ConvLayerParams& );
+
+// Konvolucioni sloj: depthwise slucaj ide direktnom petljom, ostali preko im2col i blokovskog mnozenja matrica
+void convLayer(const Tensor& , const ConvLayerWeights& , const ConvLayerParams& , Tensor& );
+
+void convLayerGemm(const Tensor& , const ConvLayerWeights& , const ConvLayerParams& , Tensor& );
+
+void convLayerDepthwise(const Tensor& , const ConvLayerWeights& , const ConvLayerParams& , Tensor& );
+
+// Referentna implementacija (ugnijezdene petlje, bez optimizacija) za provjeru ispravnosti
+void convLayerDirect(const Tensor& , const ConvLayerWeights& , const ConvLayerParams& , Tensor& );
+
+// C = A * B (redovi uzastopno u memoriji): A je M x K, B je K x N, C je M x N
+void gemm(int , int , int , const float* , const float* , float* );
+
+// Pretvaranje slike u tenzor sa ravnima B, G, R i nazad (sa ogranicavanjem na [0, 255], kao convolution())
+Tensor imageToTensor(const Image& );
+
+void tensorToImage(const Tensor& , Image& );
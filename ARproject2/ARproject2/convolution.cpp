@@ -1,4 +1,7 @@
 ﻿#include "convolution.h"
+#include "convolutionFixed.h"
+#include "imageStatistics.h"
+#include "tracing.h"
 
 // Funkcija za primenu konvolucije na sliku
 
@@ -21,29 +24,579 @@
     što omogućava istovremenu obradu više piksela slike u više niti, poboljšavajući performanse algoritma na višejezgarnim procesorima.
 */
 void convolution(const Image& input, const std::vector<float>& kernel, Image& output) {
+    convolution(input.pixels.data(), input.width, input.height, kernel, output.pixels.data(), BorderMode::Replicate);
+}
+
+void convolution(const Image& input, const std::vector<float>& kernel, Image& output, BorderMode border) {
+    convolution(input.pixels.data(), input.width, input.height, kernel, output.pixels.data(), border);
+}
+
+/*
+    Funkcija koja preslikava koordinatu `i` (koja moze biti van opsega [0, n)) na koordinatu unutar slike,
+    u skladu sa zadanim nacinom obrade rubova. Za BorderMode::Constant vraca -1 kada je koordinata van slike,
+    sto znaci da piksel ne doprinosi sumi (crni piksel).
+*/
+int borderIndex(int i, int n, BorderMode border) {
+    if (i >= 0 && i < n)
+        return i;
+
+    switch (border) {
+    case BorderMode::Replicate:
+        return i < 0 ? 0 : n - 1;
+
+    case BorderMode::Reflect: {
+        if (n == 1)
+            return 0;
+        int period = 2 * (n - 1);
+        i %= period;
+        if (i < 0)
+            i += period;
+        return i < n ? i : period - i;
+    }
+
+    default:
+        return -1;
+    }
+}
+
+// Suma kernela oko ulaznog piksela (x, y); zajednicka za sve nacine obilaska slike
+template <typename PixelT>
+inline PixelSum<PixelT> pixelSum(const BasicImageView<const PixelT>& input, const float* kernel, int kernelSize, BorderMode border, int x, int y) {
+    const int kernelRadius = kernelSize / 2;
+    PixelSum<PixelT> sum;
+
+    for (int ky = -kernelRadius; ky <= kernelRadius; ++ky) {
+        int imgY = borderIndex(y + ky, input.height, border);
+        if (imgY < 0)
+            continue;
+
+        const PixelT* row = input.row(imgY);
+        const float* weights = kernel + (ky + kernelRadius) * kernelSize + kernelRadius;
+        for (int kx = -kernelRadius; kx <= kernelRadius; ++kx) {
+            int imgX = borderIndex(x + kx, input.width, border);
+            if (imgX < 0)
+                continue;
+
+            sum.add(row[imgX], weights[kx]);
+        }
+    }
+
+    return sum;
+}
+
+// Racunanje jednog izlaznog piksela (x, y) iz ulaznog pogleda, ogranicenog na [0, 255]
+template <typename PixelT>
+inline void convolvePixel(const BasicImageView<const PixelT>& input, const float* kernel, int kernelSize, BorderMode border, int x, int y, PixelT& result) {
+    pixelSum(input, kernel, kernelSize, border, x, y).store(result);
+}
+
+/*
+    Osnovna konvolucija nad pikselima zadanim pokazivacem, sirinom i visinom.
+    Funkcija je sablon (template) po tipu piksela; sumu svakog piksela racuna PixelSum<PixelT>.
+    Svi oblici funkcije convolution() pozivaju ovu, pa ona radi i nad memorijom
+    koja nije u vlasnistvu objekta slike (npr. segment deljene memorije koji je poslao klijent servisa),
+    bez kopiranja piksela. Pikseli van slike se odredjuju funkcijom borderIndex().
+    Ulaz i izlaz su pogledi (pokazivac, dimenzije i razmak izmedju redova), pa ulaz moze biti isjecak vece slike.
+    Racuna se samo dio izlaza zadan pravougaonikom `region` u koordinatama ulaza (cijela slika kod obicne konvolucije);
+    izlazni pogled ima dimenzije tog pravougaonika. Susjedni pikseli (halo) se citaju iz ulaza i van pravougaonika,
+    a rubna pravila vaze samo na granicama ulaznog pogleda.
+    Mali pravougaonici se racunaju u jednoj niti, jer bi pokretanje paralelnog regiona trajalo duze od samog posla.
+    Raspored je staticki (schedule(static)): nit dobija istu traku piksela koju je prva dotakla u konstruktoru
+    slike (firstTouchZero), pa na NUMA masini radi nad stranicama sa svog cvora.
+    Ako je zadana `statistics`, svaka nit usput puni svoju djelimicnu statistiku izracunatih piksela,
+    a djelimicne statistike se spajaju na kraju, pa za statistiku nije potreban jos jedan prolaz kroz izlaz.
+    Redove racuna convolutionRows<WithStatistics>, pa obicna konvolucija ne pravi djelimicnu statistiku
+    i nema provjeru po pikselu.
+*/
+template <bool WithStatistics, typename PixelT>
+void convolutionRows(const BasicImageView<const PixelT>& input, const std::vector<float>& kernel, const BasicImageView<PixelT>& output, BorderMode border, const Rect& region,
+    ImageStatistics* partial) {
+    const int channels = PixelTraits<PixelT>::channels;
+    int kernelSize = static_cast<int>(std::sqrt(kernel.size()));
+    int regionRight = region.x + region.width;
+    int regionBottom = region.y + region.height;
+
+    // Poziva se unutar paralelnog regiona, pa niti dijele redove (orphaned omp for)
+#pragma omp for collapse(2) schedule(static) nowait
+    for (int y = region.y; y < regionBottom; ++y) {
+        for (int x = region.x; x < regionRight; ++x) {
+            PixelT& result = output.row(y - region.y)[x - region.x];
+            convolvePixel(input, kernel.data(), kernelSize, border, x, y, result);
+
+            if (WithStatistics)
+                partial->addPixel<channels>(reinterpret_cast<const uint8_t*>(&result));
+        }
+    }
+}
+
+template <typename PixelT>
+void convolutionRegion(const BasicImageView<const PixelT>& input, const std::vector<float>& kernel, const BasicImageView<PixelT>& output, BorderMode border, const Rect& region,
+    ImageStatistics* statistics = nullptr) {
+    const int channels = PixelTraits<PixelT>::channels;
+    bool parallel = static_cast<long long>(region.width) * region.height * kernel.size() >= 16384;
+
+    if (statistics)
+        statistics->clear(channels);
+
+    TRACE_PARALLEL_REGION("convolution");
+#pragma omp parallel if(parallel)
+    {
+        TRACE_THREAD_BUSY();
+        if (!statistics) {
+            convolutionRows<false>(input, kernel, output, border, region, nullptr);
+        }
+        else {
+            ImageStatistics partial;
+            partial.clear(channels);
+            partial.strongEdgeThreshold = statistics->strongEdgeThreshold;
+
+            convolutionRows<true>(input, kernel, output, border, region, &partial);
+
+#pragma omp critical
+            statistics->merge(partial);
+        }
+    }
+}
+
+template <const auto& Kernel>
+bool sameKernel(const std::vector<float>& kernel) {
+    return kernel.size() == Kernel.values.size() && std::equal(kernel.begin(), kernel.end(), Kernel.values.begin());
+}
+
+/*
+    Ugradjeni kerneli (kernelLibrary.h, odnosno njihove kopije u Kernel::) se prepoznaju po vrijednostima
+    i racunaju sablonom convolutionFixed, sa tezinama ugradjenim u kod. Redoslijed sabiranja je isti kao
+    u convolvePixel(), pa je rezultat identican. Vraca false ako kernel nije ugradjen.
+*/
+template <typename PixelT>
+bool convolutionBuiltIn(const BasicImageView<const PixelT>& input, const std::vector<float>& kernel, const BasicImageView<PixelT>& output, BorderMode border) {
+    if (sameKernel<KernelLibrary::gaussian3>(kernel))
+        convolutionFixed<KernelLibrary::gaussian3>(input, output, border);
+    else if (sameKernel<KernelLibrary::box3>(kernel))
+        convolutionFixed<KernelLibrary::box3>(input, output, border);
+    else if (sameKernel<KernelLibrary::edge3>(kernel))
+        convolutionFixed<KernelLibrary::edge3>(input, output, border);
+    else if (sameKernel<KernelLibrary::sharpen3>(kernel))
+        convolutionFixed<KernelLibrary::sharpen3>(input, output, border);
+    else if (sameKernel<KernelLibrary::identity3>(kernel))
+        convolutionFixed<KernelLibrary::identity3>(input, output, border);
+    else if (sameKernel<KernelLibrary::laplacian3>(kernel))
+        convolutionFixed<KernelLibrary::laplacian3>(input, output, border);
+    else if (sameKernel<KernelLibrary::sobelX3>(kernel))
+        convolutionFixed<KernelLibrary::sobelX3>(input, output, border);
+    else if (sameKernel<KernelLibrary::sobelY3>(kernel))
+        convolutionFixed<KernelLibrary::sobelY3>(input, output, border);
+    else if (sameKernel<KernelLibrary::scharrX3>(kernel))
+        convolutionFixed<KernelLibrary::scharrX3>(input, output, border);
+    else if (sameKernel<KernelLibrary::scharrY3>(kernel))
+        convolutionFixed<KernelLibrary::scharrY3>(input, output, border);
+    else if (sameKernel<KernelLibrary::gaussian5>(kernel))
+        convolutionFixed<KernelLibrary::gaussian5>(input, output, border);
+    else if (sameKernel<KernelLibrary::box5>(kernel))
+        convolutionFixed<KernelLibrary::box5>(input, output, border);
+    else if (sameKernel<KernelLibrary::unsharp5>(kernel))
+        convolutionFixed<KernelLibrary::unsharp5>(input, output, border);
+    else
+        return false;
+    return true;
+}
+
+template <typename PixelT>
+void convolutionCore(const BasicImageView<const PixelT>& input, const std::vector<float>& kernel, const BasicImageView<PixelT>& output, BorderMode border,
+    ImageStatistics* statistics = nullptr) {
+    if (!statistics && convolutionBuiltIn(input, kernel, output, border))
+        return;
+
+    TRACE_SCOPE("convolution");
+    TRACE_PIXELS(static_cast<long long>(input.width) * input.height);
+
+    convolutionRegion(input, kernel, output, border, Rect(0, 0, input.width, input.height), statistics);
+}
+
+void convolution(const Color* input, int width, int height, const std::vector<float>& kernel, Color* output, BorderMode border) {
+    convolutionCore(ConstImageView(input, width, height), kernel, ImageView(output, width, height), border);
+}
+
+void convolution(const Gray* input, int width, int height, const std::vector<float>& kernel, Gray* output, BorderMode border) {
+    convolutionCore(ConstGrayImageView(input, width, height), kernel, GrayImageView(output, width, height), border);
+}
+
+void convolution(const ColorA* input, int width, int height, const std::vector<float>& kernel, ColorA* output, BorderMode border) {
+    convolutionCore(ConstImageBGRAView(input, width, height), kernel, ImageBGRAView(output, width, height), border);
+}
+
+// Konvolucija 8-bitne sive slike: jedan kanal, trecina posla i memorije u odnosu na 24-bitnu sliku
+void convolution(const GrayImage& input, const std::vector<float>& kernel, GrayImage& output, BorderMode border) {
+    convolutionCore(ConstGrayImageView(input), kernel, GrayImageView(output), border);
+}
+
+// Konvolucija 32-bitne slike; alfa kanal se filtrira kao i ostali kanali
+void convolution(const ImageBGRA& input, const std::vector<float>& kernel, ImageBGRA& output, BorderMode border) {
+    convolutionCore(ConstImageBGRAView(input), kernel, ImageBGRAView(output), border);
+}
+
+// Konvolucija koja usput racuna statistiku izlaza (histogram, min, max, srednja vrijednost, jake ivice)
+void convolution(const Image& input, const std::vector<float>& kernel, Image& output, BorderMode border, ImageStatistics& statistics) {
+    convolutionCore(ConstImageView(input), kernel, ImageView(output), border, &statistics);
+}
+
+void convolution(const GrayImage& input, const std::vector<float>& kernel, GrayImage& output, BorderMode border, ImageStatistics& statistics) {
+    convolutionCore(ConstGrayImageView(input), kernel, GrayImageView(output), border, &statistics);
+}
+
+void convolution(const ImageBGRA& input, const std::vector<float>& kernel, ImageBGRA& output, BorderMode border, ImageStatistics& statistics) {
+    convolutionCore(ConstImageBGRAView(input), kernel, ImageBGRAView(output), border, &statistics);
+}
+
+// Konvolucija nad pogledima; pogled je cijela "slika", pa se rubna pravila primjenjuju na njegovim granicama
+void convolution(const ConstImageView& input, const std::vector<float>& kernel, const ImageView& output, BorderMode border) {
+    convolutionCore(input, kernel, output, border);
+}
+
+void convolution(const ConstGrayImageView& input, const std::vector<float>& kernel, const GrayImageView& output, BorderMode border) {
+    convolutionCore(input, kernel, output, border);
+}
+
+void convolution(const ConstImageBGRAView& input, const std::vector<float>& kernel, const ImageBGRAView& output, BorderMode border) {
+    convolutionCore(input, kernel, output, border);
+}
+
+/*
+    Funkcija za racunanje samo jednog pravougaonika (ROI) izlaza.
+    Rezultat je identican odgovarajucem isjecku konvolucije cijelog izvora: pikseli oko pravougaonika (halo)
+    citaju se direktno iz izvora, a rubna pravila se primjenjuju tek na granicama izvora.
+    Tako npr. server plocica racuna 256x256 isjecak ogromne slike bez kopiranja i prosirivanja isjecka.
+*/
+template <typename PixelT>
+void convolutionROICore(const BasicImageView<const PixelT>& source, const std::vector<float>& kernel, const Rect& roi, const BasicImageView<PixelT>& output, BorderMode border) {
+    TRACE_SCOPE("convolutionROI");
+
+    if (roi.empty() || roi.x < 0 || roi.y < 0 || roi.x + roi.width > source.width || roi.y + roi.height > source.height
+        || output.width != roi.width || output.height != roi.height) {
+        std::cerr << "ROI mora biti unutar izvora, a izlaz mora imati dimenzije ROI-ja." << std::endl;
+        return;
+    }
+
+    convolutionRegion(source, kernel, output, border, roi);
+    TRACE_PIXELS(static_cast<long long>(roi.width) * roi.height);
+}
+
+void convolutionROI(const ConstImageView& source, const std::vector<float>& kernel, const Rect& roi, const ImageView& output, BorderMode border) {
+    convolutionROICore(source, kernel, roi, output, border);
+}
+
+void convolutionROI(const ConstGrayImageView& source, const std::vector<float>& kernel, const Rect& roi, const GrayImageView& output, BorderMode border) {
+    convolutionROICore(source, kernel, roi, output, border);
+}
+
+void convolutionROI(const ConstImageBGRAView& source, const std::vector<float>& kernel, const Rect& roi, const ImageBGRAView& output, BorderMode border) {
+    convolutionROICore(source, kernel, roi, output, border);
+}
+
+/*
+    Funkcija za pripremu izmijenjenih pravougaonika za ponovnu konvoluciju.
+    Izlazni piksel zavisi od ulaznih piksela udaljenih najvise `radius` u oba smjera, pa se svaki pravougaonik
+    prosiruje za poluprecnik kernela i ogranicava na sliku. To vazi i za piksele uz rub: ponovljeni ili
+    zrcaljeni pikseli van slike potjecu od ulaznih piksela koji su takodje unutar tog poluprecnika.
+    Pravougaonici koji se preklapaju (ili dodiruju) se zamjenjuju obuhvatnim pravougaonikom sve dok preklapanja ima,
+    tako da se nijedan izlazni piksel ne racuna dva puta.
+*/
+std::vector<Rect> dilateAndMergeRects(const std::vector<Rect>& rects, int radius, int width, int height) {
+    std::vector<Rect> merged;
+    for (const Rect& rect : rects) {
+        int left = std::max(0, rect.x - radius);
+        int top = std::max(0, rect.y - radius);
+        int right = std::min(width, rect.x + rect.width + radius);
+        int bottom = std::min(height, rect.y + rect.height + radius);
+        if (rect.empty() || left >= right || top >= bottom)
+            continue;
+        merged.emplace_back(left, top, right - left, bottom - top);
+    }
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 0; i < merged.size(); ++i) {
+            for (size_t j = i + 1; j < merged.size(); ++j) {
+                Rect& a = merged[i];
+                const Rect& b = merged[j];
+                if (a.x > b.x + b.width || b.x > a.x + a.width || a.y > b.y + b.height || b.y > a.y + a.height)
+                    continue;
+
+                int left = std::min(a.x, b.x);
+                int top = std::min(a.y, b.y);
+                int right = std::max(a.x + a.width, b.x + b.width);
+                int bottom = std::max(a.y + a.height, b.y + b.height);
+                a = Rect(left, top, right - left, bottom - top);
+                merged.erase(merged.begin() + j);
+                changed = true;
+                --j;
+            }
+        }
+    }
+    return merged;
+}
+
+template <typename PixelT>
+void convolutionIncrementalCore(const BasicImage<PixelT>& input, const std::vector<float>& kernel, BasicImage<PixelT>& output, const std::vector<Rect>& dirty, BorderMode border) {
+    TRACE_SCOPE("convolutionIncremental");
+
+    int kernelRadius = static_cast<int>(std::sqrt(kernel.size())) / 2;
+    for (const Rect& region : dilateAndMergeRects(dirty, kernelRadius, input.width, input.height)) {
+        convolutionRegion(BasicImageView<const PixelT>(input), kernel, BasicImageView<PixelT>(output).subView(region), border, region);
+        TRACE_PIXELS(static_cast<long long>(region.width) * region.height);
+    }
+}
+
+void convolutionIncremental(const Image& input, const std::vector<float>& kernel, Image& output, const std::vector<Rect>& dirty, BorderMode border) {
+    convolutionIncrementalCore(input, kernel, output, dirty, border);
+}
+
+void convolutionIncremental(const GrayImage& input, const std::vector<float>& kernel, GrayImage& output, const std::vector<Rect>& dirty, BorderMode border) {
+    convolutionIncrementalCore(input, kernel, output, dirty, border);
+}
+
+void convolutionIncremental(const ImageBGRA& input, const std::vector<float>& kernel, ImageBGRA& output, const std::vector<Rect>& dirty, BorderMode border) {
+    convolutionIncrementalCore(input, kernel, output, dirty, border);
+}
+
+/*
+    Konvolucija po plocicama (tiles) velicine tileSize x tileSize. Niti uzimaju cijele plocice, pa ulazni redovi
+    koje plocica cita ostaju u kesu dok se racunaju svi njeni pikseli; to pomaze kod velikih kernela i sirokih slika.
+    Rezultat je identican funkciji convolution().
+*/
+template <typename PixelT>
+void convolutionTiledCore(const BasicImage<PixelT>& input, const std::vector<float>& kernel, BasicImage<PixelT>& output, BorderMode border, int tileSize) {
+    TRACE_SCOPE("convolutionTiled");
+    TRACE_PIXELS(input.pixels.size());
+
+    BasicImageView<const PixelT> source(input);
     int kernelSize = static_cast<int>(std::sqrt(kernel.size()));
-    int kernelRadius = kernelSize / 2;
-
-#pragma omp parallel for collapse(2)
-    for (int y = 0; y < input.height; ++y) {
-        for (int x = 0; x < input.width; ++x) {
-            float sumRed = 0, sumGreen = 0, sumBlue = 0;
-
-            for (int ky = -kernelRadius; ky <= kernelRadius; ++ky) {
-                for (int kx = -kernelRadius; kx <= kernelRadius; ++kx) {
-                    int imgX = std::max(0, std::min(input.width - 1, x + kx));
-                    int imgY = std::max(0, std::min(input.height - 1, y + ky));
-
-                    int kernelIndex = (ky + kernelRadius) * kernelSize + (kx + kernelRadius);
-                    sumBlue += input.pixels[imgY * input.width + imgX].blue * kernel[kernelIndex];
-                    sumGreen += input.pixels[imgY * input.width + imgX].green * kernel[kernelIndex];
-                    sumRed += input.pixels[imgY * input.width + imgX].red * kernel[kernelIndex];
+    tileSize = std::max(8, tileSize);
+    int tilesX = (input.width + tileSize - 1) / tileSize;
+    int tilesY = (input.height + tileSize - 1) / tileSize;
+
+    TRACE_PARALLEL_REGION("convolutionTiled");
+#pragma omp parallel
+    {
+        TRACE_THREAD_BUSY();
+#pragma omp for collapse(2) schedule(dynamic) nowait
+        for (int tileY = 0; tileY < tilesY; ++tileY) {
+            for (int tileX = 0; tileX < tilesX; ++tileX) {
+                int bottom = std::min(input.height, (tileY + 1) * tileSize);
+                int right = std::min(input.width, (tileX + 1) * tileSize);
+                for (int y = tileY * tileSize; y < bottom; ++y) {
+                    PixelT* row = &output.pixels[static_cast<size_t>(y) * output.width];
+                    for (int x = tileX * tileSize; x < right; ++x)
+                        convolvePixel(source, kernel.data(), kernelSize, border, x, y, row[x]);
+                }
+            }
+        }
+    }
+}
+
+void convolutionTiled(const Image& input, const std::vector<float>& kernel, Image& output, BorderMode border, int tileSize) {
+    convolutionTiledCore(input, kernel, output, border, tileSize);
+}
+
+void convolutionTiled(const GrayImage& input, const std::vector<float>& kernel, GrayImage& output, BorderMode border, int tileSize) {
+    convolutionTiledCore(input, kernel, output, border, tileSize);
+}
+
+void convolutionTiled(const ImageBGRA& input, const std::vector<float>& kernel, ImageBGRA& output, BorderMode border, int tileSize) {
+    convolutionTiledCore(input, kernel, output, border, tileSize);
+}
+
+/*
+    Funkcija koja provjerava da li je kernel separabilan, tj. da li je kernel[i][j] = column[i] * row[j]
+    (npr. Gaussov i box kernel). Kao oslonac se uzima element najvece apsolutne vrijednosti, a zatim se
+    provjerava svaki element, uz toleranciju relativnu u odnosu na najveci element.
+*/
+bool separateKernel(const std::vector<float>& kernel, std::vector<float>& column, std::vector<float>& row) {
+    int size = static_cast<int>(std::sqrt(kernel.size()));
+    if (size * size != static_cast<int>(kernel.size()) || size == 0)
+        return false;
+
+    int pivot = 0;
+    for (int i = 1; i < static_cast<int>(kernel.size()); ++i)
+        if (std::fabs(kernel[i]) > std::fabs(kernel[pivot]))
+            pivot = i;
+    float pivotValue = kernel[pivot];
+    if (pivotValue == 0.0f)
+        return false;
+
+    int pivotRow = pivot / size, pivotColumn = pivot % size;
+    column.resize(size);
+    row.resize(size);
+    for (int i = 0; i < size; ++i) {
+        column[i] = kernel[i * size + pivotColumn];
+        row[i] = kernel[pivotRow * size + i] / pivotValue;
+    }
+
+    float tolerance = 1e-5f * std::fabs(pivotValue);
+    for (int i = 0; i < size; ++i)
+        for (int j = 0; j < size; ++j)
+            if (std::fabs(kernel[i * size + j] - column[i] * row[j]) > tolerance)
+                return false;
+    return true;
+}
+
+/*
+    Separabilna konvolucija: prvo horizontalni prolaz sa `row` u float medjurezultat, pa vertikalni sa `column`.
+    Umjesto k * k mnozenja po pikselu potrebno je 2 * k, sto je za kernel 15x15 oko 7 puta manje posla.
+    Rubovi se obradjuju po osama istim pravilom (borderIndex), pa je rezultat isti kao kod pune konvolucije,
+    do razlike u zaokruzivanju (najvise 1) jer se medjurezultat ne ogranicava i sabira drugim redoslijedom.
+*/
+template <const auto& Factors>
+bool sameFactors(const std::vector<float>& column, const std::vector<float>& row) {
+    return column.size() == Factors.column.size() && row.size() == Factors.row.size()
+        && std::equal(column.begin(), column.end(), Factors.column.begin()) && std::equal(row.begin(), row.end(), Factors.row.begin());
+}
+
+template <typename PixelT>
+void convolutionSeparableCore(const BasicImage<PixelT>& input, const std::vector<float>& column, const std::vector<float>& row, BasicImage<PixelT>& output, BorderMode border,
+    SeparableBuffer* buffer = nullptr) {
+    // Faktori ugradjenih kernela (isti postupak kao separateKernel(), izracunat u vrijeme kompajliranja) imaju sablone sa konstantnim tezinama
+    if (sameFactors<KernelLibrary::gaussian3Factors>(column, row))
+        return convolutionSeparableFixed<KernelLibrary::gaussian3Factors>(input, output, border, buffer);
+    if (sameFactors<KernelLibrary::gaussian5Factors>(column, row))
+        return convolutionSeparableFixed<KernelLibrary::gaussian5Factors>(input, output, border, buffer);
+    if (sameFactors<KernelLibrary::box3Factors>(column, row))
+        return convolutionSeparableFixed<KernelLibrary::box3Factors>(input, output, border, buffer);
+    if (sameFactors<KernelLibrary::box5Factors>(column, row))
+        return convolutionSeparableFixed<KernelLibrary::box5Factors>(input, output, border, buffer);
+
+    TRACE_SCOPE("convolutionSeparable");
+    TRACE_PIXELS(input.pixels.size());
+
+    const int channels = PixelTraits<PixelT>::channels;
+    const int width = input.width;
+    const int height = input.height;
+    const int radius = static_cast<int>(row.size()) / 2;
+    const size_t rowLength = static_cast<size_t>(width) * channels;
+    const bool parallel = static_cast<long long>(width) * height * 2 * static_cast<long long>(row.size()) >= FixedDetail::parallelWork;
+    // Medjurezultat se ne puni nulama: prvi ga upisuje horizontalni prolaz, po istim trakama piksela kao vertikalni,
+    // pa su stranice na cvoru niti koja ih koristi
+    SeparableBuffer local;
+    SeparableBuffer& horizontal = buffer ? *buffer : local;
+    reserveUntouched(horizontal, rowLength * height);
+
+    TRACE_PARALLEL_REGION("convolutionSeparable");
+#pragma omp parallel if(parallel)
+    {
+        TRACE_THREAD_BUSY();
+        FixedDetail::forEachBandSpan(width, height, [&](int y, int xBegin, int xEnd) {
+            const PixelT* source = &input.pixels[static_cast<size_t>(y) * width];
+            float* target = &horizontal[static_cast<size_t>(y) * rowLength];
+            for (int x = xBegin; x < xEnd; ++x) {
+                PixelSum<PixelT> sum;
+                for (int k = -radius; k <= radius; ++k) {
+                    int imgX = borderIndex(x + k, width, border);
+                    if (imgX < 0)
+                        continue;
+                    sum.add(source[imgX], row[k + radius]);
                 }
+                sum.storeUnclamped(target + static_cast<size_t>(x) * channels);
             }
+        });
+
+#pragma omp barrier
+        FixedDetail::forEachBandSpan(width, height, [&](int y, int xBegin, int xEnd) {
+            FixedDetail::separableColumn(horizontal.data(), rowLength, height, y, column.data(), radius, border,
+                static_cast<size_t>(xBegin) * channels, static_cast<size_t>(xEnd) * channels,
+                reinterpret_cast<uint8_t*>(&output.pixels[static_cast<size_t>(y) * width]));
+        });
+    }
+}
+
+void convolutionSeparable(const Image& input, const std::vector<float>& column, const std::vector<float>& row, Image& output, BorderMode border) {
+    convolutionSeparableCore(input, column, row, output, border);
+}
+
+void convolutionSeparable(const Image& input, const std::vector<float>& column, const std::vector<float>& row, Image& output, BorderMode border,
+    SeparableBuffer& buffer) {
+    convolutionSeparableCore(input, column, row, output, border, &buffer);
+}
 
-            output.pixels[y * input.width + x].blue = static_cast<uint8_t>(std::max(0.0f, std::min(255.0f, sumBlue)));
-            output.pixels[y * input.width + x].green = static_cast<uint8_t>(std::max(0.0f, std::min(255.0f, sumGreen)));
-            output.pixels[y * input.width + x].red = static_cast<uint8_t>(std::max(0.0f, std::min(255.0f, sumRed)));
+void convolutionSeparable(const GrayImage& input, const std::vector<float>& column, const std::vector<float>& row, GrayImage& output, BorderMode border) {
+    convolutionSeparableCore(input, column, row, output, border);
+}
+
+void convolutionSeparable(const ImageBGRA& input, const std::vector<float>& column, const std::vector<float>& row, ImageBGRA& output, BorderMode border) {
+    convolutionSeparableCore(input, column, row, output, border);
+}
+
+// Funkcija za racunanje dimenzije izlazne slike nakon poduzorkovanja sa zadatim korakom
+int stridedSize(int size, int stride) {
+    return (size + stride - 1) / stride;
+}
+
+namespace {
+
+    /*
+        Zajednicka petlja za convolutionStrided i convolutionToFloat: izlazni piksel (x, y) je suma kernela
+        oko ulaznog piksela (x * stride, y * stride), sa istim redoslijedom sabiranja i istim rubnim pravilima
+        kao convolution(), a `store` odlucuje kako se suma upisuje (ogranicena na 8 bita ili kao float).
+        Redovi izlaza se dijele nitima statickim rasporedom, u jednom paralelnom regionu.
+    */
+    template <typename Store>
+    void stridedRows(const Image& input, const std::vector<float>& kernel, int stride, BorderMode border, int outWidth, int outHeight, Store store) {
+        const ConstImageView view(input);
+        const int kernelSize = static_cast<int>(std::sqrt(kernel.size()));
+
+        TRACE_PARALLEL_REGION("convolutionStrided");
+#pragma omp parallel
+        {
+            TRACE_THREAD_BUSY();
+#pragma omp for schedule(static) nowait
+            for (int y = 0; y < outHeight; ++y) {
+                for (int x = 0; x < outWidth; ++x)
+                    store(x, y, pixelSum(view, kernel.data(), kernelSize, border, x * stride, y * stride));
+            }
         }
     }
+}
+
+/*
+    Ova funkcija spaja konvoluciju i poduzorkovanje (decimaciju) u jedan korak.
+    Umjesto da se konvolucija izracuna za svaki piksel ulazne slike i da se zatim zadrzi
+    samo svaki stride-ti piksel u oba smjera, racunaju se iskljucivo pikseli koji ostaju u izlazu.
+    Za stride = 2 to je cetiri puta manje posla nego convolution() pa poduzorkovanje.
+    Izlazni piksel (x, y) odgovara ulaznom pikselu (x * stride, y * stride),
+    pa je rezultat identican onome koji bi se dobio konvolucijom cijele slike (sa istim rubnim pravilom)
+    i uzimanjem svakog stride-tog piksela.
+    Izlazna slika mora imati dimenzije stridedSize(input.width, stride) x stridedSize(input.height, stride).
+*/
+void convolutionStrided(const Image& input, const std::vector<float>& kernel, Image& output, int stride, BorderMode border) {
+    TRACE_SCOPE("convolutionStrided");
+    if (stride < 1 || output.width != stridedSize(input.width, stride) || output.height != stridedSize(input.height, stride)) {
+        std::cerr << "Korak mora biti pozitivan, a izlaz mora imati dimenzije stridedSize(ulaz, korak)." << std::endl;
+        return;
+    }
+    TRACE_PIXELS(static_cast<long long>(output.width) * output.height);
+
+    Color* pixels = output.pixels.data();
+    const int outWidth = output.width;
+    stridedRows(input, kernel, stride, border, output.width, output.height, [pixels, outWidth](int x, int y, const PixelSum<Color>& sum) {
+        sum.store(pixels[static_cast<size_t>(y) * outWidth + x]);
+    });
+}
+
+/*
+    Ova funkcija racuna istu konvoluciju kao convolution(), ali rezultat ne ogranicava na [0, 255]
+    i ne zaokruzuje na cijele brojeve, vec ga smjesta u float vektor (width * height * 3 vrijednosti,
+    redom plava, zelena i crvena komponenta svakog piksela, kao u strukturi Color).
+    Koristi se kada se rezultat dalje kombinuje (npr. u vremenskoj konvoluciji),
+    kako se medjurezultat ne bi odsjecao prije posljednjeg koraka.
+*/
+void convolutionToFloat(const Image& input, const std::vector<float>& kernel, std::vector<float>& output, BorderMode border) {
+    TRACE_SCOPE("convolutionToFloat");
+    TRACE_PIXELS(static_cast<long long>(input.width) * input.height);
+
+    output.resize(static_cast<size_t>(input.width) * input.height * 3);
+    float* values = output.data();
+    const int width = input.width;
+    stridedRows(input, kernel, 1, border, input.width, input.height, [values, width](int x, int y, const PixelSum<Color>& sum) {
+        sum.storeUnclamped(values + (static_cast<size_t>(y) * width + x) * 3);
+    });
 }
\ No newline at end of file
@@ -1,7 +1,98 @@
-#pragma once
+﻿#pragma once
 
 #include <cmath>
 #include "image.h"
 
+// Nacin obrade piksela van slike prilikom konvolucije
+enum class BorderMode {
+    Replicate,  // ponavlja se najblizi rubni piksel (podrazumijevano)
+    Constant,   // pikseli van slike su crni (0)
+    Reflect     // zrcaljenje bez ponavljanja rubnog piksela (... 2 1 | 0 1 2 ...)
+};
+
 void convolution(const Image& , const std::vector<float>& , Image& );
 
+void convolution(const Image& , const std::vector<float>& , Image& , BorderMode );
+
+// Konvolucija 8-bitnih sivih i 32-bitnih slika (isti kernel, broj kanala odredjuje tip piksela)
+void convolution(const GrayImage& , const std::vector<float>& , GrayImage& , BorderMode = BorderMode::Replicate);
+
+void convolution(const ImageBGRA& , const std::vector<float>& , ImageBGRA& , BorderMode = BorderMode::Replicate);
+
+// Konvolucija nad pikselima u memoriji koja ne pripada objektu slike (npr. deljena memorija)
+void convolution(const Color* , int , int , const std::vector<float>& , Color* , BorderMode );
+
+void convolution(const Gray* , int , int , const std::vector<float>& , Gray* , BorderMode );
+
+void convolution(const ColorA* , int , int , const std::vector<float>& , ColorA* , BorderMode );
+
+struct ImageStatistics;
+
+// Konvolucija koja u istom prolazu racuna statistiku izlaza (vidi imageStatistics.h)
+void convolution(const Image& , const std::vector<float>& , Image& , BorderMode , ImageStatistics& );
+
+void convolution(const GrayImage& , const std::vector<float>& , GrayImage& , BorderMode , ImageStatistics& );
+
+void convolution(const ImageBGRA& , const std::vector<float>& , ImageBGRA& , BorderMode , ImageStatistics& );
+
+// Konvolucija nad pogledima (npr. isjecak vece slike ili bafer sa poravnatim redovima), bez kopiranja piksela
+void convolution(const ConstImageView& , const std::vector<float>& , const ImageView& , BorderMode = BorderMode::Replicate);
+
+void convolution(const ConstGrayImageView& , const std::vector<float>& , const GrayImageView& , BorderMode = BorderMode::Replicate);
+
+void convolution(const ConstImageBGRAView& , const std::vector<float>& , const ImageBGRAView& , BorderMode = BorderMode::Replicate);
+
+// Racuna samo pravougaonik (ROI) izlaza; okolni pikseli se citaju iz izvora, izlaz ima dimenzije ROI-ja
+void convolutionROI(const ConstImageView& , const std::vector<float>& , const Rect& , const ImageView& , BorderMode = BorderMode::Replicate);
+
+void convolutionROI(const ConstGrayImageView& , const std::vector<float>& , const Rect& , const GrayImageView& , BorderMode = BorderMode::Replicate);
+
+void convolutionROI(const ConstImageBGRAView& , const std::vector<float>& , const Rect& , const ImageBGRAView& , BorderMode = BorderMode::Replicate);
+
+int borderIndex(int , int , BorderMode );
+
+/*
+    Ponovna konvolucija nakon izmjene dijela ulazne slike: `output` je rezultat konvolucije prethodne verzije
+    ulaza, a `dirty` su pravougaonici ulaza koji su izmijenjeni. Racunaju se samo izlazni pikseli koje izmjena
+    moze promijeniti (pravougaonici prosireni za poluprecnik kernela i spojeni ako se preklapaju).
+*/
+void convolutionIncremental(const Image& , const std::vector<float>& , Image& , const std::vector<Rect>& , BorderMode = BorderMode::Replicate);
+
+void convolutionIncremental(const GrayImage& , const std::vector<float>& , GrayImage& , const std::vector<Rect>& , BorderMode = BorderMode::Replicate);
+
+void convolutionIncremental(const ImageBGRA& , const std::vector<float>& , ImageBGRA& , const std::vector<Rect>& , BorderMode = BorderMode::Replicate);
+
+// Prosiruje pravougaonike za poluprecnik, ogranicava ih na sliku i spaja one koji se preklapaju
+std::vector<Rect> dilateAndMergeRects(const std::vector<Rect>& , int , int , int );
+
+// Konvolucija po plocicama zadane velicine (isti rezultat kao convolution(), drugaciji redoslijed obilaska)
+void convolutionTiled(const Image& , const std::vector<float>& , Image& , BorderMode , int );
+
+void convolutionTiled(const GrayImage& , const std::vector<float>& , GrayImage& , BorderMode , int );
+
+void convolutionTiled(const ImageBGRA& , const std::vector<float>& , ImageBGRA& , BorderMode , int );
+
+// Rastavljanje kernela na kolonu i red (kernel = column * row); vraca false ako kernel nije separabilan
+bool separateKernel(const std::vector<float>& , std::vector<float>& , std::vector<float>& );
+
+// Separabilna konvolucija: horizontalni prolaz sa redom, pa vertikalni sa kolonom kernela
+void convolutionSeparable(const Image& , const std::vector<float>& , const std::vector<float>& , Image& , BorderMode );
+
+// Float medjurezultat separabilne konvolucije; pozivalac ga moze cuvati izmedju poziva (npr. jedan po video toku)
+typedef std::vector<float, FirstTouchAllocator<float>> SeparableBuffer;
+
+// Isto, sa medjurezultatom u baferu pozivaoca (prosiruje se samo kada je premali), pa ponovljeni pozivi ne alociraju
+void convolutionSeparable(const Image& , const std::vector<float>& , const std::vector<float>& , Image& , BorderMode , SeparableBuffer& );
+
+void convolutionSeparable(const GrayImage& , const std::vector<float>& , const std::vector<float>& , GrayImage& , BorderMode );
+
+void convolutionSeparable(const ImageBGRA& , const std::vector<float>& , const std::vector<float>& , ImageBGRA& , BorderMode );
+
+// Konvolucija sa korakom (decimacija): racuna samo piksele koji ostaju nakon poduzorkovanja
+void convolutionStrided(const Image& , const std::vector<float>& , Image& , int , BorderMode = BorderMode::Replicate);
+
+int stridedSize(int , int );
+
+// Konvolucija bez ogranicavanja na [0, 255]: rezultat su float vrijednosti u rasporedu B, G, R po pikselu
+void convolutionToFloat(const Image& , const std::vector<float>& , std::vector<float>& , BorderMode = BorderMode::Replicate);
+
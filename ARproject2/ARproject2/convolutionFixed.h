@@ -0,0 +1,277 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <type_traits>
+#include "convolution.h"
+#include "kernelLibrary.h"
+#include "numaPlacement.h"
+#include "tracing.h"
+
+inline uint8_t clampChannel(float value) {
+    return static_cast<uint8_t>(std::max(0.0f, std::min(255.0f, value)));
+}
+
+/*
+    Suma jednog izlaznog piksela, posebno za svaki tip piksela (koriste je convolution.cpp i sabloni ispod).
+    Kanali se citaju kao imenovana polja piksela, kao u prvobitnoj 24-bitnoj konvoluciji: preko pokazivaca
+    na bajtove (koji smije pokazivati na bilo sta) prevodilac ne moze da drzi sume u registrima,
+    pa je petlja bila i do 1.8 puta sporija.
+*/
+template <typename PixelT> struct PixelSum;
+
+template <> struct PixelSum<Gray> {
+    float value = 0;
+
+    void add(const Gray& pixel, float weight) { value += pixel.value * weight; }
+    void store(Gray& result) const { result.value = clampChannel(value); }
+    void storeUnclamped(float* target) const { target[0] = value; }
+};
+
+template <> struct PixelSum<Color> {
+    float blue = 0, green = 0, red = 0;
+
+    void add(const Color& pixel, float weight) {
+        blue += pixel.blue * weight;
+        green += pixel.green * weight;
+        red += pixel.red * weight;
+    }
+
+    void store(Color& result) const {
+        result.blue = clampChannel(blue);
+        result.green = clampChannel(green);
+        result.red = clampChannel(red);
+    }
+
+    // Medjurezultat separabilne konvolucije: kanali redom B, G, R, bez ogranicavanja
+    void storeUnclamped(float* target) const {
+        target[0] = blue;
+        target[1] = green;
+        target[2] = red;
+    }
+};
+
+template <> struct PixelSum<ColorA> {
+    float blue = 0, green = 0, red = 0, alpha = 0;
+
+    void add(const ColorA& pixel, float weight) {
+        blue += pixel.blue * weight;
+        green += pixel.green * weight;
+        red += pixel.red * weight;
+        alpha += pixel.alpha * weight;
+    }
+
+    void store(ColorA& result) const {
+        result.blue = clampChannel(blue);
+        result.green = clampChannel(green);
+        result.red = clampChannel(red);
+        result.alpha = clampChannel(alpha);
+    }
+
+    void storeUnclamped(float* target) const {
+        target[0] = blue;
+        target[1] = green;
+        target[2] = red;
+        target[3] = alpha;
+    }
+};
+
+namespace FixedDetail {
+
+    // Najmanji posao (pikseli puta mnozenja po pikselu) za koji se pokrece paralelni region, kao u convolutionRegion()
+    const long long parallelWork = 16384;
+
+    /*
+        Obilazak trake piksela niti: traka [begin, end) iz currentStaticBand() nad cijelom slikom je ista koju je nit
+        prva dotakla u konstruktoru slike (firstTouchZero) i koju dobija u convolution() (omp for collapse(2) schedule(static)),
+        pa granica trake moze pasti i usred reda. Za svaki dio reda se poziva span(y, xBegin, xEnd).
+    */
+    template <typename Span>
+    void forEachBandSpan(int width, int height, Span span) {
+        size_t begin, end;
+        currentStaticBand(static_cast<size_t>(width) * height, begin, end);
+        for (size_t pixel = begin; pixel < end; ) {
+            const int y = static_cast<int>(pixel / width);
+            const int xBegin = static_cast<int>(pixel % width);
+            const int xEnd = static_cast<int>(std::min<size_t>(width, xBegin + (end - pixel)));
+            span(y, xBegin, xEnd);
+            pixel += xEnd - xBegin;
+        }
+    }
+
+    /*
+        Vertikalni prolaz separabilne konvolucije za elemente [first, last) izlaznog reda y: suma redova float
+        medjurezultata pomnozenih tezinama kolone. Suma se drzi u bloku na steku (a ne u baferu cijelog reda),
+        pa prolaz ne alocira memoriju; redoslijed sabiranja za svaki element je isti (k od -radius do radius).
+    */
+    inline void separableColumn(const float* horizontal, size_t rowLength, int height, int y, const float* column, int radius,
+        BorderMode border, size_t first, size_t last, uint8_t* target) {
+        const size_t block = 256;
+        float sum[block];
+        for (size_t begin = first; begin < last; begin += block) {
+            size_t count = std::min(block, last - begin);
+            std::fill(sum, sum + count, 0.0f);
+            for (int k = -radius; k <= radius; ++k) {
+                int imgY = borderIndex(y + k, height, border);
+                if (imgY < 0)
+                    continue;
+                const float weight = column[k + radius];
+                const float* source = horizontal + static_cast<size_t>(imgY) * rowLength + begin;
+                for (size_t i = 0; i < count; ++i)
+                    sum[i] += source[i] * weight;
+            }
+            for (size_t i = 0; i < count; ++i)
+                target[begin + i] = clampChannel(sum[i]);
+        }
+    }
+}
+
+/*
+    Konvolucija sa kernelom cija je velicina poznata u vrijeme kompajliranja (npr. ugradjeni kerneli iz
+    kernelLibrary.h). Kernel je parametar sablona (referenca na constexpr kernel), pa petlje po kernelu imaju
+    fiksan broj iteracija N, kompajler ih potpuno odmotava, a tezine se ugradjuju u kod kao konstante.
+    convolution() i convolutionSeparable() same prepoznaju ugradjene kernele i pozivaju ove sablone.
+    Redovi ulaza se odredjuju rubnim pravilom jednom po izlaznom redu, a kolone samo za r piksela uz lijevi
+    i desni rub; unutrasnjost reda nema poziva borderIndex(). Rezultat je identican convolution() sa istim kernelom.
+    Niti dijele piksele istim trakama kao convolution() (forEachBandSpan), a mala slika se racuna u jednoj niti.
+*/
+template <const auto& Kernel, typename PixelT>
+void convolutionFixed(const BasicImageView<const PixelT>& input, const BasicImageView<PixelT>& output, BorderMode border = BorderMode::Replicate) {
+    TRACE_SCOPE("convolutionFixed");
+    TRACE_PIXELS(static_cast<long long>(input.width) * input.height);
+
+    constexpr int N = std::decay_t<decltype(Kernel)>::size;
+    const int radius = N / 2;
+    const int width = input.width;
+    const int height = input.height;
+    const int interiorBegin = std::min(radius, width);
+    const int interiorEnd = std::max(interiorBegin, width - radius);
+    const bool parallel = static_cast<long long>(width) * height * N * N >= FixedDetail::parallelWork;
+
+    TRACE_PARALLEL_REGION("convolutionFixed");
+#pragma omp parallel if(parallel)
+    {
+        TRACE_THREAD_BUSY();
+        FixedDetail::forEachBandSpan(width, height, [&](int y, int xBegin, int xEnd) {
+            // Redovi ulaza za ovaj izlazni red (nullptr za red van slike kod BorderMode::Constant)
+            const PixelT* sourceRows[N];
+            for (int ky = 0; ky < N; ++ky) {
+                int imgY = borderIndex(y + ky - radius, height, border);
+                sourceRows[ky] = imgY < 0 ? nullptr : input.row(imgY);
+            }
+            PixelT* target = output.row(y);
+
+            auto edgePixel = [&](int x) {
+                PixelSum<PixelT> sum;
+                for (int ky = 0; ky < N; ++ky) {
+                    if (sourceRows[ky] == nullptr)
+                        continue;
+                    for (int kx = 0; kx < N; ++kx) {
+                        int imgX = borderIndex(x + kx - radius, width, border);
+                        if (imgX < 0)
+                            continue;
+                        sum.add(sourceRows[ky][imgX], Kernel.values[ky * N + kx]);
+                    }
+                }
+                sum.store(target[x]);
+            };
+
+            for (int x = xBegin; x < std::min(xEnd, interiorBegin); ++x)
+                edgePixel(x);
+            for (int x = std::max(xBegin, interiorBegin); x < std::min(xEnd, interiorEnd); ++x) {
+                PixelSum<PixelT> sum;
+                for (int ky = 0; ky < N; ++ky) {
+                    if (sourceRows[ky] == nullptr)
+                        continue;
+                    const PixelT* source = sourceRows[ky] + (x - radius);
+                    for (int kx = 0; kx < N; ++kx)
+                        sum.add(source[kx], Kernel.values[ky * N + kx]);
+                }
+                sum.store(target[x]);
+            }
+            for (int x = std::max(xBegin, interiorEnd); x < xEnd; ++x)
+                edgePixel(x);
+        });
+    }
+}
+
+/*
+    Separabilna konvolucija sa constexpr faktorima (npr. KernelLibrary::gaussian5Factors):
+    horizontalni prolaz sa redom u float bafer, pa vertikalni prolaz sa kolonom. Rezultat odgovara
+    convolutionSeparable() i moze se razlikovati od direktne konvolucije za +/-1 zbog zaokruzivanja.
+    Ako je zadan `buffer`, medjurezultat se cuva u njemu (prosiruje se samo kada je premali), pa ponovljeni
+    pozivi za slike iste velicine ne alociraju memoriju.
+*/
+template <const auto& Factors, typename PixelT>
+void convolutionSeparableFixed(const BasicImageView<const PixelT>& input, const BasicImageView<PixelT>& output, BorderMode border = BorderMode::Replicate,
+    SeparableBuffer* buffer = nullptr) {
+    TRACE_SCOPE("convolutionSeparableFixed");
+    TRACE_PIXELS(static_cast<long long>(input.width) * input.height);
+
+    constexpr int N = static_cast<int>(std::tuple_size<decltype(Factors.row)>::value);
+    const int channels = PixelTraits<PixelT>::channels;
+    const int radius = N / 2;
+    const int width = input.width;
+    const int height = input.height;
+    const size_t rowLength = static_cast<size_t>(width) * channels;
+    const int interiorBegin = std::min(radius, width);
+    const int interiorEnd = std::max(interiorBegin, width - radius);
+
+    const bool parallel = static_cast<long long>(width) * height * 2 * N >= FixedDetail::parallelWork;
+
+    SeparableBuffer local;
+    SeparableBuffer& horizontal = buffer ? *buffer : local;
+    reserveUntouched(horizontal, rowLength * height);
+
+    // Oba prolaza dijele piksele trakama slike, pa nit upisuje medjurezultat i izlaz za iste piksele
+    TRACE_PARALLEL_REGION("convolutionSeparableFixed");
+#pragma omp parallel if(parallel)
+    {
+        TRACE_THREAD_BUSY();
+        FixedDetail::forEachBandSpan(width, height, [&](int y, int xBegin, int xEnd) {
+            const PixelT* source = input.row(y);
+            float* target = &horizontal[static_cast<size_t>(y) * rowLength];
+
+            auto edgePixel = [&](int x) {
+                PixelSum<PixelT> sum;
+                for (int k = 0; k < N; ++k) {
+                    int imgX = borderIndex(x + k - radius, width, border);
+                    if (imgX < 0)
+                        continue;
+                    sum.add(source[imgX], Factors.row[k]);
+                }
+                sum.storeUnclamped(target + static_cast<size_t>(x) * channels);
+            };
+
+            for (int x = xBegin; x < std::min(xEnd, interiorBegin); ++x)
+                edgePixel(x);
+            for (int x = std::max(xBegin, interiorBegin); x < std::min(xEnd, interiorEnd); ++x) {
+                PixelSum<PixelT> sum;
+                for (int k = 0; k < N; ++k)
+                    sum.add(source[x - radius + k], Factors.row[k]);
+                sum.storeUnclamped(target + static_cast<size_t>(x) * channels);
+            }
+            for (int x = std::max(xBegin, interiorEnd); x < xEnd; ++x)
+                edgePixel(x);
+        });
+
+        // Vertikalni prolaz cita redove medjurezultata koje su upisale druge niti
+#pragma omp barrier
+        FixedDetail::forEachBandSpan(width, height, [&](int y, int xBegin, int xEnd) {
+            FixedDetail::separableColumn(horizontal.data(), rowLength, height, y, Factors.column.data(), radius, border,
+                static_cast<size_t>(xBegin) * channels, static_cast<size_t>(xEnd) * channels, reinterpret_cast<uint8_t*>(output.row(y)));
+        });
+    }
+}
+
+// Oblici za cijele slike
+template <const auto& Kernel, typename PixelT>
+void convolutionFixed(const BasicImage<PixelT>& input, BasicImage<PixelT>& output, BorderMode border = BorderMode::Replicate) {
+    convolutionFixed<Kernel, PixelT>(BasicImageView<const PixelT>(input), BasicImageView<PixelT>(output), border);
+}
+
+template <const auto& Factors, typename PixelT>
+void convolutionSeparableFixed(const BasicImage<PixelT>& input, BasicImage<PixelT>& output, BorderMode border = BorderMode::Replicate,
+    SeparableBuffer* buffer = nullptr) {
+    convolutionSeparableFixed<Factors, PixelT>(BasicImageView<const PixelT>(input), BasicImageView<PixelT>(output), border, buffer);
+}
@@ -0,0 +1,615 @@
+#include "convolutionService.h"
+#include "latencyHistogram.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// Funkcija koja pretvara ime nacina obrade rubova (replicate, constant, reflect) u BorderMode
+BorderMode parseBorderMode(const std::string& name) {
+    if (name == "constant")
+        return BorderMode::Constant;
+    if (name == "reflect")
+        return BorderMode::Reflect;
+    return BorderMode::Replicate;
+}
+
+#ifdef __linux__
+
+namespace {
+
+    typedef std::chrono::steady_clock Clock;
+
+    const uint32_t serviceMagic = 0x564E4F43;  // "CONV"
+    const int maxKernelValues = 31 * 31;
+    const int maxPathLength = 256;
+
+    // Posao koji je manji od ovoga se racuna u jednoj niti, a vise takvih poslova iz paketa paralelno
+    const long long smallJobPixels = 512 * 512;
+
+    enum class RequestType : uint32_t { Job = 0, Stats = 1, Shutdown = 2 };
+
+    // Statusi posla koje servis vraca klijentu
+    const int32_t statusOk = 0;
+    const int32_t statusFailed = -1;         // segment deljene memorije ne odgovara zahtjevu
+    const int32_t statusOutputFailed = -2;   // izlazni fajl nije moguce upisati
+    const int32_t statusInvalidRequest = -3; // neispravna polja zahtjeva (dimenzije, kernel, rubovi, izlaz, putanja)
+
+    /*
+        Poruke izmedju klijenta i servisa. Koristi se SOCK_SEQPACKET socket, pa je svaka poruka
+        jedan paket fiksne velicine. Pikseli se ne salju kroz socket: klijent uz poruku salje
+        deskriptor memfd segmenta (SCM_RIGHTS) u kojem je prva polovina ulazna, a druga izlazna slika.
+    */
+    struct ServiceRequest {
+        uint32_t magic;
+        RequestType type;
+        uint64_t requestId;
+        int32_t width, height;
+        uint32_t kernelValueCount;
+        BorderMode border;
+        ServiceOutput output;
+        char outputPath[maxPathLength];
+        float kernel[maxKernelValues];
+    };
+
+    struct ServiceResponse {
+        uint64_t requestId;
+        int32_t status;          // statusOk ili jedan od negativnih statusa iznad
+        double queueMs;          // vrijeme cekanja u redu
+        double computeMs;        // vrijeme racunanja
+        double totalMs;          // od prijema do slanja odgovora
+        uint64_t completed;      // za Stats: broj obradjenih poslova
+        double p50Ms, p99Ms;     // za Stats: percentili ukupnog kasnjenja
+    };
+
+    // Konekcija se zatvara tek kada je vise ne koriste ni nit konekcije ni poslovi koji cekaju na odgovor
+    struct Connection {
+        int fd;
+        explicit Connection(int fd) : fd(fd) {}
+        ~Connection() { close(fd); }
+    };
+
+    struct Job {
+        ServiceRequest request;
+        int memoryFd;
+        std::shared_ptr<Connection> connection;
+        Clock::time_point received;
+        Clock::time_point computeStart;
+        Clock::time_point computeEnd;
+        int status;
+    };
+
+    // Ogranicen red poslova: push blokira kada je red pun, sto usporava klijente (backpressure)
+    class JobQueue {
+    public:
+        explicit JobQueue(size_t capacity) : capacity(capacity) {}
+
+        bool push(const Job& job) {
+            std::unique_lock<std::mutex> lock(mutex);
+            notFull.wait(lock, [this] { return jobs.size() < capacity || stopped; });
+            if (stopped)
+                return false;
+            jobs.push_back(job);
+            notEmpty.notify_one();
+            return true;
+        }
+
+        // Uzima sve poslove koji cekaju, a najvise maxCount
+        bool popBatch(std::vector<Job>& batch, size_t maxCount) {
+            std::unique_lock<std::mutex> lock(mutex);
+            notEmpty.wait(lock, [this] { return !jobs.empty() || stopped; });
+            if (jobs.empty())
+                return false;
+            batch.clear();
+            while (!jobs.empty() && batch.size() < maxCount) {
+                batch.push_back(jobs.front());
+                jobs.pop_front();
+            }
+            notFull.notify_all();
+            return true;
+        }
+
+        void stop() {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopped = true;
+            notFull.notify_all();
+            notEmpty.notify_all();
+        }
+
+    private:
+        size_t capacity;
+        std::deque<Job> jobs;
+        bool stopped = false;
+        std::mutex mutex;
+        std::condition_variable notFull, notEmpty;
+    };
+
+    // Percentili ukupnog kasnjenja iz histograma fiksne velicine, dijeli ga radna nit i niti konekcija
+    struct ServiceMetrics {
+        std::mutex mutex;
+        LatencyHistogram totalMs;
+
+        void record(double ms) {
+            std::lock_guard<std::mutex> lock(mutex);
+            totalMs.record(ms);
+        }
+
+        void fill(ServiceResponse& response) {
+            std::lock_guard<std::mutex> lock(mutex);
+            response.completed = totalMs.count();
+            response.p50Ms = totalMs.percentile(0.50);
+            response.p99Ms = totalMs.percentile(0.99);
+        }
+    };
+
+    // Stanje servisa dijele sve niti; niti konekcija ga drze dok god rade
+    struct ServiceState {
+        JobQueue queue;
+        ServiceMetrics metrics;
+        std::atomic<bool> running;
+        int listenFd;
+
+        ServiceState(size_t capacity, int listenFd) : queue(capacity), running(true), listenFd(listenFd) {}
+    };
+
+    double milliseconds(Clock::time_point from, Clock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+
+    bool sendWithFd(int socketFd, const void* data, size_t size, int fd) {
+        iovec io = { const_cast<void*>(data), size };
+        msghdr message = {};
+        message.msg_iov = &io;
+        message.msg_iovlen = 1;
+
+        char control[CMSG_SPACE(sizeof(int))] = {};
+        if (fd >= 0) {
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+            cmsghdr* header = CMSG_FIRSTHDR(&message);
+            header->cmsg_level = SOL_SOCKET;
+            header->cmsg_type = SCM_RIGHTS;
+            header->cmsg_len = CMSG_LEN(sizeof(int));
+            memcpy(CMSG_DATA(header), &fd, sizeof(int));
+        }
+        return sendmsg(socketFd, &message, MSG_NOSIGNAL) == static_cast<ssize_t>(size);
+    }
+
+    bool receiveWithFd(int socketFd, void* data, size_t size, int& fd) {
+        iovec io = { data, size };
+        msghdr message = {};
+        message.msg_iov = &io;
+        message.msg_iovlen = 1;
+
+        char control[CMSG_SPACE(sizeof(int))] = {};
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        fd = -1;
+        if (recvmsg(socketFd, &message, MSG_CMSG_CLOEXEC) != static_cast<ssize_t>(size))
+            return false;
+
+        cmsghdr* header = CMSG_FIRSTHDR(&message);
+        if (header && header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS)
+            memcpy(&fd, CMSG_DATA(header), sizeof(int));
+        return true;
+    }
+
+    sockaddr_un socketAddress(const std::string& path) {
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+        return address;
+    }
+
+    int connectToService(const std::string& path) {
+        int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+        sockaddr_un address = socketAddress(path);
+        if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            std::cerr << "Nije moguce povezati se sa servisom: " << path << std::endl;
+            if (fd >= 0)
+                close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    /*
+        Provjera izlazne putanje koju je poslao klijent, prije bilo kakvog racunanja: mora biti zavrsena nulom,
+        apsolutna, sa ekstenzijom .bmp i bez ".." dijelova, a ako servis ima izlazni folder, mora biti u njemu.
+    */
+    bool validOutputPath(const ServiceRequest& request, const std::string& outputDirectory) {
+        size_t length = strnlen(request.outputPath, maxPathLength);
+        if (length == 0 || length == static_cast<size_t>(maxPathLength))
+            return false;
+        std::string path(request.outputPath, length);
+        if (path[0] != '/' || path.size() < 5 || path.compare(path.size() - 4, 4, ".bmp") != 0)
+            return false;
+        if (path.find("/../") != std::string::npos || path.find("/./") != std::string::npos)
+            return false;
+        if (!outputDirectory.empty()) {
+            std::string prefix = outputDirectory.back() == '/' ? outputDirectory : outputDirectory + "/";
+            if (path.compare(0, prefix.size(), prefix) != 0)
+                return false;
+        }
+        return true;
+    }
+
+    // Polja zahtjeva dolaze iz drugog procesa, pa se provjeravaju prije nego sto se koriste kao enum ili velicina
+    bool validJobRequest(const ServiceRequest& request, const std::string& outputDirectory) {
+        if (request.width <= 0 || request.height <= 0 || request.width > 65535 || request.height > 65535)
+            return false;
+        if (request.kernelValueCount == 0 || request.kernelValueCount > static_cast<uint32_t>(maxKernelValues))
+            return false;
+        if (request.border != BorderMode::Replicate && request.border != BorderMode::Constant && request.border != BorderMode::Reflect)
+            return false;
+        if (request.output == ServiceOutput::BmpFile)
+            return validOutputPath(request, outputDirectory);
+        return request.output == ServiceOutput::SharedMemory;
+    }
+
+    /*
+        Upisivanje rezultata u BMP fajl bez saveImage, koji bi prekinuo servis ako fajl ne moze da se otvori.
+        Fajl se otvara bez pracenja simbolickog linka na kraju putanje, mora biti obican fajl,
+        a skracuje se tek nakon sto je uspjesno otvoren, pa neuspjela provjera ne brise postojeci sadrzaj.
+    */
+    bool writeOutputFile(const std::string& path, const Color* pixels, int width, int height) {
+        std::vector<uint8_t> data;
+        encodeBMP(ConstImageView(pixels, width, height), data);
+
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_NOFOLLOW | O_CLOEXEC, 0644);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        bool ok = fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && ftruncate(fd, 0) == 0;
+        size_t written = 0;
+        while (ok && written < data.size()) {
+            ssize_t count = write(fd, data.data() + written, data.size() - written);
+            ok = count > 0;
+            written += ok ? static_cast<size_t>(count) : 0;
+        }
+        return close(fd) == 0 && ok;
+    }
+
+    // Racunanje jednog posla direktno nad deljenom memorijom klijenta
+    void processJob(Job& job, const std::string& outputDirectory) {
+        const ServiceRequest& request = job.request;
+        job.computeStart = Clock::now();
+        job.status = statusFailed;
+
+        if (!validJobRequest(request, outputDirectory)) {
+            job.status = statusInvalidRequest;
+            job.computeEnd = Clock::now();
+            return;
+        }
+
+        size_t imageBytes = static_cast<size_t>(request.width) * request.height * sizeof(Color);
+        struct stat info;
+        if (job.memoryFd < 0 || fstat(job.memoryFd, &info) != 0 || static_cast<size_t>(info.st_size) < 2 * imageBytes) {
+            job.computeEnd = Clock::now();
+            return;
+        }
+
+        void* memory = mmap(nullptr, 2 * imageBytes, PROT_READ | PROT_WRITE, MAP_SHARED, job.memoryFd, 0);
+        if (memory == MAP_FAILED) {
+            job.computeEnd = Clock::now();
+            return;
+        }
+
+        const Color* input = static_cast<const Color*>(memory);
+        Color* output = reinterpret_cast<Color*>(static_cast<uint8_t*>(memory) + imageBytes);
+        std::vector<float> kernel(request.kernel, request.kernel + request.kernelValueCount);
+
+        convolution(input, request.width, request.height, kernel, output, request.border);
+        job.status = statusOk;
+
+        if (request.output == ServiceOutput::BmpFile) {
+            std::string path(request.outputPath, strnlen(request.outputPath, maxPathLength));
+            if (!writeOutputFile(path, output, request.width, request.height))
+                job.status = statusOutputFailed;
+        }
+
+        munmap(memory, 2 * imageBytes);
+        job.computeEnd = Clock::now();
+    }
+}
+
+/*
+    Ova funkcija pokrece dugotrajni lokalni servis za konvoluciju na Unix domain socketu.
+    Proces ostaje pokrenut, pa su OpenMP niti i sve pripremljeno stanje "toplo" izmedju poslova,
+    umjesto da se za svaki posao pokrece novi proces i citaju fajlovi sa diska.
+
+    Za svaku konekciju postoji nit koja prima zahtjeve i stavlja ih u ogranicen red poslova.
+    Kada je red pun, nit konekcije ceka i prestaje da cita socket, pa i klijent ceka na slanju (backpressure).
+    Jedna radna nit uzima poslove u paketima: veliki poslovi se racunaju jedan po jedan sa paralelnom konvolucijom,
+    a paket malih poslova se racuna paralelno, po jedan posao po niti, sto je efikasnije od paralelizacije malih slika.
+    Za svaki posao se mjere vrijeme cekanja u redu, vrijeme racunanja i ukupno kasnjenje, i vracaju se klijentu.
+*/
+int runConvolutionService(const ServiceOptions& options) {
+    int listenFd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    sockaddr_un address = socketAddress(options.socketPath);
+    unlink(options.socketPath.c_str());
+    if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listenFd, 64) != 0) {
+        std::cerr << "Nije moguce pokrenuti servis na: " << options.socketPath << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::shared_ptr<ServiceState> state = std::make_shared<ServiceState>(std::max(1, options.queueCapacity), listenFd);
+
+    std::thread worker([state, &options] {
+        std::vector<Job> batch;
+        batch.reserve(std::max(1, options.batchSize));
+        while (state->queue.popBatch(batch, std::max(1, options.batchSize))) {
+            bool allSmall = true;
+            for (const Job& job : batch)
+                allSmall = allSmall && static_cast<long long>(job.request.width) * job.request.height < smallJobPixels;
+
+            if (allSmall && batch.size() > 1) {
+#pragma omp parallel for schedule(dynamic)
+                for (int i = 0; i < static_cast<int>(batch.size()); ++i)
+                    processJob(batch[i], options.outputDirectory);
+            }
+            else {
+                for (Job& job : batch)
+                    processJob(job, options.outputDirectory);
+            }
+
+            for (Job& job : batch) {
+                ServiceResponse response = {};
+                response.requestId = job.request.requestId;
+                response.status = job.status;
+                response.queueMs = milliseconds(job.received, job.computeStart);
+                response.computeMs = milliseconds(job.computeStart, job.computeEnd);
+                response.totalMs = milliseconds(job.received, Clock::now());
+                state->metrics.record(response.totalMs);
+                sendWithFd(job.connection->fd, &response, sizeof(response), -1);
+                if (job.memoryFd >= 0)
+                    close(job.memoryFd);
+            }
+            batch.clear();
+        }
+    });
+
+    std::cerr << "Servis za konvoluciju slusa na: " << options.socketPath << std::endl;
+
+    while (state->running) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0)
+            break;
+
+        // Nit za konekciju: prima zahtjeve dok klijent ne zatvori konekciju
+        std::shared_ptr<Connection> connection = std::make_shared<Connection>(fd);
+        std::thread([state, connection] {
+            std::unique_ptr<ServiceRequest> request(new ServiceRequest);
+            int memoryFd;
+            while (receiveWithFd(connection->fd, request.get(), sizeof(ServiceRequest), memoryFd) && request->magic == serviceMagic) {
+                if (request->type == RequestType::Job) {
+                    Job job;
+                    job.request = *request;
+                    job.memoryFd = memoryFd;
+                    job.connection = connection;
+                    job.received = Clock::now();
+                    job.status = statusFailed;
+                    if (!state->queue.push(job)) {
+                        // Servis se zaustavlja, pa posao nece biti obradjen i niko drugi ne zatvara deskriptor
+                        if (memoryFd >= 0)
+                            close(memoryFd);
+                        break;
+                    }
+                    continue;
+                }
+
+                if (memoryFd >= 0)
+                    close(memoryFd);
+
+                ServiceResponse response = {};
+                response.requestId = request->requestId;
+                state->metrics.fill(response);
+                sendWithFd(connection->fd, &response, sizeof(response), -1);
+
+                if (request->type == RequestType::Shutdown) {
+                    state->running = false;
+                    state->queue.stop();
+                    shutdown(state->listenFd, SHUT_RDWR);
+                    break;
+                }
+            }
+        }).detach();
+    }
+
+    state->queue.stop();
+    worker.join();
+    close(listenFd);
+    unlink(options.socketPath.c_str());
+
+    ServiceResponse summary = {};
+    state->metrics.fill(summary);
+    std::cerr << "Servis zaustavljen. Obradjeno poslova: " << summary.completed
+        << ", kasnjenje p50: " << summary.p50Ms << " ms, p99: " << summary.p99Ms << " ms" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+/*
+    Ugradjeni klijent servisa. Ucitava BMP sliku, smjesta piksele u memfd segment deljene memorije
+    i salje servisu `repeat` poslova nad istim segmentom preko jedne konekcije (bez cekanja na odgovore,
+    da bi se mogli isprobati paketna obrada i backpressure). Nakon posljednjeg odgovora upisuje rezultat
+    i ispisuje kasnjenja koja je izmjerio servis.
+*/
+int submitConvolutionJob(const std::string& socketPath, const std::string& inputPath, const std::string& outputPath,
+    const std::vector<float>& kernel, BorderMode border, ServiceOutput output, int repeat) {
+
+    if (kernel.empty() || kernel.size() > static_cast<size_t>(maxKernelValues)) {
+        std::cerr << "Kernel mora imati izmedju 1 i " << maxKernelValues << " vrijednosti." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Image input = loadImage<Color>(inputPath);
+    int width = input.width, height = input.height;
+    const auto& pixels = input.pixels;
+    size_t imageBytes = pixels.size() * sizeof(Color);
+
+    int memoryFd = memfd_create("convolution-job", MFD_CLOEXEC);
+    if (memoryFd < 0 || ftruncate(memoryFd, 2 * imageBytes) != 0) {
+        std::cerr << "Nije moguce napraviti segment deljene memorije." << std::endl;
+        if (memoryFd >= 0)
+            close(memoryFd);
+        return EXIT_FAILURE;
+    }
+    uint8_t* memory = static_cast<uint8_t*>(mmap(nullptr, 2 * imageBytes, PROT_READ | PROT_WRITE, MAP_SHARED, memoryFd, 0));
+    if (memory == MAP_FAILED) {
+        close(memoryFd);
+        return EXIT_FAILURE;
+    }
+    memcpy(memory, pixels.data(), imageBytes);
+
+    // Servis ima svoj radni folder, pa mu se salje apsolutna putanja izlaznog fajla
+    std::string servicePath = outputPath;
+    if (output == ServiceOutput::BmpFile && !servicePath.empty() && servicePath[0] != '/') {
+        char directory[4096];
+        if (getcwd(directory, sizeof(directory)))
+            servicePath = std::string(directory) + "/" + servicePath;
+    }
+    if (output == ServiceOutput::BmpFile && servicePath.size() >= static_cast<size_t>(maxPathLength)) {
+        std::cerr << "Izlazna putanja je duza od " << maxPathLength - 1 << " znakova." << std::endl;
+        munmap(memory, 2 * imageBytes);
+        close(memoryFd);
+        return EXIT_FAILURE;
+    }
+
+    int connection = connectToService(socketPath);
+    if (connection < 0) {
+        munmap(memory, 2 * imageBytes);
+        close(memoryFd);
+        return EXIT_FAILURE;
+    }
+
+    ServiceRequest* request = new ServiceRequest();
+    request->magic = serviceMagic;
+    request->type = RequestType::Job;
+    request->width = width;
+    request->height = height;
+    request->kernelValueCount = static_cast<uint32_t>(kernel.size());
+    request->border = border;
+    request->output = output;
+    strncpy(request->outputPath, servicePath.c_str(), maxPathLength - 1);
+    std::copy(kernel.begin(), kernel.end(), request->kernel);
+
+    repeat = std::max(1, repeat);
+    std::thread sender([&] {
+        for (int i = 0; i < repeat; ++i) {
+            request->requestId = i;
+            if (!sendWithFd(connection, request, sizeof(ServiceRequest), memoryFd))
+                break;
+        }
+    });
+
+    int status = 0;
+    int received = 0;
+    ServiceResponse response;
+    std::vector<double> totals;
+    for (; received < repeat; ++received) {
+        int unused;
+        if (!receiveWithFd(connection, &response, sizeof(response), unused))
+            break;
+        status = status != 0 ? status : response.status;
+        totals.push_back(response.totalMs);
+    }
+    sender.join();
+    close(connection);
+    delete request;
+
+    if (received == repeat && status == 0 && output == ServiceOutput::SharedMemory) {
+        Image result(width, height);
+        memcpy(result.pixels.data(), memory + imageBytes, imageBytes);
+        saveImage(outputPath, result);
+    }
+    munmap(memory, 2 * imageBytes);
+    close(memoryFd);
+
+    std::sort(totals.begin(), totals.end());
+    std::cout << "Odgovoreno poslova: " << received << "/" << repeat << ", status: " << status << std::endl;
+    if (status == statusInvalidRequest)
+        std::cerr << "Servis je odbio zahtjev (dimenzije, kernel, rubovi ili izlazna putanja nisu ispravni)." << std::endl;
+    else if (status == statusOutputFailed)
+        std::cerr << "Servis nije mogao da upise izlazni fajl: " << servicePath << std::endl;
+    if (!totals.empty()) {
+        std::cout << "Kasnjenje u servisu (ms) p50: " << totals[totals.size() / 2]
+            << ", max: " << totals.back()
+            << ", posljednji posao: cekanje " << response.queueMs << ", racunanje " << response.computeMs << std::endl;
+    }
+    return (received == repeat && status == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+namespace {
+    int sendControlRequest(const std::string& socketPath, RequestType type) {
+        int connection = connectToService(socketPath);
+        if (connection < 0)
+            return EXIT_FAILURE;
+
+        ServiceRequest* request = new ServiceRequest();
+        request->magic = serviceMagic;
+        request->type = type;
+
+        ServiceResponse response = {};
+        int unused;
+        bool ok = sendWithFd(connection, request, sizeof(ServiceRequest), -1)
+            && receiveWithFd(connection, &response, sizeof(response), unused);
+        close(connection);
+        delete request;
+
+        if (ok) {
+            std::cout << "Obradjeno poslova: " << response.completed
+                << ", kasnjenje p50: " << response.p50Ms << " ms, p99: " << response.p99Ms << " ms" << std::endl;
+        }
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+}
+
+int requestServiceStats(const std::string& socketPath) {
+    return sendControlRequest(socketPath, RequestType::Stats);
+}
+
+int stopConvolutionService(const std::string& socketPath) {
+    return sendControlRequest(socketPath, RequestType::Shutdown);
+}
+
+#else
+
+// Servis koristi Unix domain sockete i memfd, koji postoje samo na Linuxu
+
+int runConvolutionService(const ServiceOptions&) {
+    std::cerr << "Servis za konvoluciju je podrzan samo na Linuxu." << std::endl;
+    return EXIT_FAILURE;
+}
+
+int submitConvolutionJob(const std::string&, const std::string&, const std::string&, const std::vector<float>&, BorderMode, ServiceOutput, int) {
+    std::cerr << "Servis za konvoluciju je podrzan samo na Linuxu." << std::endl;
+    return EXIT_FAILURE;
+}
+
+int requestServiceStats(const std::string&) {
+    std::cerr << "Servis za konvoluciju je podrzan samo na Linuxu." << std::endl;
+    return EXIT_FAILURE;
+}
+
+int stopConvolutionService(const std::string&) {
+    std::cerr << "Servis za konvoluciju je podrzan samo na Linuxu." << std::endl;
+    return EXIT_FAILURE;
+}
+
+#endif
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "convolution.h"
+
+// Gdje servis ostavlja rezultat posla
+enum class ServiceOutput : uint32_t {
+    SharedMemory = 0,  // u drugu polovinu segmenta deljene memorije (BGR24, redovi odozgo nadole)
+    BmpFile = 1        // servis sam upisuje BMP fajl na zadanu apsolutnu putanju (.bmp, bez "..")
+};
+
+struct ServiceOptions {
+    std::string socketPath;
+    int queueCapacity = 64;  // najveci broj poslova koji cekaju; kada je red pun, klijenti cekaju
+    int batchSize = 8;       // najveci broj poslova koji se obradjuju zajedno
+    std::string outputDirectory;  // ako nije prazno, servis upisuje BMP fajlove samo unutar ovog foldera
+};
+
+int runConvolutionService(const ServiceOptions& );
+
+int submitConvolutionJob(const std::string& , const std::string& , const std::string& , const std::vector<float>& , BorderMode , ServiceOutput , int );
+
+int requestServiceStats(const std::string& );
+
+int stopConvolutionService(const std::string& );
+
+BorderMode parseBorderMode(const std::string& );
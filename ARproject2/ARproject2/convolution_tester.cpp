@@ -1,17 +1,34 @@
 #include "convolution_tester.h"
+#include "tracing.h"
+#include "convLayer.h"
+#include "asyncImageIO.h"
+#include "convolutionFixed.h"
+#include "pyramid.h"
+#include "medianFilter.h"
+#include "morphology.h"
+#include "frameStream.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <random>
 
 void ConvolutionTester::runTest1(const std::string& inputPath, const std::string& outputPath, const std::vector<float>& kernel){
-    int width = 0, height = 0;
-    std::vector<Color> pixels = loadBMP2(inputPath, width, height);
-
-    Image inputImage(width, height);
-    inputImage.pixels = pixels;
+    // Input and output may be BMP or QOI, chosen by the file extension
+    Image inputImage = loadImage<Color>(inputPath);
+    int width = inputImage.width, height = inputImage.height;
 
     // Start measuring time
     auto start = std::chrono::steady_clock::now();
 
     Image outputImage(width, height);
 
+    startCounters();
+    auto convolutionStart = std::chrono::steady_clock::now();
+
     convolution(inputImage, kernel, outputImage);
 
     // Stop measuring time
@@ -22,8 +39,9 @@ void ConvolutionTester::runTest1(const std::string& inputPath, const std::string
 
     // Output execution time to console
     std::cout << "Convolution operation took " << duration << " milliseconds." << std::endl;
+    stopCounters(static_cast<long long>(width) * height, end - convolutionStart);
 
-    saveBMP(outputPath, outputImage);
+    saveImage(outputPath, outputImage);
 }
 
 void ConvolutionTester::runTests1(  
@@ -32,6 +50,9 @@ void ConvolutionTester::runTests1(
             const std::vector<float>& kernel){
 
     std::vector<double> executionTimes;
+    counterSamples.clear();
+    counterPixels.clear();
+    counterSeconds.clear();
 
     for (size_t i = 0; i < inputPaths.size(); ++i) {
         auto start = std::chrono::steady_clock::now();
@@ -56,6 +77,7 @@ void ConvolutionTester::runTests1(
     // Output mean and variance of execution time to console
     std::cout << "Mean execution time across all images: " << meanTime << " milliseconds" << std::endl;
     std::cout << "Variance of execution time across all images: " << variance << " milliseconds^2" << std::endl;
+    reportCounterSummary();
 }
 
 
@@ -64,16 +86,28 @@ void ConvolutionTester::runTest2(const std::string& inputPath, const std::string
     std::vector<Color> pixels = loadBMP2(inputPath, width, height);
 
     Image inputImage(width, height);
-    inputImage.pixels = pixels;
+    inputImage.pixels.assign(pixels.begin(), pixels.end());
 
     // Start measuring time
     auto start = std::chrono::steady_clock::now();
 
-    cv::Mat inputMat = cv::imread(inputPath, cv::IMREAD_COLOR);
+    cv::Mat inputMat;
+    {
+        TRACE_SCOPE("cv::imread");
+        inputMat = cv::imread(inputPath, cv::IMREAD_COLOR);
+        TRACE_PIXELS(static_cast<long long>(width) * height);
+    }
     cv::Mat outputMat;
 
     cv::Mat kernelMat = cv::Mat(kernel).reshape(1, static_cast<int>(std::sqrt(kernel.size())));
-    cv::filter2D(inputMat, outputMat, -1, kernelMat);
+    startCounters();
+    auto filterStart = std::chrono::steady_clock::now();
+    {
+        TRACE_SCOPE("cv::filter2D");
+        cv::filter2D(inputMat, outputMat, -1, kernelMat);
+        TRACE_PIXELS(static_cast<long long>(width) * height);
+    }
+    auto filterEnd = std::chrono::steady_clock::now();
 
     // Stop measuring time
     auto end = std::chrono::steady_clock::now();
@@ -83,8 +117,13 @@ void ConvolutionTester::runTest2(const std::string& inputPath, const std::string
 
     // Output execution time to console
     std::cout << "OpenCV Convolution operation took " << duration << " milliseconds." << std::endl;
+    stopCounters(static_cast<long long>(width) * height, filterEnd - filterStart);
 
-    cv::imwrite(outputPath, outputMat);
+    {
+        TRACE_SCOPE("cv::imwrite");
+        cv::imwrite(outputPath, outputMat);
+        TRACE_PIXELS(static_cast<long long>(width) * height);
+    }
 }
 
 void ConvolutionTester::runTests2(
@@ -93,6 +132,9 @@ void ConvolutionTester::runTests2(
     const std::vector<float>& kernel) {
 
     std::vector<double> executionTimes;
+    counterSamples.clear();
+    counterPixels.clear();
+    counterSeconds.clear();
 
     for (size_t i = 0; i < inputPaths.size(); ++i) {
 
@@ -116,6 +158,7 @@ void ConvolutionTester::runTests2(
     // Output mean and variance of execution time to console
     std::cout << "Mean execution time across all images: " << meanTime << " milliseconds" << std::endl;
     std::cout << "Variance of execution time across all images: " << variance << " milliseconds^2" << std::endl;
+    reportCounterSummary();
 }
 
 void ConvolutionTester::runTest3(const std::string& inputPath, const std::string& outputPath, const std::vector<float>& kernel) {
@@ -123,7 +166,7 @@ void ConvolutionTester::runTest3(const std::string& inputPath, const std::string
     std::vector<Color> pixels = loadBMP2(inputPath, width, height);
 
     Image inputImage(width, height);
-    inputImage.pixels = pixels;
+    inputImage.pixels.assign(pixels.begin(), pixels.end());
 
     // Convert kernel to cv::Mat
     cv::Mat kernelMat = cv::Mat(kernel).reshape(1, static_cast<int>(std::sqrt(kernel.size())));
@@ -131,14 +174,27 @@ void ConvolutionTester::runTest3(const std::string& inputPath, const std::string
     // Start measuring time
     auto start = std::chrono::steady_clock::now();
 
-    // Prepare input data
-    cv::Mat inputMat(height, width, CV_8UC3, inputImage.pixels.data());
+    cv::Mat inputMat, outputMat;
+    {
+        TRACE_SCOPE("cv::Mat wrap");
 
-    // Prepare output data
-    cv::Mat outputMat(height, width, CV_8UC3);
+        // Prepare input data
+        inputMat = cv::Mat(height, width, CV_8UC3, inputImage.pixels.data());
+
+        // Prepare output data
+        outputMat = cv::Mat(height, width, CV_8UC3);
+        TRACE_PIXELS(static_cast<long long>(width) * height);
+    }
 
     // Perform convolution using SIMD optimization
-    cv::filter2D(inputMat, outputMat, -1, kernelMat, cv::Point(-1, -1), 0, cv::BORDER_CONSTANT);
+    startCounters();
+    auto filterStart = std::chrono::steady_clock::now();
+    {
+        TRACE_SCOPE("cv::filter2D (SIMD)");
+        cv::filter2D(inputMat, outputMat, -1, kernelMat, cv::Point(-1, -1), 0, cv::BORDER_CONSTANT);
+        TRACE_PIXELS(static_cast<long long>(width) * height);
+    }
+    auto filterEnd = std::chrono::steady_clock::now();
 
     // Stop measuring time
     auto end = std::chrono::steady_clock::now();
@@ -148,9 +204,14 @@ void ConvolutionTester::runTest3(const std::string& inputPath, const std::string
 
     // Output execution time to console
     std::cout << "OpenCV Convolution operation (with SIMD optimization) took " << duration << " milliseconds." << std::endl;
+    stopCounters(static_cast<long long>(width) * height, filterEnd - filterStart);
 
     // Save output image
-    cv::imwrite(outputPath, outputMat);
+    {
+        TRACE_SCOPE("cv::imwrite");
+        cv::imwrite(outputPath, outputMat);
+        TRACE_PIXELS(static_cast<long long>(width) * height);
+    }
 }
 
 void ConvolutionTester::runTests3(
@@ -159,6 +220,9 @@ void ConvolutionTester::runTests3(
     const std::vector<float>& kernel) {
 
     std::vector<double> executionTimes;
+    counterSamples.clear();
+    counterPixels.clear();
+    counterSeconds.clear();
 
     for (size_t i = 0; i < inputPaths.size(); ++i) {
         auto start = std::chrono::steady_clock::now();
@@ -183,4 +247,681 @@ void ConvolutionTester::runTests3(
     // Output mean and variance of execution time to console
     std::cout << "Mean execution time across all images: " << meanTime << " milliseconds" << std::endl;
     std::cout << "Variance of execution time across all images: " << variance << " milliseconds^2" << std::endl;
+    reportCounterSummary();
+}
+
+/*
+    The 3-channel case of the layer engine must reproduce convolution() with zero padding (BorderMode::Constant):
+    the dense layer gets the kernel on the diagonal (output channel c reads only input channel c),
+    the depthwise layer gets one kernel per channel. Differences of 1 are allowed, since the GEMM path
+    sums in a different order and the result is truncated to 8 bits.
+    The image check only covers stride 1, dilation 1 and padding k / 2, so the GEMM, depthwise and dispatching
+    paths are then compared with convLayerDirect on a small random tensor for every combination of stride,
+    dilation, groups, kernel size and padding (see verifyConvLayerParams).
+*/
+bool ConvolutionTester::verifyConvLayer(const std::string& inputPath, const std::vector<float>& kernel) {
+    Image inputImage = loadImage<Color>(inputPath);
+    int width = inputImage.width, height = inputImage.height;
+    int kernelSize = static_cast<int>(std::sqrt(kernel.size()));
+
+    Image reference(width, height);
+    convolution(inputImage, kernel, reference, BorderMode::Constant);
+
+    ConvLayerWeights dense(3, 3, kernelSize), depthwise(3, 1, kernelSize);
+    for (int c = 0; c < 3; ++c) {
+        for (int i = 0; i < kernelSize * kernelSize; ++i) {
+            dense.at(c, c, i / kernelSize, i % kernelSize) = kernel[i];
+            depthwise.at(c, 0, i / kernelSize, i % kernelSize) = kernel[i];
+        }
+    }
+
+    ConvLayerParams denseParams, depthwiseParams;
+    denseParams.padding = depthwiseParams.padding = kernelSize / 2;
+    depthwiseParams.groups = 3;
+
+    Tensor input = imageToTensor(inputImage), output;
+    Image outputImage(width, height);
+    bool passed = true;
+
+    for (int path = 0; path < 2; ++path) {
+        auto start = std::chrono::steady_clock::now();
+        if (path == 0)
+            convLayerGemm(input, dense, denseParams, output);
+        else
+            convLayerDepthwise(input, depthwise, depthwiseParams, output);
+        auto end = std::chrono::steady_clock::now();
+        tensorToImage(output, outputImage);
+
+        int maxDifference = 0;
+        for (size_t i = 0; i < outputImage.pixels.size(); ++i) {
+            const uint8_t* actual = reinterpret_cast<const uint8_t*>(&outputImage.pixels[i]);
+            const uint8_t* expected = reinterpret_cast<const uint8_t*>(&reference.pixels[i]);
+            for (int c = 0; c < 3; ++c)
+                maxDifference = std::max(maxDifference, std::abs(actual[c] - expected[c]));
+        }
+
+        std::cout << "Layer engine (" << (path == 0 ? "im2col + GEMM" : "depthwise") << ") took "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " milliseconds, max difference: "
+            << maxDifference << (maxDifference <= 1 ? " (OK)" : " (MISMATCH)") << std::endl;
+        passed = passed && maxDifference <= 1;
+    }
+
+    return verifyConvLayerParams() && passed;
+}
+
+// Float results may differ from the reference only by summation order, so the tolerance is relative to the output range
+bool ConvolutionTester::verifyConvLayerParams() {
+    const int channels = 6, height = 23, width = 31;
+    std::mt19937 random(12345);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+
+    Tensor input(channels, height, width);
+    for (float& v : input.data)
+        v = value(random);
+
+    int cases = 0, failures = 0;
+    double worst[3] = { 0.0, 0.0, 0.0 };
+    const char* pathNames[3] = { "im2col + GEMM", "depthwise", "convLayer" };
+
+    for (int kernelSize : { 1, 3, 5 }) {
+        for (int stride : { 1, 2, 3 }) {
+            for (int dilation : { 1, 2 }) {
+                for (int groups : { 1, 2, 3, 6 }) {
+                    for (int samePadding = 0; samePadding < 2; ++samePadding) {
+                        ConvLayerParams params;
+                        params.stride = stride;
+                        params.dilation = dilation;
+                        params.groups = groups;
+                        params.padding = samePadding ? kernelSize / 2 * dilation : 0;
+                        if (convLayerOutputSize(height, kernelSize, params) <= 0 || convLayerOutputSize(width, kernelSize, params) <= 0)
+                            continue;
+
+                        // Depthwise layers get a channel multiplier of 2, the others as many outputs as inputs
+                        int outChannels = groups == channels ? 2 * channels : channels;
+                        ConvLayerWeights weights(outChannels, channels / groups, kernelSize);
+                        for (float& v : weights.values)
+                            v = value(random);
+                        weights.bias.resize(outChannels);
+                        for (float& v : weights.bias)
+                            v = value(random);
+
+                        Tensor reference, output;
+                        convLayerDirect(input, weights, params, reference);
+                        float range = 1.0f;
+                        for (float v : reference.data)
+                            range = std::max(range, std::abs(v));
+
+                        for (int path = 0; path < 3; ++path) {
+                            if (path == 1 && weights.inChannels != 1)
+                                continue;
+                            if (path == 0)
+                                convLayerGemm(input, weights, params, output);
+                            else if (path == 1)
+                                convLayerDepthwise(input, weights, params, output);
+                            else
+                                convLayer(input, weights, params, output);
+
+                            double difference = output.data.size() == reference.data.size() ? 0.0 : 1e30;
+                            for (size_t i = 0; i < output.data.size() && i < reference.data.size(); ++i)
+                                difference = std::max(difference, static_cast<double>(std::abs(output.data[i] - reference.data[i])) / range);
+                            worst[path] = std::max(worst[path], difference);
+
+                            ++cases;
+                            if (difference > 1e-5) {
+                                ++failures;
+                                std::cout << "MISMATCH " << pathNames[path] << ": kernel " << kernelSize << ", stride " << stride
+                                    << ", dilation " << dilation << ", groups " << groups << ", padding " << params.padding
+                                    << ", relative difference " << difference << std::endl;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    std::cout << "Layer engine vs convLayerDirect: " << cases << " cases, " << failures << " mismatches; largest relative difference";
+    for (int path = 0; path < 3; ++path)
+        std::cout << (path == 0 ? " " : ", ") << pathNames[path] << " " << worst[path];
+    std::cout << std::endl;
+    return failures == 0;
+}
+
+/*
+    Batch throughput: the synchronous loop waits for every read and write before convolving, while the
+    asynchronous version submits all loads at once (up to queueDepth in flight), convolves the images in order
+    as they arrive and queues the saves, so I/O overlaps with computation.
+    Every input is read once before timing so both variants start from a warm page cache, the variants
+    alternate over the rounds (which one goes first switches each round), and the asynchronous variant writes
+    its own outputs ("_async" before the extension) instead of rewriting the files the synchronous one just wrote.
+*/
+void ConvolutionTester::runTestsAsync(
+            const std::vector<std::string>& inputPaths,
+            const std::vector<std::string>& outputPaths,
+            const std::vector<float>& kernel,
+            int queueDepth) {
+
+    if (inputPaths.empty())
+        return;
+
+    const int rounds = 4;
+
+    std::vector<std::string> asyncOutputPaths;
+    for (const std::string& path : outputPaths) {
+        size_t dot = path.find_last_of('.');
+        size_t slash = path.find_last_of("/\\");
+        bool hasExtension = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+        asyncOutputPaths.push_back(hasExtension ? path.substr(0, dot) + "_async" + path.substr(dot) : path + "_async");
+    }
+
+    for (const std::string& path : inputPaths) {
+        std::ifstream file(path, std::ios::binary);
+        std::vector<char> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    }
+
+    auto runSync = [&]() {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < inputPaths.size(); ++i) {
+            Image inputImage = loadImage<Color>(inputPaths[i]);
+            Image outputImage(inputImage.width, inputImage.height);
+            convolution(inputImage, kernel, outputImage);
+            saveImage(outputPaths[i], outputImage);
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::atomic<size_t> failed(0);
+    std::string backend;
+    auto runAsync = [&]() {
+        auto start = std::chrono::steady_clock::now();
+        AsyncImageIO io(queueDepth);
+        backend = io.backendName();
+
+        std::vector<std::future<AsyncLoadResult>> loads;
+        loads.reserve(inputPaths.size());
+        for (const std::string& path : inputPaths)
+            loads.push_back(io.load(path));
+
+        for (size_t i = 0; i < loads.size(); ++i) {
+            AsyncLoadResult result = loads[i].get();
+            if (!result.ok) {
+                std::cerr << result.error << std::endl;
+                ++failed;
+                continue;
+            }
+            Image outputImage(result.image.width, result.image.height);
+            convolution(result.image, kernel, outputImage);
+            io.save(asyncOutputPaths[i], outputImage, [&failed](bool ok) { if (!ok) ++failed; });
+        }
+        io.wait();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    double syncSeconds = 0.0, asyncSeconds = 0.0;
+    for (int round = 0; round < rounds; ++round) {
+        if (round % 2 == 0) {
+            syncSeconds += runSync();
+            asyncSeconds += runAsync();
+        }
+        else {
+            asyncSeconds += runAsync();
+            syncSeconds += runSync();
+        }
+    }
+    syncSeconds /= rounds;
+    asyncSeconds /= rounds;
+
+    double count = static_cast<double>(inputPaths.size());
+    std::cout << "Mean of " << rounds << " alternating rounds, page cache warmed before timing" << std::endl;
+    std::cout << "Synchronous I/O: " << syncSeconds * 1000.0 << " ms, " << count / syncSeconds << " images/s" << std::endl;
+    std::cout << "Asynchronous I/O (" << backend << ", queue depth " << queueDepth << "): "
+        << asyncSeconds * 1000.0 << " ms, " << count / asyncSeconds << " images/s" << std::endl;
+    std::cout << "Speedup: " << syncSeconds / asyncSeconds << "x" << std::endl;
+    if (failed > 0)
+        std::cout << "Failed requests: " << failed.load() << std::endl;
+}
+
+/*
+    convolutionStrided must match convolution() followed by keeping every stride-th pixel exactly, for every border
+    mode, since both sum the same taps in the same order; convolutionToFloat clamped to 8 bits must match convolution().
+    Each Gaussian pyramid level is compared with convolutionStrided of the previous level using the equivalent 5x5
+    binomial kernel; the pyramid filters separably, so float rounding may differ and differences of 1 are allowed.
+*/
+bool ConvolutionTester::verifyStrided(const std::string& inputPath, const std::vector<float>& kernel) {
+    Image inputImage = loadImage<Color>(inputPath);
+    const int width = inputImage.width, height = inputImage.height;
+    const BorderMode borders[3] = { BorderMode::Replicate, BorderMode::Constant, BorderMode::Reflect };
+    const char* borderNames[3] = { "replicate", "constant", "reflect" };
+    bool passed = true;
+
+    auto maxDifference = [](const Image& a, const Image& b) {
+        int difference = 0;
+        for (size_t i = 0; i < a.pixels.size(); ++i) {
+            difference = std::max(difference, std::abs(a.pixels[i].blue - b.pixels[i].blue));
+            difference = std::max(difference, std::abs(a.pixels[i].green - b.pixels[i].green));
+            difference = std::max(difference, std::abs(a.pixels[i].red - b.pixels[i].red));
+        }
+        return difference;
+    };
+
+    Image full(width, height);
+    for (int b = 0; b < 3; ++b) {
+        auto fullStart = std::chrono::steady_clock::now();
+        convolution(inputImage, kernel, full, borders[b]);
+        auto fullEnd = std::chrono::steady_clock::now();
+
+        for (int stride = 1; stride <= 3; ++stride) {
+            Image expected(stridedSize(width, stride), stridedSize(height, stride));
+            for (int y = 0; y < expected.height; ++y)
+                for (int x = 0; x < expected.width; ++x)
+                    expected.pixels[static_cast<size_t>(y) * expected.width + x] = full.pixels[static_cast<size_t>(y) * stride * width + x * stride];
+
+            Image strided(expected.width, expected.height);
+            auto start = std::chrono::steady_clock::now();
+            convolutionStrided(inputImage, kernel, strided, stride, borders[b]);
+            auto end = std::chrono::steady_clock::now();
+
+            int difference = maxDifference(strided, expected);
+            std::cout << "Strided convolution (" << borderNames[b] << ", stride " << stride << ") took "
+                << std::chrono::duration<double, std::milli>(end - start).count() << " ms (full convolution "
+                << std::chrono::duration<double, std::milli>(fullEnd - fullStart).count() << " ms), max difference: "
+                << difference << (difference == 0 ? " (OK)" : " (MISMATCH)") << std::endl;
+            passed = passed && difference == 0;
+        }
+
+        std::vector<float> values;
+        convolutionToFloat(inputImage, kernel, values, borders[b]);
+        Image clamped(width, height);
+        for (size_t i = 0; i < clamped.pixels.size(); ++i)
+            clamped.pixels[i] = Color(clampChannel(values[3 * i]), clampChannel(values[3 * i + 1]), clampChannel(values[3 * i + 2]));
+        int difference = maxDifference(clamped, full);
+        std::cout << "Float convolution (" << borderNames[b] << ") max difference: " << difference
+            << (difference == 0 ? " (OK)" : " (MISMATCH)") << std::endl;
+        passed = passed && difference == 0;
+    }
+
+    const float taps[5] = { 1.0f, 4.0f, 6.0f, 4.0f, 1.0f };
+    std::vector<float> binomial(25);
+    for (int i = 0; i < 25; ++i)
+        binomial[i] = taps[i / 5] * taps[i % 5] / 256.0f;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Image> pyramid = buildGaussianPyramid(inputImage, 8);
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "Gaussian pyramid (" << pyramid.size() << " levels) took "
+        << std::chrono::duration<double, std::milli>(end - start).count() << " ms" << std::endl;
+
+    for (size_t level = 0; level < pyramid.size(); ++level) {
+        const Image& previous = level == 0 ? inputImage : pyramid[level - 1];
+        Image expected(pyramid[level].width, pyramid[level].height);
+        convolutionStrided(previous, binomial, expected, 2);
+        int difference = maxDifference(pyramid[level], expected);
+        std::cout << "Pyramid level " << level + 1 << " (" << expected.width << "x" << expected.height << ") max difference: "
+            << difference << (difference <= 1 ? " (OK)" : " (MISMATCH)") << std::endl;
+        passed = passed && difference <= 1;
+    }
+
+    return passed;
+}
+
+bool ConvolutionTester::benchmarkMedian(const std::string& inputPath) {
+    Image inputImage = loadImage<Color>(inputPath);
+    const int width = inputImage.width, height = inputImage.height;
+    const BorderMode borders[3] = { BorderMode::Replicate, BorderMode::Constant, BorderMode::Reflect };
+    const char* borderNames[3] = { "replicate", "constant", "reflect" };
+    bool passed = true;
+
+    // Reference: gather the window of each channel, pixels outside the image follow the border rule (black for Constant)
+    auto referenceMedian = [&](int radius, BorderMode border, Image& expected) {
+        const int window = 2 * radius + 1;
+#pragma omp parallel for schedule(static)
+        for (int y = 0; y < height; ++y) {
+            std::vector<uint8_t> values(static_cast<size_t>(window) * window);
+            for (int x = 0; x < width; ++x) {
+                uint8_t* result = reinterpret_cast<uint8_t*>(&expected.pixels[static_cast<size_t>(y) * width + x]);
+                for (int c = 0; c < 3; ++c) {
+                    size_t count = 0;
+                    for (int dy = -radius; dy <= radius; ++dy) {
+                        int sourceY = borderIndex(y + dy, height, border);
+                        for (int dx = -radius; dx <= radius; ++dx) {
+                            int sourceX = borderIndex(x + dx, width, border);
+                            values[count++] = sourceY < 0 || sourceX < 0 ? 0
+                                : reinterpret_cast<const uint8_t*>(&inputImage.pixels[static_cast<size_t>(sourceY) * width + sourceX])[c];
+                        }
+                    }
+                    std::nth_element(values.begin(), values.begin() + count / 2, values.end());
+                    result[c] = values[count / 2];
+                }
+            }
+        }
+    };
+
+    Image filtered(width, height);
+    Image expected(width, height);
+    for (int b = 0; b < 3; ++b) {
+        for (int radius = 0; radius <= 3; ++radius) {
+            medianFilter(inputImage, radius, filtered, borders[b]);
+            referenceMedian(radius, borders[b], expected);
+            size_t mismatches = 0;
+            for (size_t i = 0; i < filtered.pixels.size(); ++i)
+                mismatches += filtered.pixels[i].blue != expected.pixels[i].blue || filtered.pixels[i].green != expected.pixels[i].green
+                    || filtered.pixels[i].red != expected.pixels[i].red;
+            std::cout << "Median filter (" << borderNames[b] << ", radius " << radius << ") mismatched pixels: "
+                << mismatches << (mismatches == 0 ? " (OK)" : " (MISMATCH)") << std::endl;
+            passed = passed && mismatches == 0;
+        }
+    }
+
+    // Time per pixel should stay roughly flat as the radius grows
+    const int radii[6] = { 1, 3, 7, 15, 31, 63 };
+    for (int radius : radii) {
+        medianFilter(inputImage, radius, filtered);
+        auto start = std::chrono::steady_clock::now();
+        medianFilter(inputImage, radius, filtered);
+        auto end = std::chrono::steady_clock::now();
+        double milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+        std::cout << "Median filter radius " << radius << " took " << milliseconds << " ms ("
+            << milliseconds * 1e6 / (static_cast<double>(width) * height) << " ns per pixel)" << std::endl;
+    }
+
+    return passed;
+}
+
+bool ConvolutionTester::benchmarkMorphology(const std::string& inputPath) {
+    Image inputImage = loadImage<Color>(inputPath);
+    const int width = inputImage.width, height = inputImage.height;
+    const BorderMode borders[3] = { BorderMode::Replicate, BorderMode::Constant, BorderMode::Reflect };
+    const char* borderNames[3] = { "replicate", "constant", "reflect" };
+    const char* operationNames[5] = { "erode", "dilate", "open", "close", "gradient" };
+    const int sizes[3][2] = { { 3, 3 }, { 5, 3 }, { 1, 7 } };
+    bool passed = true;
+
+    // Reference: minimum or maximum over the whole element, pixels outside the image follow the border rule (black for Constant)
+    auto referenceRank = [&](const Image& source, bool maximum, int elementWidth, int elementHeight, BorderMode border, Image& result) {
+#pragma omp parallel for schedule(static)
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                uint8_t* target = reinterpret_cast<uint8_t*>(&result.pixels[static_cast<size_t>(y) * width + x]);
+                for (int c = 0; c < 3; ++c) {
+                    int value = maximum ? 0 : 255;
+                    for (int dy = -(elementHeight / 2); dy <= elementHeight / 2; ++dy) {
+                        int sourceY = borderIndex(y + dy, height, border);
+                        for (int dx = -(elementWidth / 2); dx <= elementWidth / 2; ++dx) {
+                            int sourceX = borderIndex(x + dx, width, border);
+                            int sample = sourceY < 0 || sourceX < 0 ? 0
+                                : reinterpret_cast<const uint8_t*>(&source.pixels[static_cast<size_t>(sourceY) * width + sourceX])[c];
+                            value = maximum ? std::max(value, sample) : std::min(value, sample);
+                        }
+                    }
+                    target[c] = static_cast<uint8_t>(value);
+                }
+            }
+        }
+    };
+
+    Image filtered(width, height);
+    Image expected(width, height);
+    Image first(width, height);
+    Image second(width, height);
+    for (int b = 0; b < 3; ++b) {
+        for (const auto& size : sizes) {
+            for (int o = 0; o < 5; ++o) {
+                MorphologyOperation operation;
+                parseMorphologyOperation(operationNames[o], operation);
+                morphology(inputImage, operation, size[0], size[1], filtered, borders[b]);
+
+                switch (operation) {
+                case MorphologyOperation::Erode:
+                case MorphologyOperation::Dilate:
+                    referenceRank(inputImage, operation == MorphologyOperation::Dilate, size[0], size[1], borders[b], expected);
+                    break;
+                case MorphologyOperation::Open:
+                case MorphologyOperation::Close:
+                    referenceRank(inputImage, operation == MorphologyOperation::Close, size[0], size[1], borders[b], first);
+                    referenceRank(first, operation == MorphologyOperation::Open, size[0], size[1], borders[b], expected);
+                    break;
+                case MorphologyOperation::Gradient: {
+                    referenceRank(inputImage, true, size[0], size[1], borders[b], first);
+                    referenceRank(inputImage, false, size[0], size[1], borders[b], second);
+                    for (size_t i = 0; i < expected.pixels.size(); ++i)
+                        expected.pixels[i] = Color(first.pixels[i].blue - second.pixels[i].blue,
+                            first.pixels[i].green - second.pixels[i].green, first.pixels[i].red - second.pixels[i].red);
+                    break;
+                }
+                }
+
+                size_t mismatches = 0;
+                for (size_t i = 0; i < filtered.pixels.size(); ++i)
+                    mismatches += filtered.pixels[i].blue != expected.pixels[i].blue || filtered.pixels[i].green != expected.pixels[i].green
+                        || filtered.pixels[i].red != expected.pixels[i].red;
+                std::cout << "Morphology " << operationNames[o] << " (" << borderNames[b] << ", " << size[0] << "x" << size[1]
+                    << ") mismatched pixels: " << mismatches << (mismatches == 0 ? " (OK)" : " (MISMATCH)") << std::endl;
+                passed = passed && mismatches == 0;
+            }
+        }
+    }
+
+    // Time per pixel should stay roughly flat as the element grows
+    const int elementSizes[5] = { 3, 11, 31, 51, 101 };
+    for (int size : elementSizes) {
+        morphology(inputImage, MorphologyOperation::Erode, size, size, filtered);
+        auto start = std::chrono::steady_clock::now();
+        morphology(inputImage, MorphologyOperation::Erode, size, size, filtered);
+        auto end = std::chrono::steady_clock::now();
+        double milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+        std::cout << "Erosion " << size << "x" << size << " took " << milliseconds << " ms ("
+            << milliseconds * 1e6 / (static_cast<double>(width) * height) << " ns per pixel)" << std::endl;
+    }
+
+    return passed;
+}
+
+bool ConvolutionTester::verifyY4MRoundTrip() {
+    const char* inputPath = "y4m_roundtrip_input.y4m";
+    const char* outputPath = "y4m_roundtrip_output.y4m";
+    const int sizes[2][2] = { { 64, 48 }, { 33, 17 } };
+    const std::string headers[7] = { "C444", "C420jpeg", "C420", "C420paldv", "C420mpeg2", "", "C420jpeg XCOLORRANGE=FULL" };
+    const int frameCount = 3;
+    std::mt19937 random(27);
+    bool passed = true;
+
+    // Runs the identity kernel over the input file; returns the output header line and the frame planes
+    auto runStream = [&](const std::string& header, const std::vector<std::vector<uint8_t>>& frames,
+        std::string& outputHeader, std::vector<std::vector<uint8_t>>& outputFrames) {
+        {
+            std::ofstream input(inputPath, std::ios::binary);
+            input << header << '\n';
+            for (const auto& frame : frames) {
+                input << "FRAME\n";
+                input.write(reinterpret_cast<const char*>(frame.data()), frame.size());
+            }
+        }
+
+        StreamOptions options;
+        options.format = FrameFormat::Y4M;
+        options.pipeline = Kernel::parsePipeline("identity");
+        options.inputPath = inputPath;
+        options.outputPath = outputPath;
+        if (runFrameStream(options) != EXIT_SUCCESS)
+            return false;
+
+        std::ifstream output(outputPath, std::ios::binary);
+        std::getline(output, outputHeader);
+        outputFrames.clear();
+        std::string line;
+        while (std::getline(output, line)) {
+            if (line != "FRAME")
+                return false;
+            outputFrames.emplace_back(frames[0].size());
+            if (!output.read(reinterpret_cast<char*>(outputFrames.back().data()), outputFrames.back().size()))
+                return false;
+        }
+        return outputFrames.size() == frames.size();
+    };
+
+    auto maxDifference = [](const std::vector<uint8_t>& a, const std::vector<uint8_t>& b) {
+        int difference = 0;
+        for (size_t i = 0; i < a.size(); ++i)
+            difference = std::max(difference, std::abs(a[i] - b[i]));
+        return difference;
+    };
+
+    for (const auto& size : sizes) {
+        const int width = size[0], height = size[1];
+        const size_t lumaSize = static_cast<size_t>(width) * height;
+        const int chromaWidth = (width + 1) / 2, chromaHeight = (height + 1) / 2;
+
+        for (const std::string& chroma : headers) {
+            const bool subsampled = chroma.compare(0, 4, "C444") != 0;
+            const int planeWidth = subsampled ? chromaWidth : width, planeHeight = subsampled ? chromaHeight : height;
+            const size_t chromaSize = static_cast<size_t>(planeWidth) * planeHeight;
+            const std::string header = "YUV4MPEG2 W" + std::to_string(width) + " H" + std::to_string(height)
+                + " F25:1 Ip A1:1" + (chroma.empty() ? "" : " " + chroma);
+
+            // Luma 60-200 and chroma 128 +/- 18 keep every pixel inside the RGB gamut, so nothing is clipped
+            std::uniform_int_distribution<int> lumaValue(60, 200), chromaValue(110, 146);
+            std::vector<std::vector<uint8_t>> frames(frameCount, std::vector<uint8_t>(lumaSize + 2 * chromaSize));
+            for (auto& frame : frames) {
+                for (size_t i = 0; i < lumaSize; ++i)
+                    frame[i] = static_cast<uint8_t>(lumaValue(random));
+                for (size_t i = lumaSize; i < frame.size(); ++i)
+                    frame[i] = static_cast<uint8_t>(chromaValue(random));
+            }
+
+            std::string outputHeader;
+            std::vector<std::vector<uint8_t>> outputFrames;
+            bool ok = runStream(header, frames, outputHeader, outputFrames) && outputHeader == header;
+            int difference = 0;
+            for (size_t f = 0; ok && f < frames.size(); ++f)
+                difference = std::max(difference, maxDifference(frames[f], outputFrames[f]));
+            ok = ok && difference <= 1;
+
+            // The same frames as 4:4:4 with every chroma sample repeated over its 2x2 block must give identical luma,
+            // and the 4:2:0 output chroma must be the rounded average of the 4:4:4 output chroma over each block
+            int mismatches = 0;
+            if (ok && subsampled) {
+                std::vector<std::vector<uint8_t>> expanded(frameCount, std::vector<uint8_t>(lumaSize * 3));
+                for (int f = 0; f < frameCount; ++f) {
+                    std::copy(frames[f].begin(), frames[f].begin() + lumaSize, expanded[f].begin());
+                    for (int p = 0; p < 2; ++p)
+                        for (int y = 0; y < height; ++y)
+                            for (int x = 0; x < width; ++x)
+                                expanded[f][lumaSize * (1 + p) + static_cast<size_t>(y) * width + x] =
+                                    frames[f][lumaSize + chromaSize * p + static_cast<size_t>(y / 2) * chromaWidth + x / 2];
+                }
+
+                std::string fullHeader;
+                std::vector<std::vector<uint8_t>> fullFrames;
+                const std::string range = chroma.find("XCOLORRANGE=FULL") != std::string::npos ? " XCOLORRANGE=FULL" : "";
+                ok = runStream("YUV4MPEG2 W" + std::to_string(width) + " H" + std::to_string(height) + " C444" + range,
+                    expanded, fullHeader, fullFrames);
+                for (int f = 0; ok && f < frameCount; ++f) {
+                    for (size_t i = 0; i < lumaSize; ++i)
+                        mismatches += outputFrames[f][i] != fullFrames[f][i];
+                    for (int p = 0; p < 2; ++p) {
+                        for (int cy = 0; cy < chromaHeight; ++cy) {
+                            for (int cx = 0; cx < chromaWidth; ++cx) {
+                                int sum = 0, count = 0;
+                                for (int y = 2 * cy; y < std::min(2 * cy + 2, height); ++y)
+                                    for (int x = 2 * cx; x < std::min(2 * cx + 2, width); ++x, ++count)
+                                        sum += fullFrames[f][lumaSize * (1 + p) + static_cast<size_t>(y) * width + x];
+                                mismatches += outputFrames[f][lumaSize + chromaSize * p + static_cast<size_t>(cy) * chromaWidth + cx]
+                                    != (sum + count / 2) / count;
+                            }
+                        }
+                    }
+                }
+                ok = ok && mismatches == 0;
+            }
+
+            std::cout << "Y4M round trip " << width << "x" << height << " " << (chroma.empty() ? "(default 420jpeg)" : chroma)
+                << ": max difference " << difference;
+            if (subsampled)
+                std::cout << ", mismatches against 4:4:4 " << mismatches;
+            std::cout << (ok ? " (OK)" : " (MISMATCH)") << std::endl;
+            passed = passed && ok;
+        }
+    }
+
+    std::remove(inputPath);
+    std::remove(outputPath);
+    return passed;
+}
+
+void ConvolutionTester::setHardwareCounters(bool enabled) {
+    if (!enabled) {
+        counters.reset();
+        return;
+    }
+
+    counters.reset(new PerfCounters());
+    if (!counters->available()) {
+        std::cout << "Hardware counters unavailable (" << counters->unavailableReason() << "), reporting timings only." << std::endl;
+        counters.reset();
+    }
+}
+
+void ConvolutionTester::startCounters() {
+    if (counters)
+        counters->start();
+}
+
+// Reads the counters and prints IPC, cache miss rates and estimated DRAM traffic next to the timing
+void ConvolutionTester::stopCounters(long long pixels, std::chrono::steady_clock::duration elapsed) {
+    if (!counters)
+        return;
+
+    PerfCounterValues values = counters->stop();
+    if (!values.valid)
+        return;
+
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    // Every last-level cache miss moves one 64-byte line from memory
+    double bytesPerPixel = pixels > 0 ? values.llcMisses * 64.0 / pixels : 0.0;
+    double bandwidth = seconds > 0 ? values.llcMisses * 64.0 / seconds / 1e9 : 0.0;
+
+    std::cout << "  IPC: " << values.ipc()
+        << ", L1D miss rate: " << values.l1dMissRate() * 100 << "%"
+        << ", LLC miss rate: " << values.llcMissRate() * 100 << "%"
+        << ", branch misses: " << values.branchMisses
+        << ", dTLB misses: " << values.dtlbMisses
+        << ", DRAM bytes/pixel: " << bytesPerPixel
+        << " (~" << bandwidth << " GB/s)" << std::endl;
+
+    counterSamples.push_back(values);
+    counterPixels.push_back(static_cast<double>(pixels));
+    counterSeconds.push_back(seconds);
+}
+
+void ConvolutionTester::reportCounterSummary() {
+    if (counterSamples.empty())
+        return;
+
+    PerfCounterValues total;
+    double pixels = std::accumulate(counterPixels.begin(), counterPixels.end(), 0.0);
+    double seconds = std::accumulate(counterSeconds.begin(), counterSeconds.end(), 0.0);
+    for (const PerfCounterValues& values : counterSamples) {
+        total.cycles += values.cycles;
+        total.instructions += values.instructions;
+        total.l1dAccesses += values.l1dAccesses;
+        total.l1dMisses += values.l1dMisses;
+        total.llcReferences += values.llcReferences;
+        total.llcMisses += values.llcMisses;
+        total.branchMisses += values.branchMisses;
+    }
+
+    double bytesPerPixel = pixels > 0 ? total.llcMisses * 64.0 / pixels : 0.0;
+    double bandwidth = seconds > 0 ? total.llcMisses * 64.0 / seconds / 1e9 : 0.0;
+
+    std::cout << "Aggregate IPC: " << total.ipc()
+        << ", L1D miss rate: " << total.l1dMissRate() * 100 << "%"
+        << ", LLC miss rate: " << total.llcMissRate() * 100 << "%"
+        << ", DRAM bytes/pixel: " << bytesPerPixel
+        << " (~" << bandwidth << " GB/s)" << std::endl;
+
+    // Rough classification: the 24-bit input and output alone need 6 bytes/pixel of DRAM traffic
+    if (bytesPerPixel > 12.0 && total.ipc() < 1.0)
+        std::cout << "Looks bandwidth-bound (low IPC, DRAM traffic well above the 6 bytes/pixel minimum)." << std::endl;
+    else
+        std::cout << "Looks compute-bound (DRAM traffic close to the 6 bytes/pixel minimum or high IPC)." << std::endl;
 }
@@ -7,10 +7,12 @@
 #include "image.h"
 #include "convolution.h"
 #include "kernel.h"
+#include "perfCounters.h"
 
 #include <opencv2/opencv.hpp>
 
 #include <numeric>
+#include <memory>
 
 class ConvolutionTester {
 public:
@@ -28,5 +30,41 @@ public:
 
     void runTests3(const std::vector<std::string>&, const std::vector<std::string>&, const std::vector<float>&);
 
+    // Compares a synchronous load/convolve/save loop with asynchronous batch I/O (io_uring or thread pool)
+    void runTestsAsync(const std::vector<std::string>&, const std::vector<std::string>&, const std::vector<float>&, int);
+
+    // Checks the multi-channel layer engine (GEMM and depthwise paths) against convolution() on a 3-channel image,
+    // then against convLayerDirect for combinations of stride, dilation, groups and padding
+    bool verifyConvLayer(const std::string&, const std::vector<float>&);
+
+    // Checks convolutionStrided and convolutionToFloat against convolution(), and the Gaussian pyramid against convolutionStrided
+    bool verifyStrided(const std::string&, const std::vector<float>&);
+
+    // Checks medianFilter against a sorting reference for small radii, then times it for radii up to 63
+    bool benchmarkMedian(const std::string&);
+
+    // Checks every morphology operation against a brute-force min/max reference, then times erosion for element sizes up to 101x101
+    bool benchmarkMorphology(const std::string&);
+
+    // Streams synthetic Y4M files (C444 and every C420 variant, even and odd sizes) through --stream with the identity kernel
+    // and checks the round trip, and that 4:2:0 chroma is replicated on read and box-averaged on write
+    bool verifyY4MRoundTrip();
+
+    // Enables reading hardware performance counters around each measured convolution
+    void setHardwareCounters(bool);
+
+private:
+    std::unique_ptr<PerfCounters> counters;
+    std::vector<PerfCounterValues> counterSamples;
+    std::vector<double> counterPixels;
+    std::vector<double> counterSeconds;
+
+    void startCounters();
+
+    void stopCounters(long long, std::chrono::steady_clock::duration);
+
+    void reportCounterSummary();
+
+    bool verifyConvLayerParams();
 };
 
@@ -0,0 +1,500 @@
+#include "frameStream.h"
+#include "kernel.h"
+#include "latencyHistogram.h"
+#include "temporalConvolution.h"
+#include "tracing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace {
+
+    typedef std::chrono::steady_clock Clock;
+
+    // Jedan slot za frejm: sve slike se alociraju jednom, na pocetku rada, i zatim se ponovo koriste
+    struct FrameSlot {
+        Image input, output;
+        PipelineScratch scratch;
+        std::vector<uint8_t> planes;  // planarni bafer za Y4M (Y, U, V)
+        Clock::time_point readStart;
+
+        FrameSlot(int w, int h, size_t planeBytes)
+            : input(w, h), output(w, h), scratch(w, h), planes(planeBytes) {}
+    };
+
+    // Dimenzije hroma ravni: kod 4:2:0 se neparna sirina ili visina zaokruzuje navise
+    int chromaWidth(const StreamOptions& options) {
+        return options.chroma == ChromaSampling::C420 ? (options.width + 1) / 2 : options.width;
+    }
+
+    int chromaHeight(const StreamOptions& options) {
+        return options.chroma == ChromaSampling::C420 ? (options.height + 1) / 2 : options.height;
+    }
+
+    // Velicina planarnog Y4M frejma u bajtovima (bez zaglavlja "FRAME")
+    size_t planeBytes(const StreamOptions& options) {
+        return static_cast<size_t>(options.width) * options.height
+            + 2 * static_cast<size_t>(chromaWidth(options)) * chromaHeight(options);
+    }
+
+    // Red fiksnog kapaciteta sa indeksima slotova; nakon konstrukcije nikad ne alocira memoriju
+    class SlotQueue {
+    public:
+        explicit SlotQueue(int capacity) : items(capacity + 1) {}
+
+        void push(int slot) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                items[tail] = slot;
+                tail = (tail + 1) % items.size();
+                ++count;
+            }
+            ready.notify_one();
+        }
+
+        int pop() {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [this] { return count > 0; });
+            int slot = items[head];
+            head = (head + 1) % items.size();
+            --count;
+            return slot;
+        }
+
+    private:
+        std::vector<int> items;
+        size_t head = 0, tail = 0, count = 0;
+        std::mutex mutex;
+        std::condition_variable ready;
+    };
+
+    // Cita red teksta (zaglavlje Y4M toka ili frejma) bez znaka za novi red
+    bool readLine(FILE* file, std::string& line) {
+        line.clear();
+        int c;
+        while ((c = fgetc(file)) != EOF && c != '\n')
+            line.push_back(static_cast<char>(c));
+        return c == '\n';
+    }
+
+    // Parsira zaglavlje Y4M toka, npr. "YUV4MPEG2 W1920 H1080 F60:1 Ip A1:1 C444 XCOLORRANGE=FULL"
+    bool parseY4MHeader(const std::string& header, int& width, int& height, ChromaSampling& sampling, bool& fullRange) {
+        if (header.compare(0, 10, "YUV4MPEG2 ") != 0) {
+            std::cerr << "Nevazece Y4M zaglavlje." << std::endl;
+            return false;
+        }
+
+        std::string chroma = "420jpeg";  // podrazumijevano uzorkovanje po specifikaciji
+        size_t pos = 10;
+        while (pos < header.size()) {
+            size_t end = header.find(' ', pos);
+            if (end == std::string::npos)
+                end = header.size();
+            std::string token = header.substr(pos, end - pos);
+            if (!token.empty()) {
+                if (token[0] == 'W')
+                    width = atoi(token.c_str() + 1);
+                else if (token[0] == 'H')
+                    height = atoi(token.c_str() + 1);
+                else if (token[0] == 'C')
+                    chroma = token.substr(1);
+                else if (token == "XCOLORRANGE=FULL")
+                    fullRange = true;
+            }
+            pos = end + 1;
+        }
+
+        // Varijante 4:2:0 se razlikuju samo po polozaju hroma uzorka, koji se pri ponavljanju i usrednjavanju zanemaruje
+        if (chroma == "444")
+            sampling = ChromaSampling::C444;
+        else if (chroma == "420jpeg" || chroma == "420" || chroma == "420paldv" || chroma == "420mpeg2")
+            sampling = ChromaSampling::C420;
+        else {
+            std::cerr << "Podrzano je C444 i C420 uzorkovanje, a tok ima C" << chroma
+                << " (konvertovati npr. sa -pix_fmt yuv444p ili yuv420p)." << std::endl;
+            return false;
+        }
+        return width > 0 && height > 0;
+    }
+
+    inline uint8_t clampByte(int value) {
+        return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+    }
+
+    /*
+        Pretvaranje YUV <-> BGR po BT.601, u fiksnom zarezu (16 bita razlomka). Kerneli su zadani za BGR slike,
+        a hroma ravni (U, V) su centrirane oko 128, pa bi ih npr. kernel za ivice (zbir 0) spustio na 0 umjesto na 128,
+        a ogranicavanje na [0, 255] bi odsjeklo negativne razlike boja. Zato se Y4M frejm prije pipeline-a pretvara
+        u BGR, a rezultat nazad u YUV (povratna konverzija moze promijeniti vrijednost za 1, a YUV vrijednosti
+        koje nisu boje u RGB opsegu se odsijecaju).
+        Ogranicen opseg (Y 16-235, U i V 16-240) je podrazumijevan u Y4M, a pun opseg se zadaje sa XCOLORRANGE=FULL.
+    */
+    struct YUVConversion {
+        int lumaOffset, luma;                      // (Y - lumaOffset) * luma je luminansa u opsegu 0-255
+        int uToBlue, uToGreen, vToGreen, vToRed;   // doprinosi (U - 128) i (V - 128) kanalima
+        int toY[3], toU[3], toV[3];                // tezine za B, G, R
+
+        explicit YUVConversion(bool fullRange) {
+            const double kr = 0.299, kb = 0.114, kg = 1.0 - kr - kb;
+            const double lumaRange = fullRange ? 1.0 : 219.0 / 255.0;
+            const double chromaRange = fullRange ? 1.0 : 224.0 / 255.0;
+            auto fixed = [](double value) { return static_cast<int>(std::lround(value * 65536.0)); };
+
+            lumaOffset = fullRange ? 0 : 16;
+            luma = fixed(1.0 / lumaRange);
+            uToBlue = fixed(2.0 * (1.0 - kb) / chromaRange);
+            uToGreen = fixed(2.0 * (1.0 - kb) * kb / kg / chromaRange);
+            vToGreen = fixed(2.0 * (1.0 - kr) * kr / kg / chromaRange);
+            vToRed = fixed(2.0 * (1.0 - kr) / chromaRange);
+
+            const double y[3] = { kb, kg, kr };
+            const double u[3] = { 0.5, -0.5 * kg / (1.0 - kb), -0.5 * kr / (1.0 - kb) };
+            const double v[3] = { -0.5 * kb / (1.0 - kr), -0.5 * kg / (1.0 - kr), 0.5 };
+            for (int c = 0; c < 3; ++c) {
+                toY[c] = fixed(y[c] * lumaRange);
+                toU[c] = fixed(u[c] * chromaRange);
+                toV[c] = fixed(v[c] * chromaRange);
+            }
+        }
+
+        Color toColor(int y, int u, int v) const {
+            const int half = 1 << 15;
+            int l = (y - lumaOffset) * luma + half;
+            u -= 128;
+            v -= 128;
+            return Color(clampByte((l + uToBlue * u) >> 16), clampByte((l - uToGreen * u - vToGreen * v) >> 16), clampByte((l + vToRed * v) >> 16));
+        }
+
+        void fromColor(const Color& pixel, uint8_t& y, uint8_t& u, uint8_t& v) const {
+            const int half = 1 << 15;
+            y = clampByte(lumaOffset + ((toY[0] * pixel.blue + toY[1] * pixel.green + toY[2] * pixel.red + half) >> 16));
+            u = clampByte(128 + ((toU[0] * pixel.blue + toU[1] * pixel.green + toU[2] * pixel.red + half) >> 16));
+            v = clampByte(128 + ((toV[0] * pixel.blue + toV[1] * pixel.green + toV[2] * pixel.red + half) >> 16));
+        }
+    };
+
+    /*
+        Citanje i upisivanje frejmova se radi u nitima za citanje i upisivanje, koje rade istovremeno
+        sa konvolucijom u glavnoj niti, pa pretvaranje formata nema svoj OpenMP region
+        (inace bi se OpenMP niti tih regiona takmicile sa nitima konvolucije za jezgra).
+    */
+    bool readFrame(FILE* file, const StreamOptions& options, const YUVConversion& yuv, FrameSlot& slot, std::string& line) {
+        const size_t pixelCount = static_cast<size_t>(options.width) * options.height;
+        TRACE_SCOPE("readFrame");
+        TRACE_PIXELS(pixelCount);
+
+        if (options.format == FrameFormat::BGR24) {
+            // Raspored bajtova u BGR24 frejmu je isti kao u vektoru Color, pa se cita direktno u sliku
+            TRACE_BYTES_READ(pixelCount * sizeof(Color));
+            return fread(slot.input.pixels.data(), sizeof(Color), pixelCount, file) == pixelCount;
+        }
+
+        const size_t frameBytes = slot.planes.size();
+        TRACE_BYTES_READ(frameBytes);
+        if (!readLine(file, line) || line.compare(0, 5, "FRAME") != 0)
+            return false;
+        if (fread(slot.planes.data(), 1, frameBytes, file) != frameBytes)
+            return false;
+
+        const uint8_t* planeY = slot.planes.data();
+        Color* pixels = slot.input.pixels.data();
+        if (options.chroma == ChromaSampling::C444) {
+            const uint8_t* planeU = planeY + pixelCount;
+            const uint8_t* planeV = planeU + pixelCount;
+            for (size_t i = 0; i < pixelCount; ++i)
+                pixels[i] = yuv.toColor(planeY[i], planeU[i], planeV[i]);
+            return true;
+        }
+
+        // 4:2:0: hroma uzorak se ponavlja na blok 2x2 piksela
+        const int chromaStride = chromaWidth(options);
+        const uint8_t* planeU = planeY + pixelCount;
+        const uint8_t* planeV = planeU + static_cast<size_t>(chromaStride) * chromaHeight(options);
+        for (int y = 0; y < options.height; ++y) {
+            const size_t row = static_cast<size_t>(y) * options.width;
+            const size_t chromaRow = static_cast<size_t>(y / 2) * chromaStride;
+            for (int x = 0; x < options.width; ++x)
+                pixels[row + x] = yuv.toColor(planeY[row + x], planeU[chromaRow + x / 2], planeV[chromaRow + x / 2]);
+        }
+        return true;
+    }
+
+    bool writeFrame(FILE* file, const StreamOptions& options, const YUVConversion& yuv, FrameSlot& slot) {
+        const size_t pixelCount = static_cast<size_t>(options.width) * options.height;
+        TRACE_SCOPE("writeFrame");
+        TRACE_PIXELS(pixelCount);
+
+        if (options.format == FrameFormat::BGR24) {
+            TRACE_BYTES_WRITTEN(pixelCount * sizeof(Color));
+            return fwrite(slot.output.pixels.data(), sizeof(Color), pixelCount, file) == pixelCount;
+        }
+
+        const size_t frameBytes = slot.planes.size();
+        TRACE_BYTES_WRITTEN(frameBytes);
+        uint8_t* planeY = slot.planes.data();
+        const Color* pixels = slot.output.pixels.data();
+        if (options.chroma == ChromaSampling::C444) {
+            uint8_t* planeU = planeY + pixelCount;
+            uint8_t* planeV = planeU + pixelCount;
+            for (size_t i = 0; i < pixelCount; ++i)
+                yuv.fromColor(pixels[i], planeY[i], planeU[i], planeV[i]);
+        }
+        else {
+            /*
+                4:2:0: hroma uzorak je zaokruzeni prosjek hrome piksela bloka 2x2 (na desnom i donjem rubu slike
+                sa neparnom dimenzijom blok ima 1 ili 2 piksela). Ponavljanje pri citanju i usrednjavanje pri upisu
+                su tacno inverzni, pa tok bez filtriranja zadrzava hromu (do razlike od 1 zbog pretvaranja u BGR).
+            */
+            const int chromaStride = chromaWidth(options);
+            uint8_t* planeU = planeY + pixelCount;
+            uint8_t* planeV = planeU + static_cast<size_t>(chromaStride) * chromaHeight(options);
+            for (int cy = 0; cy < chromaHeight(options); ++cy) {
+                const int lastY = std::min(2 * cy + 1, options.height - 1);
+                for (int cx = 0; cx < chromaStride; ++cx) {
+                    const int lastX = std::min(2 * cx + 1, options.width - 1);
+                    int sumU = 0, sumV = 0, count = 0;
+                    for (int y = 2 * cy; y <= lastY; ++y) {
+                        for (int x = 2 * cx; x <= lastX; ++x) {
+                            const size_t i = static_cast<size_t>(y) * options.width + x;
+                            uint8_t u, v;
+                            yuv.fromColor(pixels[i], planeY[i], u, v);
+                            sumU += u;
+                            sumV += v;
+                            ++count;
+                        }
+                    }
+                    const size_t chroma = static_cast<size_t>(cy) * chromaStride + cx;
+                    planeU[chroma] = static_cast<uint8_t>((sumU + count / 2) / count);
+                    planeV[chroma] = static_cast<uint8_t>((sumV + count / 2) / count);
+                }
+            }
+        }
+
+        return fputs("FRAME\n", file) >= 0
+            && fwrite(slot.planes.data(), 1, frameBytes, file) == frameBytes;
+    }
+}
+
+/*
+    Parsiranje argumenata za rezim obrade video toka:
+        --stream <bgr24:SIRINAxVISINA | y4m> <kernel[+kernel...]> [ulaz] [izlaz] [--buffers N] [--temporal T | t0,t1,...]
+                 [--collapse none | clampfree | always]
+    Kernel moze biti ime ugradjenog kernela (identity, gaussian, edge, box, sharpen)
+    ili lista vrijednosti razdvojenih zarezom; vise kernela spojenih znakom '+' cini pipeline.
+    Ulaz i izlaz mogu biti imenovane cijevi (named pipe); ako nisu zadani koriste se stdin i stdout.
+    Opcija --temporal ukljucuje vremensku konvoluciju: broj T znaci prosjek posljednjih T frejmova,
+    a lista vrijednosti zadaje tezine od najnovijeg frejma ka starijim.
+    Opcija --collapse odredjuje kada se uzastopni kerneli pipeline-a spajaju u jedan (vidi planPipeline()).
+*/
+bool parseStreamOptions(int argc, char* argv[], StreamOptions& options) {
+    std::vector<std::string> positional;
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--buffers" && i + 1 < argc)
+            options.bufferCount = std::max(2, std::min(8, atoi(argv[++i])));
+        else if (arg == "--temporal" && i + 1 < argc) {
+            std::string value = argv[++i];
+            if (value.find(',') != std::string::npos) {
+                options.temporalKernel = Kernel::kernelByName(value);
+            }
+            else {
+                int frameCount = std::max(1, atoi(value.c_str()));
+                options.temporalKernel.assign(frameCount, 1.0f / frameCount);
+            }
+        }
+        else if (arg == "--collapse" && i + 1 < argc) {
+            std::string value = argv[++i];
+            if (value == "none")
+                options.collapse = CollapsePolicy::None;
+            else if (value == "always")
+                options.collapse = CollapsePolicy::Always;
+            else if (value == "clampfree")
+                options.collapse = CollapsePolicy::ClampFree;
+            else {
+                std::cerr << "Nepoznat nacin spajanja kernela: " << value << std::endl;
+                return false;
+            }
+        }
+        else
+            positional.push_back(arg);
+    }
+
+    if (positional.size() < 2) {
+        std::cerr << "Upotreba: --stream <bgr24:SIRINAxVISINA | y4m> <kernel[+kernel...]> [ulaz] [izlaz] [--buffers N] [--temporal T] [--collapse none|clampfree|always]" << std::endl;
+        return false;
+    }
+
+    const std::string& format = positional[0];
+    if (format == "y4m") {
+        options.format = FrameFormat::Y4M;
+    }
+    else if (format.compare(0, 6, "bgr24:") == 0
+        && sscanf(format.c_str() + 6, "%dx%d", &options.width, &options.height) == 2
+        && options.width > 0 && options.height > 0) {
+        options.format = FrameFormat::BGR24;
+    }
+    else {
+        std::cerr << "Nepoznat format toka: " << format << std::endl;
+        return false;
+    }
+
+    options.pipeline = Kernel::parsePipeline(positional[1]);
+    if (!options.temporalKernel.empty() && options.pipeline.size() != 1) {
+        std::cerr << "Vremenska konvolucija zahtijeva tacno jedan prostorni kernel." << std::endl;
+        return false;
+    }
+    if (positional.size() > 2 && positional[2] != "-")
+        options.inputPath = positional[2];
+    if (positional.size() > 3 && positional[3] != "-")
+        options.outputPath = positional[3];
+
+    return true;
+}
+
+/*
+    Ova funkcija obradjuje tok frejmova: cita frejm, primjenjuje kernel (ili pipeline kernela) i upisuje rezultat.
+    Citanje, racunanje i upisivanje se odvijaju u tri niti koje se preklapaju:
+    dok se frejm N racuna, frejm N+1 se vec cita, a frejm N-1 se jos upisuje.
+    Niti razmjenjuju samo indekse slotova kroz redove fiksnog kapaciteta, a svi baferi za frejmove
+    se alociraju jednom na pocetku (options.bufferCount slotova), tako da se tokom rada ne alocira nista po frejmu.
+    Kada nema slobodnog slota, citac ceka, pa je broj frejmova u obradi ogranicen.
+    Ako je zadan vremenski kernel, umjesto pipeline-a se koristi TemporalConvolver,
+    koji frejmove prima redom u niti za racunanje.
+    Za svaki frejm se mjeri kasnjenje od pocetka citanja do zavrsetka upisa (u histogram fiksne velicine);
+    na kraju se na stderr ispisuju percentili kasnjenja i ostvareni broj frejmova u sekundi.
+*/
+int runFrameStream(const StreamOptions& streamOptions) {
+    StreamOptions options = streamOptions;
+
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+    FILE* in = options.inputPath.empty() ? stdin : fopen(options.inputPath.c_str(), "rb");
+    FILE* out = nullptr;
+    auto closeStreams = [&] {
+        if (in && in != stdin)
+            fclose(in);
+        if (out && out != stdout)
+            fclose(out);
+    };
+
+    if (!in) {
+        std::cerr << "Nije moguce otvoriti ulazni tok: " << options.inputPath << std::endl;
+        return EXIT_FAILURE;
+    }
+    out = options.outputPath.empty() ? stdout : fopen(options.outputPath.c_str(), "wb");
+    if (!out) {
+        std::cerr << "Nije moguce otvoriti izlazni tok: " << options.outputPath << std::endl;
+        closeStreams();
+        return EXIT_FAILURE;
+    }
+
+    std::string header;
+    bool fullRange = false;
+    if (options.format == FrameFormat::Y4M) {
+        if (!readLine(in, header) || !parseY4MHeader(header, options.width, options.height, options.chroma, fullRange)) {
+            closeStreams();
+            return EXIT_FAILURE;
+        }
+        fputs((header + "\n").c_str(), out);
+    }
+    const YUVConversion yuv(fullRange);
+
+    std::vector<FrameSlot> slots;
+    slots.reserve(options.bufferCount);
+    for (int i = 0; i < options.bufferCount; ++i)
+        slots.emplace_back(options.width, options.height, options.format == FrameFormat::Y4M ? planeBytes(options) : 0);
+
+    SlotQueue freeSlots(options.bufferCount), readySlots(options.bufferCount), doneSlots(options.bufferCount);
+    for (int i = 0; i < options.bufferCount; ++i)
+        freeSlots.push(i);
+
+    std::unique_ptr<TemporalConvolver> temporal;
+    if (!options.temporalKernel.empty())
+        temporal.reset(new TemporalConvolver(options.width, options.height, options.pipeline[0], options.temporalKernel));
+
+    // Plan pipeline-a se pravi jednom, a ne za svaki frejm
+    const PipelinePlan plan = planPipeline(options.pipeline, options.collapse);
+    if (temporal == nullptr && plan.size() != options.pipeline.size())
+        printPipelinePlan(std::cerr, plan);
+
+    std::atomic<bool> failed(false);
+    LatencyHistogram latencies;
+
+    Clock::time_point streamStart = Clock::now();
+    Clock::time_point streamEnd = streamStart;
+
+    // Nit za citanje: popunjava slobodne slotove; -1 oznacava kraj toka
+    std::thread reader([&] {
+        std::string line;
+        while (!failed) {
+            int slot = freeSlots.pop();
+            slots[slot].readStart = Clock::now();
+            if (!readFrame(in, options, yuv, slots[slot], line))
+                break;
+            readySlots.push(slot);
+        }
+        readySlots.push(-1);
+    });
+
+    // Nit za upisivanje: upisuje gotove frejmove i vraca slotove u red slobodnih
+    std::thread writer([&] {
+        for (;;) {
+            int slot = doneSlots.pop();
+            if (slot < 0)
+                break;
+            if (!failed && !writeFrame(out, options, yuv, slots[slot])) {
+                std::cerr << "Greska prilikom upisivanja izlaznog toka." << std::endl;
+                failed = true;
+            }
+            streamEnd = Clock::now();
+            latencies.record(std::chrono::duration<double, std::milli>(streamEnd - slots[slot].readStart).count());
+            freeSlots.push(slot);
+        }
+        fflush(out);
+    });
+
+    // Racunanje se odvija u glavnoj niti (konvolucija je interno paralelizovana)
+    for (;;) {
+        int slot = readySlots.pop();
+        if (slot < 0)
+            break;
+        if (temporal)
+            temporal->pushFrame(slots[slot].input, slots[slot].output);
+        else
+            runPipeline(slots[slot].input, plan, slots[slot].output, slots[slot].scratch);
+        doneSlots.push(slot);
+    }
+    doneSlots.push(-1);
+
+    reader.join();
+    writer.join();
+
+    closeStreams();
+
+    double seconds = std::chrono::duration<double>(streamEnd - streamStart).count();
+
+    std::cerr << "Obradjeno frejmova: " << latencies.count()
+        << ", fps: " << (seconds > 0 ? latencies.count() / seconds : 0.0) << std::endl
+        << "Kasnjenje po frejmu (ms) p50: " << latencies.percentile(0.50)
+        << ", p90: " << latencies.percentile(0.90)
+        << ", p99: " << latencies.percentile(0.99)
+        << ", max: " << latencies.max() << std::endl;
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include "image.h"
+#include "pipeline.h"
+
+// Format sirovih frejmova koji se citaju sa ulaza
+enum class FrameFormat {
+    BGR24,  // frejmovi bez zaglavlja, sirina * visina * 3 bajta, redovi odozgo nadole (kao Color)
+    Y4M     // YUV4MPEG2 tok sa C444 ili C420 uzorkovanjem; frejmovi se filtriraju u BGR (BT.601) i vracaju u YUV
+};
+
+// Uzorkovanje hroma ravni (U, V) Y4M toka
+enum class ChromaSampling {
+    C444,   // hroma u punoj rezoluciji
+    C420    // hroma u pola sirine i pola visine (420jpeg, 420, 420paldv, 420mpeg2)
+};
+
+struct StreamOptions {
+    FrameFormat format = FrameFormat::BGR24;
+    int width = 0, height = 0;
+    ChromaSampling chroma = ChromaSampling::C444;  // za Y4M se cita iz zaglavlja toka
+    Pipeline pipeline;
+    CollapsePolicy collapse = CollapsePolicy::None;  // spajanje uzastopnih linearnih faza u jedan kernel
+    std::vector<float> temporalKernel;  // ako nije prazan, radi se prostorno-vremenska konvolucija
+    std::string inputPath;   // prazno znaci stdin
+    std::string outputPath;  // prazno znaci stdout
+    int bufferCount = 3;     // 2 = dvostruko, 3 = trostruko baferovanje
+};
+
+bool parseStreamOptions(int, char* [], StreamOptions&);
+
+int runFrameStream(const StreamOptions&);
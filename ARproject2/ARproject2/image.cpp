@@ -1,4 +1,11 @@
 ﻿#include "image.h"
+#include "qoi.h"
+#include "tracing.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <type_traits>
 
 /*
 * Ovo je funkcija za učitavanje BMP slike iz datoteke.
@@ -54,6 +61,7 @@
 
 // Funkcija za učitavanje BMP slike
 std::vector<Color> loadBMP1(const std::string& filename, int& width, int& height) {
+    TRACE_SCOPE("loadBMP1");
     std::ifstream file(filename, std::ios::binary);
     if (!file) {
         std::cerr << "Nije moguće otvoriti fajl: " << filename << std::endl;
@@ -91,11 +99,15 @@ std::vector<Color> loadBMP1(const std::string& filename, int& width, int& height
         file.seekg(padding, std::ios::cur);
     }
 
+    TRACE_PIXELS(pixels.size());
+    TRACE_BYTES_READ(sizeof(BMPHeader) + static_cast<long long>(height) * (width * sizeof(Color) + (4 - (width * sizeof(Color)) % 4) % 4));
+
     return pixels;
 }
 
 // Funkcija za učitavanje BMP slike
 std::vector<Color> loadBMP2(const std::string& filename, int& width, int& height) {
+    TRACE_SCOPE("loadBMP2");
     std::ifstream file(filename, std::ios::binary);
     if (!file) {
         std::cerr << "Nije moguće otvoriti fajl: " << filename << std::endl;
@@ -133,6 +145,9 @@ std::vector<Color> loadBMP2(const std::string& filename, int& width, int& height
         file.seekg(padding, std::ios::cur);
     }
 
+    TRACE_PIXELS(pixels.size());
+    TRACE_BYTES_READ(sizeof(BMPHeader) + static_cast<long long>(height) * (width * sizeof(Color) + (4 - (width * sizeof(Color)) % 4) % 4));
+
     return pixels;
 }
 
@@ -184,6 +199,7 @@ std::vector<Color> loadBMP2(const std::string& filename, int& width, int& height
 // Funkcija za čuvanje BMP slike
 
 void saveBMP(const std::string& filename, const Image& image) {
+    TRACE_SCOPE("saveBMP");
     std::ofstream file(filename, std::ios::binary);
     if (!file) {
         std::cerr << "Nije moguće otvoriti fajl za čuvanje: " << filename << std::endl;
@@ -193,7 +209,7 @@ void saveBMP(const std::string& filename, const Image& image) {
     // Header za BMP fajl
     BMPHeader header;
     header.signature = 0x4D42;  // "BM" u little-endian formatu
-    header.fileSize = sizeof(BMPHeader) + image.width * image.height * sizeof(Color) + image.height * (4 - (image.width * sizeof(Color)) % 4) % 4;
+    header.fileSize = sizeof(BMPHeader) + image.width * image.height * sizeof(Color) + image.height * ((4 - (image.width * sizeof(Color)) % 4) % 4);
     header.reserved = 0;
     header.dataOffset = sizeof(BMPHeader);
     header.headerSize = 40;
@@ -209,6 +225,8 @@ void saveBMP(const std::string& filename, const Image& image) {
     header.colorsImportant = 0;
 
     file.write(reinterpret_cast<char*>(&header), sizeof(BMPHeader));
+    TRACE_PIXELS(image.pixels.size());
+    TRACE_BYTES_WRITTEN(header.fileSize);
 
     // Upisivanje piksela slike
     for (int y = image.height - 1; y >= 0; --y) {
@@ -222,4 +240,568 @@ void saveBMP(const std::string& filename, const Image& image) {
             file.put(0);
         }
     }
-}
\ No newline at end of file
+}
+
+namespace {
+
+    const uint32_t compressionRGB = 0;        // BI_RGB
+    const uint32_t compressionBitfields = 3;  // BI_BITFIELDS
+    const uint32_t compressionAlphaBitfields = 6;
+
+    // Opis pikselskog formata BMP fajla, procitan iz zaglavlja
+    struct BMPFormat {
+        BMPHeader header;
+        int width, height;
+        bool topDown;
+        size_t rowBytes;
+        uint32_t masks[4];           // crvena, zelena, plava, alfa (za 32-bitne slike)
+        std::vector<ColorA> palette; // za 8-bitne slike; prazna paleta znaci sive nijanse 0..255
+    };
+
+    struct MaskChannel {
+        uint32_t mask;
+        int shift;
+        uint32_t maxValue;
+    };
+
+    MaskChannel makeMaskChannel(uint32_t mask) {
+        MaskChannel channel = { mask, 0, 0 };
+        if (mask == 0)
+            return channel;
+        while (((mask >> channel.shift) & 1) == 0)
+            ++channel.shift;
+        channel.maxValue = mask >> channel.shift;
+        return channel;
+    }
+
+    // Izdvajanje kanala po maski i svodjenje na 8 bita (maske ne moraju biti sirine 8 bita, npr. 10-10-10-2)
+    inline uint8_t extractChannel(uint32_t value, const MaskChannel& channel, uint8_t missing) {
+        if (channel.mask == 0)
+            return missing;
+        uint32_t v = (value & channel.mask) >> channel.shift;
+        return channel.maxValue == 255 ? static_cast<uint8_t>(v) : static_cast<uint8_t>((v * 255 + channel.maxValue / 2) / channel.maxValue);
+    }
+
+    // Konverzije u trazeni tip piksela kada se format fajla razlikuje od tipa slike
+    inline void convertPixel(const ColorA& from, Gray& to) {
+        to.value = static_cast<uint8_t>((29 * from.blue + 150 * from.green + 77 * from.red + 128) >> 8);
+    }
+
+    inline void convertPixel(const ColorA& from, Color& to) {
+        to = Color(from.blue, from.green, from.red);
+    }
+
+    inline void convertPixel(const ColorA& from, ColorA& to) {
+        to = from;
+    }
+
+    // Citanje zaglavlja, maski i palete; za neispravan fajl vraca false i opis greske u `error`
+    bool parseBMPFormat(std::istream& file, const std::string& filename, BMPFormat& format, std::string& error) {
+        file.read(reinterpret_cast<char*>(&format.header), sizeof(BMPHeader));
+        const BMPHeader& header = format.header;
+
+        if (!file || header.signature != 0x4D42) {  // "BM" u little-endian formatu
+            error = "Nevažeći BMP format: " + filename;
+            return false;
+        }
+
+        if (header.bitsPerPixel != 8 && header.bitsPerPixel != 24 && header.bitsPerPixel != 32) {
+            error = "Očekuje se 8, 24 ili 32-bitni BMP format, ali datoteka ima " + std::to_string(header.bitsPerPixel) + " bita po pikselu.";
+            return false;
+        }
+
+        bool bitfields = header.compression == compressionBitfields || header.compression == compressionAlphaBitfields;
+        if (header.compression != compressionRGB && !(bitfields && header.bitsPerPixel == 32)) {
+            error = "Nepodržana kompresija BMP fajla (" + std::to_string(header.compression) + "): " + filename;
+            return false;
+        }
+
+        format.width = header.width;
+        format.height = header.height < 0 ? -header.height : header.height;
+        format.topDown = header.height < 0;
+        format.rowBytes = ((static_cast<size_t>(format.width) * header.bitsPerPixel + 31) / 32) * 4;
+
+        // Podrazumijevane maske za 32-bitni BI_RGB format: B, G, R, A redom u bajtovima
+        format.masks[0] = 0x00FF0000;
+        format.masks[1] = 0x0000FF00;
+        format.masks[2] = 0x000000FF;
+        format.masks[3] = 0xFF000000;
+
+        if (bitfields) {
+            // Maske se nalaze odmah iza 40-bajtnog zaglavlja (ili unutar V3/V4/V5 zaglavlja, na istom mjestu)
+            uint32_t masks[4] = { 0, 0, 0, 0 };
+            bool hasAlphaMask = header.headerSize >= 56 || header.compression == compressionAlphaBitfields;
+            file.seekg(sizeof(BMPHeader));
+            file.read(reinterpret_cast<char*>(masks), (hasAlphaMask ? 4 : 3) * sizeof(uint32_t));
+            std::copy(masks, masks + 4, format.masks);
+        }
+
+        if (header.bitsPerPixel == 8) {
+            // Paleta slijedi zaglavlje; ako je nema (dataOffset odmah iza zaglavlja), vrijednost je siva nijansa
+            size_t paletteOffset = 14 + static_cast<size_t>(header.headerSize);
+            size_t available = header.dataOffset > paletteOffset ? (header.dataOffset - paletteOffset) / 4 : 0;
+            size_t count = std::min<size_t>(available, header.colorsUsed ? header.colorsUsed : 256);
+            if (count > 0) {
+                format.palette.resize(256);
+                std::vector<uint8_t> entries(count * 4);
+                file.seekg(paletteOffset);
+                file.read(reinterpret_cast<char*>(entries.data()), entries.size());
+                for (size_t i = 0; i < count; ++i)
+                    format.palette[i] = ColorA(entries[4 * i], entries[4 * i + 1], entries[4 * i + 2], 255);
+            }
+        }
+
+        return true;
+    }
+
+    BMPFormat readBMPFormat(std::istream& file, const std::string& filename) {
+        BMPFormat format;
+        std::string error;
+        if (!parseBMPFormat(file, filename, format, error)) {
+            std::cerr << error << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        return format;
+    }
+
+    bool isGrayIdentityPalette(const std::vector<ColorA>& palette) {
+        for (size_t i = 0; i < palette.size(); ++i) {
+            if (palette[i].blue != i || palette[i].green != i || palette[i].red != i)
+                return false;
+        }
+        return true;
+    }
+
+    // Dekodiranje jednog reda BMP fajla u piksele tipa PixelT; kada se formati poklapaju red se samo kopira
+    template <typename PixelT>
+    void decodeRow(const BMPFormat& format, bool grayIdentity, const MaskChannel* channels, const uint8_t* row, PixelT* out) {
+        const int width = format.width;
+
+        switch (format.header.bitsPerPixel) {
+        case 8:
+            if (std::is_same<PixelT, Gray>::value && grayIdentity) {
+                memcpy(out, row, width);
+                return;
+            }
+            for (int x = 0; x < width; ++x) {
+                ColorA pixel = format.palette.empty() ? ColorA(row[x], row[x], row[x], 255) : format.palette[row[x]];
+                convertPixel(pixel, out[x]);
+            }
+            return;
+
+        case 24:
+            if (std::is_same<PixelT, Color>::value) {
+                memcpy(out, row, static_cast<size_t>(width) * 3);
+                return;
+            }
+            for (int x = 0; x < width; ++x)
+                convertPixel(ColorA(row[3 * x], row[3 * x + 1], row[3 * x + 2], 255), out[x]);
+            return;
+
+        default:
+            for (int x = 0; x < width; ++x) {
+                uint32_t value;
+                memcpy(&value, row + 4 * x, 4);
+                ColorA pixel(extractChannel(value, channels[2], 0), extractChannel(value, channels[1], 0),
+                    extractChannel(value, channels[0], 0), extractChannel(value, channels[3], 255));
+                convertPixel(pixel, out[x]);
+            }
+            return;
+        }
+    }
+
+    // Upis redova odozdo nagore; `stride` je razmak izmedju redova u memoriji (moze biti veci od reda, kod pogleda)
+    void writeBMPRows(std::ostream& file, const uint8_t* pixels, int width, int height, size_t pixelBytes, size_t stride) {
+        size_t dataBytes = static_cast<size_t>(width) * pixelBytes;
+        size_t rowBytes = (dataBytes + 3) & ~static_cast<size_t>(3);
+        std::vector<char> row(rowBytes, 0);
+        for (int y = height - 1; y >= 0; --y) {
+            memcpy(row.data(), pixels + static_cast<size_t>(y) * stride, dataBytes);
+            file.write(row.data(), rowBytes);
+        }
+    }
+
+    // Ulazni tok nad fajlom koji je vec u memoriji (bez kopiranja), da bi se koristio isti dekoder kao za fajlove na disku
+    class MemoryStreamBuffer : public std::streambuf {
+    public:
+        MemoryStreamBuffer(const uint8_t* data, size_t size) {
+            char* begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+            setg(begin, begin, begin + size);
+        }
+
+    protected:
+        pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode) override {
+            char* base = direction == std::ios_base::beg ? eback() : direction == std::ios_base::cur ? gptr() : egptr();
+            if (base + offset < eback() || base + offset > egptr())
+                return pos_type(off_type(-1));
+            setg(eback(), base + offset, egptr());
+            return pos_type(gptr() - eback());
+        }
+
+        pos_type seekpos(pos_type position, std::ios_base::openmode mode) override {
+            return seekoff(off_type(position), std::ios_base::beg, mode);
+        }
+    };
+
+    // Dekodiranje svih redova otvorenog BMP fajla u pogled istih dimenzija
+    template <typename PixelT>
+    void decodeBMPPixels(std::istream& file, const BMPFormat& format, const BasicImageView<PixelT>& view) {
+        MaskChannel channels[4];
+        for (int i = 0; i < 4; ++i)
+            channels[i] = makeMaskChannel(format.masks[i]);
+        bool grayIdentity = format.palette.empty() || isGrayIdentityPalette(format.palette);
+
+        std::vector<uint8_t> row(format.rowBytes);
+        file.seekg(format.header.dataOffset);
+        for (int i = 0; i < format.height; ++i) {
+            int y = format.topDown ? i : format.height - 1 - i;
+            file.read(reinterpret_cast<char*>(row.data()), row.size());
+            decodeRow(format, grayIdentity, channels, row.data(), view.row(y));
+        }
+    }
+}
+
+// Funkcija koja vraca broj kanala BMP fajla: 1 za 8-bitne, 3 za 24-bitne i 4 za 32-bitne slike
+int probeBMPChannels(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) {
+        std::cerr << "Nije moguće otvoriti fajl: " << filename << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    BMPFormat format = readBMPFormat(file, filename);
+    return format.header.bitsPerPixel / 8;
+}
+
+/*
+    Ova funkcija ucitava BMP sliku u sliku sa pikselima tipa PixelT (Gray, Color ili ColorA).
+    Podrzani su 8-bitni fajlovi (sa paletom ili bez nje), 24-bitni fajlovi i 32-bitni fajlovi
+    (BI_RGB ili BI_BITFIELDS sa proizvoljnim maskama), kao i slike sa redovima odozgo nadole (negativna visina).
+    Kada se broj kanala fajla poklapa sa tipom piksela (npr. 8-bitna siva slika u GrayImage),
+    redovi se kopiraju direktno, bez ikakve konverzije; u suprotnom se pikseli konvertuju
+    (siva u boju ponavljanjem vrijednosti, boja u sivu po luminansi, alfa se dodaje kao 255 ili se izostavlja).
+*/
+template <typename PixelT>
+BasicImage<PixelT> loadBMP(const std::string& filename) {
+    TRACE_SCOPE("loadBMP");
+
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) {
+        std::cerr << "Nije moguće otvoriti fajl: " << filename << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    BMPFormat format = readBMPFormat(file, filename);
+    BasicImage<PixelT> image(format.width, format.height);
+    decodeBMPPixels(file, format, BasicImageView<PixelT>(image));
+
+    TRACE_PIXELS(image.pixels.size());
+    TRACE_BYTES_READ(format.header.dataOffset + format.rowBytes * format.height);
+
+    return image;
+}
+
+template GrayImage loadBMP<Gray>(const std::string&);
+template Image loadBMP<Color>(const std::string&);
+template ImageBGRA loadBMP<ColorA>(const std::string&);
+
+// Ucitavanje u postojeci pogled, npr. u isjecak vece slike ili u tudji bafer, bez privremene slike
+template <typename PixelT>
+void loadBMP(const std::string& filename, const BasicImageView<PixelT>& view) {
+    TRACE_SCOPE("loadBMP");
+
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) {
+        std::cerr << "Nije moguće otvoriti fajl: " << filename << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    BMPFormat format = readBMPFormat(file, filename);
+    if (format.width != view.width || format.height != view.height) {
+        std::cerr << "Dimenzije slike " << filename << " (" << format.width << "x" << format.height
+            << ") se ne poklapaju sa pogledom (" << view.width << "x" << view.height << ")." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    decodeBMPPixels(file, format, view);
+
+    TRACE_PIXELS(static_cast<long long>(view.width) * view.height);
+    TRACE_BYTES_READ(format.header.dataOffset + format.rowBytes * format.height);
+}
+
+template void loadBMP<Gray>(const std::string&, const GrayImageView&);
+template void loadBMP<Color>(const std::string&, const ImageView&);
+template void loadBMP<ColorA>(const std::string&, const ImageBGRAView&);
+
+// Dekodiranje BMP fajla koji je vec procitan u memoriju; `filename` sluzi samo za poruke o greskama
+template <typename PixelT>
+BasicImage<PixelT> decodeBMP(const uint8_t* data, size_t size, const std::string& filename) {
+    TRACE_SCOPE("decodeBMP");
+
+    MemoryStreamBuffer buffer(data, size);
+    std::istream stream(&buffer);
+    BMPFormat format = readBMPFormat(stream, filename);
+    BasicImage<PixelT> image(format.width, format.height);
+    decodeBMPPixels(stream, format, BasicImageView<PixelT>(image));
+
+    TRACE_PIXELS(image.pixels.size());
+    return image;
+}
+
+template GrayImage decodeBMP<Gray>(const uint8_t*, size_t, const std::string&);
+template Image decodeBMP<Color>(const uint8_t*, size_t, const std::string&);
+template ImageBGRA decodeBMP<ColorA>(const uint8_t*, size_t, const std::string&);
+
+// Dekodiranje koje ne prekida program: provjerava i dimenzije i da li bafer sadrzi sve redove slike
+template <typename PixelT>
+bool tryDecodeBMP(const uint8_t* data, size_t size, const std::string& filename, BasicImage<PixelT>& image, std::string& error) {
+    TRACE_SCOPE("decodeBMP");
+
+    MemoryStreamBuffer buffer(data, size);
+    std::istream stream(&buffer);
+    BMPFormat format;
+    if (!parseBMPFormat(stream, filename, format, error))
+        return false;
+    if (format.width <= 0 || format.height <= 0
+        || format.header.dataOffset + format.rowBytes * format.height > size) {
+        error = "Nevažeće dimenzije ili skraćen BMP fajl: " + filename;
+        return false;
+    }
+
+    image = BasicImage<PixelT>(format.width, format.height);
+    decodeBMPPixels(stream, format, BasicImageView<PixelT>(image));
+
+    TRACE_PIXELS(image.pixels.size());
+    return true;
+}
+
+template bool tryDecodeBMP<Gray>(const uint8_t*, size_t, const std::string&, GrayImage&, std::string&);
+template bool tryDecodeBMP<Color>(const uint8_t*, size_t, const std::string&, Image&, std::string&);
+template bool tryDecodeBMP<ColorA>(const uint8_t*, size_t, const std::string&, ImageBGRA&, std::string&);
+
+// Funkcija za čuvanje 8-bitne sive BMP slike (sa paletom sivih nijansi, radi kompatibilnosti sa drugim programima)
+void saveBMP(const std::string& filename, const GrayImage& image) {
+    saveBMP(filename, ConstGrayImageView(image));
+}
+
+void saveBMP(const std::string& filename, const ConstGrayImageView& image) {
+    TRACE_SCOPE("saveBMP");
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file) {
+        std::cerr << "Nije moguće otvoriti fajl za čuvanje: " << filename << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    const uint32_t paletteBytes = 256 * 4;
+    const uint32_t rowBytes = (image.width + 3) & ~3u;
+
+    BMPHeader header = {};
+    header.signature = 0x4D42;
+    header.dataOffset = sizeof(BMPHeader) + paletteBytes;
+    header.fileSize = header.dataOffset + rowBytes * image.height;
+    header.headerSize = 40;
+    header.width = image.width;
+    header.height = image.height;
+    header.planes = 1;
+    header.bitsPerPixel = 8;
+    header.compression = compressionRGB;
+    header.imageSize = rowBytes * image.height;
+    header.colorsUsed = 256;
+
+    file.write(reinterpret_cast<char*>(&header), sizeof(BMPHeader));
+    for (int i = 0; i < 256; ++i) {
+        const char entry[4] = { static_cast<char>(i), static_cast<char>(i), static_cast<char>(i), 0 };
+        file.write(entry, 4);
+    }
+    writeBMPRows(file, reinterpret_cast<const uint8_t*>(image.data), image.width, image.height, 1, image.stride);
+
+    TRACE_PIXELS(static_cast<long long>(image.width) * image.height);
+    TRACE_BYTES_WRITTEN(header.fileSize);
+}
+
+/*
+    Funkcija za čuvanje 32-bitne BMP slike sa alfa kanalom.
+    Koristi se BITMAPV4HEADER zaglavlje (108 bajta) sa BI_BITFIELDS maskama, jer samo ono
+    zvanicno oznacava cetvrti bajt kao alfa kanal, pa ga drugi programi ne ignorisu.
+*/
+void saveBMP(const std::string& filename, const ImageBGRA& image) {
+    saveBMP(filename, ConstImageBGRAView(image));
+}
+
+void saveBMP(const std::string& filename, const ConstImageBGRAView& image) {
+    TRACE_SCOPE("saveBMP");
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file) {
+        std::cerr << "Nije moguće otvoriti fajl za čuvanje: " << filename << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    const uint32_t v4HeaderSize = 108;
+    const uint32_t imageBytes = static_cast<uint32_t>(image.width) * image.height * 4;
+
+    BMPHeader header = {};
+    header.signature = 0x4D42;
+    header.dataOffset = 14 + v4HeaderSize;
+    header.fileSize = header.dataOffset + imageBytes;
+    header.headerSize = v4HeaderSize;
+    header.width = image.width;
+    header.height = image.height;
+    header.planes = 1;
+    header.bitsPerPixel = 32;
+    header.compression = compressionBitfields;
+    header.imageSize = imageBytes;
+
+    // Ostatak V4 zaglavlja: maske R, G, B, A, prostor boja "sRGB" i 48 bajta nula (krajnje tacke i gama)
+    uint32_t v4Fields[17] = {};
+    v4Fields[0] = 0x00FF0000;
+    v4Fields[1] = 0x0000FF00;
+    v4Fields[2] = 0x000000FF;
+    v4Fields[3] = 0xFF000000;
+    v4Fields[4] = 0x73524742;  // LCS_sRGB
+
+    file.write(reinterpret_cast<char*>(&header), sizeof(BMPHeader));
+    file.write(reinterpret_cast<char*>(v4Fields), sizeof(v4Fields));
+    writeBMPRows(file, reinterpret_cast<const uint8_t*>(image.data), image.width, image.height, 4, image.stride);
+
+    TRACE_PIXELS(static_cast<long long>(image.width) * image.height);
+    TRACE_BYTES_WRITTEN(header.fileSize);
+}
+
+// Funkcija za čuvanje 24-bitnog pogleda; redovi se upisuju cijeli, sa poravnanjem, umjesto piksel po piksel
+void saveBMP(const std::string& filename, const ConstImageView& image) {
+    TRACE_SCOPE("saveBMP");
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file) {
+        std::cerr << "Nije moguće otvoriti fajl za čuvanje: " << filename << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    const uint32_t rowBytes = (static_cast<uint32_t>(image.width) * 3 + 3) & ~3u;
+
+    BMPHeader header = {};
+    header.signature = 0x4D42;
+    header.dataOffset = sizeof(BMPHeader);
+    header.fileSize = header.dataOffset + rowBytes * image.height;
+    header.headerSize = 40;
+    header.width = image.width;
+    header.height = image.height;
+    header.planes = 1;
+    header.bitsPerPixel = 24;
+    header.compression = compressionRGB;
+    header.imageSize = static_cast<uint32_t>(image.width) * image.height * sizeof(Color);
+
+    file.write(reinterpret_cast<char*>(&header), sizeof(BMPHeader));
+    writeBMPRows(file, reinterpret_cast<const uint8_t*>(image.data), image.width, image.height, 3, image.stride);
+
+    TRACE_PIXELS(static_cast<long long>(image.width) * image.height);
+    TRACE_BYTES_WRITTEN(header.fileSize);
+}
+
+// Kodiranje 24-bitnog pogleda u BMP fajl u memoriji (isti sadrzaj kao saveBMP), npr. za asinhrono upisivanje
+void encodeBMP(const ConstImageView& image, std::vector<uint8_t>& data) {
+    TRACE_SCOPE("encodeBMP");
+
+    const size_t dataBytes = static_cast<size_t>(image.width) * 3;
+    const size_t rowBytes = (dataBytes + 3) & ~static_cast<size_t>(3);
+
+    BMPHeader header = {};
+    header.signature = 0x4D42;
+    header.dataOffset = sizeof(BMPHeader);
+    header.fileSize = static_cast<uint32_t>(header.dataOffset + rowBytes * image.height);
+    header.headerSize = 40;
+    header.width = image.width;
+    header.height = image.height;
+    header.planes = 1;
+    header.bitsPerPixel = 24;
+    header.compression = compressionRGB;
+    header.imageSize = static_cast<uint32_t>(image.width) * image.height * sizeof(Color);
+
+    data.resize(header.fileSize);
+    memcpy(data.data(), &header, sizeof(BMPHeader));
+    uint8_t* target = data.data() + sizeof(BMPHeader);
+    for (int y = image.height - 1; y >= 0; --y) {
+        memcpy(target, image.row(y), dataBytes);
+        memset(target + dataBytes, 0, rowBytes - dataBytes);
+        target += rowBytes;
+    }
+
+    TRACE_PIXELS(static_cast<long long>(image.width) * image.height);
+}
+
+/*
+    Funkcije za ucitavanje i cuvanje slike u formatu koji odgovara ekstenziji fajla.
+    Medjurezultati (izlazi testova, slike u folderima, rezultati servisa) se mogu cuvati kao ".qoi",
+    sto je bez gubitaka, a fajl je nekoliko puta manji od nekompresovanog BMP-a, pa se manje vremena trosi na disk.
+*/
+bool isQOIPath(const std::string& filename) {
+    if (filename.size() < 4)
+        return false;
+    std::string extension = filename.substr(filename.size() - 4);
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".qoi";
+}
+
+template <typename PixelT>
+BasicImage<PixelT> loadImage(const std::string& filename) {
+    return isQOIPath(filename) ? loadQOI<PixelT>(filename) : loadBMP<PixelT>(filename);
+}
+
+template GrayImage loadImage<Gray>(const std::string&);
+template Image loadImage<Color>(const std::string&);
+template ImageBGRA loadImage<ColorA>(const std::string&);
+
+template <typename PixelT>
+void loadImage(const std::string& filename, const BasicImageView<PixelT>& view) {
+    if (isQOIPath(filename))
+        loadQOI(filename, view);
+    else
+        loadBMP(filename, view);
+}
+
+template void loadImage<Gray>(const std::string&, const GrayImageView&);
+template void loadImage<Color>(const std::string&, const ImageView&);
+template void loadImage<ColorA>(const std::string&, const ImageBGRAView&);
+
+void saveImage(const std::string& filename, const Image& image) {
+    if (isQOIPath(filename))
+        saveQOI(filename, image);
+    else
+        saveBMP(filename, image);
+}
+
+void saveImage(const std::string& filename, const GrayImage& image) {
+    if (isQOIPath(filename))
+        saveQOI(filename, image);
+    else
+        saveBMP(filename, image);
+}
+
+void saveImage(const std::string& filename, const ImageBGRA& image) {
+    if (isQOIPath(filename))
+        saveQOI(filename, image);
+    else
+        saveBMP(filename, image);
+}
+
+void saveImage(const std::string& filename, const ConstImageView& image) {
+    if (isQOIPath(filename))
+        saveQOI(filename, image);
+    else
+        saveBMP(filename, image);
+}
+
+void saveImage(const std::string& filename, const ConstGrayImageView& image) {
+    if (isQOIPath(filename))
+        saveQOI(filename, image);
+    else
+        saveBMP(filename, image);
+}
+
+void saveImage(const std::string& filename, const ConstImageBGRAView& image) {
+    if (isQOIPath(filename))
+        saveQOI(filename, image);
+    else
+        saveBMP(filename, image);
+}
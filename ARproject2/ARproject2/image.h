@@ -5,6 +5,9 @@
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <cstddef>
+#include <type_traits>
+#include "numaPlacement.h"
 
 
 // Struktura za predstavljanje boje (24-bitni BMP format)
@@ -16,8 +19,33 @@ struct Color {
     Color(uint8_t b, uint8_t g, uint8_t r) : blue(b), green(g), red(r) {}
 };
 
-// Struktura za predstavljanje slike
-struct Image {
+// Struktura za predstavljanje sivog piksela (8-bitni BMP format)
+struct Gray {
+
+    uint8_t value;
+
+    Gray() : value(0) {}
+    explicit Gray(uint8_t v) : value(v) {}
+};
+
+// Struktura za predstavljanje boje sa alfa kanalom (32-bitni BMP format), poravnata na 4 bajta
+struct alignas(4) ColorA {
+
+    uint8_t blue, green, red, alpha;
+
+    ColorA() : blue(0), green(0), red(0), alpha(0) {}
+    ColorA(uint8_t b, uint8_t g, uint8_t r, uint8_t a) : blue(b), green(g), red(r), alpha(a) {}
+};
+
+// Broj kanala (bajtova) po pikselu za svaki tip piksela
+template <typename PixelT> struct PixelTraits;
+template <> struct PixelTraits<Gray> { static const int channels = 1; };
+template <> struct PixelTraits<Color> { static const int channels = 3; };
+template <> struct PixelTraits<ColorA> { static const int channels = 4; };
+
+// Struktura za predstavljanje slike sa pikselima tipa PixelT (Gray, Color ili ColorA)
+template <typename PixelT>
+struct BasicImage {
 
     int width, height;
 
@@ -37,15 +65,91 @@ struct Image {
     što olakšava manipulaciju i analizu piksela u slici.
 */
 
-    std::vector<Color> pixels;
+    // Pikseli se pune nulama paralelno, svaka nit svoju traku (vidi numaPlacement.h)
+    std::vector<PixelT, FirstTouchAllocator<PixelT>> pixels;
+
+    BasicImage(int w, int h) : width(w), height(h), pixels(w* h, FirstTouchAllocator<PixelT>(firstTouch, static_cast<size_t>(w) * h)) { firstTouchZero(pixels.data(), pixels.size(), sizeof(PixelT)); }
+};
+
+typedef BasicImage<Color> Image;      // 3 kanala, 24 bita po pikselu
+typedef BasicImage<Gray> GrayImage;   // 1 kanal, 8 bita po pikselu
+typedef BasicImage<ColorA> ImageBGRA; // 4 kanala, 32 bita po pikselu
 
-    Image(int w, int h) : width(w), height(h), pixels(w* h) {}
+// Pravougaonik u koordinatama slike (gornji lijevi ugao, sirina i visina)
+struct Rect {
+    int x, y, width, height;
+
+    Rect() : x(0), y(0), width(0), height(0) {}
+    Rect(int x, int y, int w, int h) : x(x), y(y), width(w), height(h) {}
+
+    bool empty() const { return width <= 0 || height <= 0; }
 };
 
+/*
+    Pogled na sliku (view) koji ne posjeduje piksele: pokazivac na prvi piksel, sirina, visina i razmak
+    izmedju pocetaka susjednih redova u bajtovima (stride). Razmak moze biti veci od sirine reda, pa pogled
+    moze opisati pravougaoni isjecak vece slike ili tudji bafer sa poravnatim redovima, bez kopiranja.
+    Pogled sa `const` tipom piksela (npr. ConstImageView) sluzi samo za citanje.
+*/
+template <typename PixelT>
+struct BasicImageView {
+
+    typedef typename std::remove_const<PixelT>::type Pixel;
+
+    PixelT* data;
+    int width, height;
+    size_t stride;
+
+    BasicImageView(PixelT* d, int w, int h, size_t s) : data(d), width(w), height(h), stride(s) {}
+    BasicImageView(PixelT* d, int w, int h) : data(d), width(w), height(h), stride(w * sizeof(Pixel)) {}
+    BasicImageView(BasicImage<Pixel>& image) : BasicImageView(image.pixels.data(), image.width, image.height) {}
+    BasicImageView(const BasicImage<Pixel>& image) : BasicImageView(image.pixels.data(), image.width, image.height) {}
+
+    // Pogled za pisanje se moze proslijediti tamo gdje se ocekuje pogled samo za citanje
+    template <typename OtherT, typename = typename std::enable_if<std::is_same<const OtherT, PixelT>::value>::type>
+    BasicImageView(const BasicImageView<OtherT>& view) : data(view.data), width(view.width), height(view.height), stride(view.stride) {}
+
+    PixelT* row(int y) const {
+        typedef typename std::conditional<std::is_const<PixelT>::value, const uint8_t, uint8_t>::type Byte;
+        return reinterpret_cast<PixelT*>(reinterpret_cast<Byte*>(data) + static_cast<size_t>(y) * stride);
+    }
+
+    PixelT& at(int x, int y) const { return row(y)[x]; }
+
+    // Pogled na pravougaonik unutar ovog pogleda (pravougaonik mora biti unutar granica)
+    BasicImageView subView(const Rect& rect) const { return BasicImageView(row(rect.y) + rect.x, rect.width, rect.height, stride); }
+};
+
+typedef BasicImageView<Color> ImageView;
+typedef BasicImageView<const Color> ConstImageView;
+typedef BasicImageView<Gray> GrayImageView;
+typedef BasicImageView<const Gray> ConstGrayImageView;
+typedef BasicImageView<ColorA> ImageBGRAView;
+typedef BasicImageView<const ColorA> ConstImageBGRAView;
+
 std::vector<Color> loadBMP1(const std::string&, int&, int&);
 
 std::vector<Color> loadBMP2(const std::string&, int&, int&);
 
+// Broj kanala BMP fajla (1 za 8-bitne, 3 za 24-bitne i 4 za 32-bitne slike)
+int probeBMPChannels(const std::string&);
+
+// Ucitavanje 8, 24 ili 32-bitnog BMP fajla u sliku sa zadanim tipom piksela
+template <typename PixelT>
+BasicImage<PixelT> loadBMP(const std::string&);
+
+// Ucitavanje BMP fajla direktno u postojeci pogled (dimenzije fajla i pogleda moraju biti iste)
+template <typename PixelT>
+void loadBMP(const std::string&, const BasicImageView<PixelT>&);
+
+// Dekodiranje BMP fajla koji je vec procitan u memoriju (npr. asinhronim citanjem, vidi asyncImageIO.h)
+template <typename PixelT>
+BasicImage<PixelT> decodeBMP(const uint8_t* , size_t , const std::string& );
+
+// Kao decodeBMP, ali za neispravan ili skracen fajl vraca false i opis greske umjesto da prekine program
+template <typename PixelT>
+bool tryDecodeBMP(const uint8_t* , size_t , const std::string& , BasicImage<PixelT>& , std::string& );
+
 /*
     Ovaj sljedeci code snippet definira strukturu BMPHeader koja predstavlja zaglavlje BMP (Bitmap) datoteke.
 
@@ -124,3 +228,38 @@ struct BMPHeader {
 #pragma pack(pop)
 
 void saveBMP(const std::string& , const Image& );
+
+void saveBMP(const std::string& , const GrayImage& );
+
+void saveBMP(const std::string& , const ImageBGRA& );
+
+// Cuvanje pogleda (npr. isjecka vece slike) bez prethodnog kopiranja u zasebnu sliku
+void saveBMP(const std::string& , const ConstImageView& );
+
+void saveBMP(const std::string& , const ConstGrayImageView& );
+
+void saveBMP(const std::string& , const ConstImageBGRAView& );
+
+// Kodiranje 24-bitne slike u BMP fajl u memoriji (isti bajtovi kao saveBMP)
+void encodeBMP(const ConstImageView& , std::vector<uint8_t>& );
+
+// Format se bira prema ekstenziji fajla: ".qoi" za kompresovani QOI format, sve ostalo je BMP
+bool isQOIPath(const std::string& );
+
+template <typename PixelT>
+BasicImage<PixelT> loadImage(const std::string& );
+
+void saveImage(const std::string& , const Image& );
+
+void saveImage(const std::string& , const GrayImage& );
+
+void saveImage(const std::string& , const ImageBGRA& );
+
+template <typename PixelT>
+void loadImage(const std::string& , const BasicImageView<PixelT>& );
+
+void saveImage(const std::string& , const ConstImageView& );
+
+void saveImage(const std::string& , const ConstGrayImageView& );
+
+void saveImage(const std::string& , const ConstImageBGRAView& );
@@ -12,6 +12,6 @@ void saveImageToFolder(const Image& outputImage, const std::string& folderPath,
     // Formirajte putanju do slike
     fs::path imagePath = folder / imageName;
 
-    // Čuvanje slike u BMP formatu
-    saveBMP(imagePath.string(), outputImage);
+    // Čuvanje slike u BMP ili QOI formatu, prema ekstenziji imena slike
+    saveImage(imagePath.string(), outputImage);
 }
\ No newline at end of file
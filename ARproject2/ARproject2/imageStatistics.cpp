@@ -0,0 +1,78 @@
+#include "imageStatistics.h"
+#include "tracing.h"
+
+#include <iomanip>
+
+int ImageStatistics::minimum(int channel) const {
+    for (int i = 0; i < 256; ++i)
+        if (histogram[channel][i] > 0)
+            return i;
+    return 0;
+}
+
+int ImageStatistics::maximum(int channel) const {
+    for (int i = 255; i >= 0; --i)
+        if (histogram[channel][i] > 0)
+            return i;
+    return 0;
+}
+
+double ImageStatistics::mean(int channel) const {
+    if (pixelCount == 0)
+        return 0.0;
+    double sum = 0.0;
+    for (int i = 0; i < 256; ++i)
+        sum += static_cast<double>(histogram[channel][i]) * i;
+    return sum / pixelCount;
+}
+
+namespace {
+    template <typename PixelT>
+    void computeStatisticsCore(const BasicImage<PixelT>& image, ImageStatistics& statistics) {
+        TRACE_SCOPE("computeStatistics");
+        TRACE_PIXELS(image.pixels.size());
+
+        const int channels = PixelTraits<PixelT>::channels;
+        statistics.clear(channels);
+
+#pragma omp parallel
+        {
+            ImageStatistics partial;
+            partial.clear(channels);
+            partial.strongEdgeThreshold = statistics.strongEdgeThreshold;
+
+#pragma omp for nowait
+            for (long long i = 0; i < static_cast<long long>(image.pixels.size()); ++i)
+                partial.addPixel<channels>(reinterpret_cast<const uint8_t*>(&image.pixels[i]));
+
+#pragma omp critical
+            statistics.merge(partial);
+        }
+    }
+}
+
+void computeStatistics(const Image& image, ImageStatistics& statistics) {
+    computeStatisticsCore(image, statistics);
+}
+
+void computeStatistics(const GrayImage& image, ImageStatistics& statistics) {
+    computeStatisticsCore(image, statistics);
+}
+
+void computeStatistics(const ImageBGRA& image, ImageStatistics& statistics) {
+    computeStatisticsCore(image, statistics);
+}
+
+void printStatistics(std::ostream& out, const ImageStatistics& statistics) {
+    static const char* names[4] = { "plava", "zelena", "crvena", "alfa" };
+
+    for (int c = 0; c < statistics.channels; ++c) {
+        out << std::setw(8) << (statistics.channels == 1 ? "siva" : names[c])
+            << ": min " << std::setw(3) << statistics.minimum(c)
+            << ", max " << std::setw(3) << statistics.maximum(c)
+            << ", srednja " << std::fixed << std::setprecision(2) << statistics.mean(c) << std::endl;
+    }
+    out << "Jakih ivica (>= " << statistics.strongEdgeThreshold << "): " << statistics.strongEdges
+        << " od " << statistics.pixelCount << " piksela" << std::endl;
+    out.unsetf(std::ios::floatfield);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include "image.h"
+
+/*
+    Statistika izlazne slike po kanalu: histogram, minimum, maksimum i srednja vrijednost,
+    kao i broj "jakih ivica" (piksela ciji je najveci kanal >= strongEdgeThreshold), sto je korisno
+    za izlaz detekcije ivica. Minimum, maksimum i srednja vrijednost se izvode iz histograma,
+    pa se tokom racunanja za svaki piksel samo uvecavaju brojaci.
+    Kanali su u redoslijedu bajtova piksela (plava, zelena, crvena, alfa; siva slika ima jedan kanal).
+*/
+struct ImageStatistics {
+
+    int channels;
+    int strongEdgeThreshold;
+    long long pixelCount;
+    long long strongEdges;
+    uint64_t histogram[4][256];
+
+    ImageStatistics() : channels(0), strongEdgeThreshold(128) { clear(channels); }
+
+    void clear(int channelCount) {
+        channels = channelCount;
+        pixelCount = 0;
+        strongEdges = 0;
+        for (int c = 0; c < 4; ++c)
+            for (int i = 0; i < 256; ++i)
+                histogram[c][i] = 0;
+    }
+
+    // Dodavanje jednog piksela; poziva se dok je izracunati piksel jos u registrima
+    template <int Channels>
+    void addPixel(const uint8_t* pixel) {
+        uint8_t strongest = 0;
+        for (int c = 0; c < Channels; ++c) {
+            ++histogram[c][pixel[c]];
+            strongest = pixel[c] > strongest ? pixel[c] : strongest;
+        }
+        ++pixelCount;
+        strongEdges += strongest >= strongEdgeThreshold;
+    }
+
+    // Spajanje djelimicne statistike jedne niti u ukupnu
+    void merge(const ImageStatistics& other) {
+        pixelCount += other.pixelCount;
+        strongEdges += other.strongEdges;
+        for (int c = 0; c < channels; ++c)
+            for (int i = 0; i < 256; ++i)
+                histogram[c][i] += other.histogram[c][i];
+    }
+
+    int minimum(int ) const;
+    int maximum(int ) const;
+    double mean(int ) const;
+};
+
+// Statistika vec izracunate slike (poseban prolaz kroz memoriju); konvolucija je moze racunati usput
+void computeStatistics(const Image& , ImageStatistics& );
+
+void computeStatistics(const GrayImage& , ImageStatistics& );
+
+void computeStatistics(const ImageBGRA& , ImageStatistics& );
+
+void printStatistics(std::ostream& , const ImageStatistics& );
@@ -1,42 +1,74 @@
 #include "kernel.h"
 
-namespace Kernel {
-
-    std::vector<float> kernelIdentity = { 0, -1, 0, -1, 5, -1, 0, -1, 0 };
-
-    std::vector<float> kernelGaussianBlur = {
-        0.0625, 0.125, 0.0625,
-        0.125, 0.25, 0.125,
-        0.0625, 0.125, 0.0625 };
-
-    std::vector<float> kernelEdgeDetection = {
-        -1, -1, -1,
-        -1, 8, -1,
-        -1, -1, -1 };
+#include <cstring>
+#include <cstdlib>
 
-    std::vector<float> kernelBoxBlur = {
-        0.1111, 0.1111, 0.1111,
-        0.1111, 0.1111, 0.1111,
-        0.1111, 0.1111, 0.1111 };
-
-    std::vector<float> kernelSharpen = {
-        0, -1, 0,
-        -1, 5, -1,
-        0, -1, 0
-    };
+namespace Kernel {
 
     std::vector<float> parseKernelValues(const char* kernelArg) {
         std::vector<float> kernelValues;
 
-        const char delimiter = ',';
-        char* token = strtok(const_cast<char*>(kernelArg), &delimiter);
+        const char* delimiter = ",";
+        char* token = strtok(const_cast<char*>(kernelArg), delimiter);
 
         while (token != nullptr) {
             double value = atof(token);
             kernelValues.push_back(value);
-            token = strtok(nullptr, &delimiter);
+            token = strtok(nullptr, delimiter);
         }
 
         return kernelValues;
     }
+
+    // Funkcija koja vraca ugradjeni kernel po imenu, ili parsira vrijednosti ako ime nije poznato
+    std::vector<float> kernelByName(const std::string& name) {
+        if (name == "identity")
+            return kernelIdentity.toVector();
+        if (name == "gaussian")
+            return kernelGaussianBlur.toVector();
+        if (name == "edge")
+            return kernelEdgeDetection.toVector();
+        if (name == "box")
+            return kernelBoxBlur.toVector();
+        if (name == "sharpen")
+            return kernelSharpen.toVector();
+        if (name == "gaussian5")
+            return KernelLibrary::gaussian5.toVector();
+        if (name == "box5")
+            return KernelLibrary::box5.toVector();
+        if (name == "unsharp")
+            return KernelLibrary::unsharp5.toVector();
+        if (name == "laplacian")
+            return KernelLibrary::laplacian3.toVector();
+        if (name == "sobelx")
+            return KernelLibrary::sobelX3.toVector();
+        if (name == "sobely")
+            return KernelLibrary::sobelY3.toVector();
+        if (name == "scharrx")
+            return KernelLibrary::scharrX3.toVector();
+        if (name == "scharry")
+            return KernelLibrary::scharrY3.toVector();
+
+        // parseKernelValues mijenja ulazni niz (strtok), pa mu se prosljedjuje kopija
+        std::vector<char> values(name.begin(), name.end());
+        values.push_back('\0');
+        return parseKernelValues(values.data());
+    }
+
+    // Funkcija koja parsira niz kernela razdvojenih znakom '+', npr. "gaussian+sharpen"
+    std::vector<std::vector<float>> parsePipeline(const std::string& description) {
+        std::vector<std::vector<float>> stages;
+
+        size_t start = 0;
+        while (start <= description.size()) {
+            size_t end = description.find('+', start);
+            if (end == std::string::npos)
+                end = description.size();
+            if (end > start)
+                stages.push_back(kernelByName(description.substr(start, end - start)));
+            start = end + 1;
+        }
+
+        return stages;
+    }
 }
\ No newline at end of file
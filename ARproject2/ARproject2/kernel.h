@@ -1,14 +1,27 @@
+#pragma once
+
 #include <vector>
+#include <string>
+#include "kernelLibrary.h"
 
 #pragma warning(disable : 4996)
 
 namespace Kernel {
 
-    extern std::vector<float> kernelIdentity;
-    extern std::vector<float> kernelGaussianBlur;
-    extern std::vector<float> kernelEdgeDetection;
-    extern std::vector<float> kernelBoxBlur;
-    extern std::vector<float> kernelSharpen;
+    /*
+        Ugradjeni kerneli su pogledi na constexpr kernele iz kernelLibrary.h: ne zauzimaju heap i ne konstruisu se
+        pri pokretanju programa. Funkcije koje primaju std::vector (convolution(), cv::Mat u meniju) dobijaju kopiju
+        sa toVector() na mjestu poziva; convolution() je prepoznaje po vrijednostima i racuna sa constexpr tezinama.
+    */
+    inline constexpr const auto& kernelIdentity = KernelLibrary::identity3;
+    inline constexpr const auto& kernelGaussianBlur = KernelLibrary::gaussian3;
+    inline constexpr const auto& kernelEdgeDetection = KernelLibrary::edge3;
+    inline constexpr const auto& kernelBoxBlur = KernelLibrary::box3;
+    inline constexpr const auto& kernelSharpen = KernelLibrary::sharpen3;
 
     std::vector<float> parseKernelValues(const char*);
+
+    std::vector<float> kernelByName(const std::string&);
+
+    std::vector<std::vector<float>> parsePipeline(const std::string&);
 }
\ No newline at end of file
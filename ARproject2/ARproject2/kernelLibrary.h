@@ -0,0 +1,229 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+/*
+    Biblioteka kernela koji se generisu u vrijeme kompajliranja (constexpr) i cuvaju u std::array.
+    Za razliku od globalnih std::vector kernela, ovi kerneli ne zauzimaju heap, ne konstruisu se pri pokretanju
+    programa, a kompajler zna njihove vrijednosti, pa ih u specijalizovanim sablonima (convolutionFixed.h)
+    ugradjuje direktno u petlju; convolution() i convolutionSeparable() prepoznaju ove kernele i faktore
+    po vrijednostima i pozivaju te sablone. Normalizacija se racuna u double preciznosti iz tacnog zbira tezina
+    (npr. box 3x3 je tacno 1/9 po elementu, do zaokruzivanja na float), a separabilnost i simetrija
+    se takodje mogu provjeriti u vrijeme kompajliranja (static_assert).
+*/
+namespace KernelLibrary {
+
+    namespace detail {
+        constexpr double absolute(double x) { return x < 0 ? -x : x; }
+
+        // e^x: argument se prepolovi dok ne bude mali, Taylorov red, pa se rezultat kvadrira isti broj puta
+        constexpr double exponential(double x) {
+            int halvings = 0;
+            while (x < -0.5 || x > 0.5) {
+                x /= 2;
+                ++halvings;
+            }
+            double term = 1.0, sum = 1.0;
+            for (int i = 1; i < 20; ++i) {
+                term *= x / i;
+                sum += term;
+            }
+            while (halvings-- > 0)
+                sum *= sum;
+            return sum;
+        }
+    }
+
+    // Kvadratni kernel velicine N x N (N je neparan), elementi red po red
+    template <int N>
+    struct FixedKernel {
+        static_assert(N % 2 == 1, "Velicina kernela mora biti neparna");
+
+        static constexpr int size = N;
+        static constexpr int radius = N / 2;
+
+        std::array<float, N * N> values{};
+
+        constexpr float operator()(int y, int x) const { return values[y * N + x]; }
+
+        // Kopija u obliku koji koriste convolution() i ostale funkcije sa std::vector kernelom
+        std::vector<float> toVector() const { return std::vector<float>(values.begin(), values.end()); }
+    };
+
+    // Rastav kernela na kolonu i red: kernel(y, x) = column[y] * row[x]
+    template <int N>
+    struct KernelFactors {
+        bool separable = false;
+        std::array<float, N> column{};
+        std::array<float, N> row{};
+    };
+
+    struct KernelSymmetry {
+        bool horizontal = false;  // kernel(y, x) == kernel(y, N - 1 - x)
+        bool vertical = false;    // kernel(y, x) == kernel(N - 1 - y, x)
+        bool central = false;     // kernel(y, x) == kernel(N - 1 - y, N - 1 - x)
+    };
+
+    // Spoljasnji proizvod kolone i reda (racuna se u double pa zaokruzuje)
+    template <int N>
+    constexpr FixedKernel<N> outerProduct(const std::array<double, N>& column, const std::array<double, N>& row) {
+        FixedKernel<N> kernel;
+        for (int y = 0; y < N; ++y)
+            for (int x = 0; x < N; ++x)
+                kernel.values[y * N + x] = static_cast<float>(column[y] * row[x]);
+        return kernel;
+    }
+
+    template <int N>
+    constexpr FixedKernel<N> identity() {
+        FixedKernel<N> kernel;
+        kernel.values[(N / 2) * N + N / 2] = 1.0f;
+        return kernel;
+    }
+
+    template <int N>
+    constexpr FixedKernel<N> box() {
+        FixedKernel<N> kernel;
+        for (int i = 0; i < N * N; ++i)
+            kernel.values[i] = static_cast<float>(1.0 / (N * N));
+        return kernel;
+    }
+
+    // Binomni kernel (red Paskalovog trougla): 1-2-1 za N = 3, 1-4-6-4-1 za N = 5; tezine su tacni stepeni dvojke
+    template <int N>
+    constexpr FixedKernel<N> binomial() {
+        std::array<double, N> weights{};
+        weights[0] = 1.0;
+        for (int i = 1; i < N; ++i)
+            for (int j = i; j > 0; --j)
+                weights[j] += weights[j - 1];
+
+        double sum = 0.0;
+        for (double weight : weights)
+            sum += weight;
+        for (double& weight : weights)
+            weight /= sum;
+        return outerProduct<N>(weights, weights);
+    }
+
+    // Gausov kernel sa zadatom standardnom devijacijom; jednodimenzionalne tezine se normalizuju na zbir 1
+    template <int N>
+    constexpr FixedKernel<N> gaussian(double sigma) {
+        std::array<double, N> weights{};
+        double sum = 0.0;
+        for (int i = 0; i < N; ++i) {
+            double d = i - N / 2;
+            weights[i] = detail::exponential(-(d * d) / (2.0 * sigma * sigma));
+            sum += weights[i];
+        }
+        for (double& weight : weights)
+            weight /= sum;
+        return outerProduct<N>(weights, weights);
+    }
+
+    // Izostravanje (unsharp mask): (1 + amount) * original - amount * zamucena slika
+    template <int N>
+    constexpr FixedKernel<N> unsharp(double sigma, double amount) {
+        FixedKernel<N> blur = gaussian<N>(sigma);
+        FixedKernel<N> kernel;
+        for (int i = 0; i < N * N; ++i)
+            kernel.values[i] = static_cast<float>(-amount * blur.values[i]);
+        kernel.values[(N / 2) * N + N / 2] += static_cast<float>(1.0 + amount);
+        return kernel;
+    }
+
+    constexpr FixedKernel<3> fromValues(const std::array<float, 9>& values) {
+        FixedKernel<3> kernel;
+        kernel.values = values;
+        return kernel;
+    }
+
+    constexpr FixedKernel<3> laplacian() { return fromValues({ 0, 1, 0, 1, -4, 1, 0, 1, 0 }); }
+    constexpr FixedKernel<3> edgeDetection() { return fromValues({ -1, -1, -1, -1, 8, -1, -1, -1, -1 }); }
+    constexpr FixedKernel<3> sharpen() { return fromValues({ 0, -1, 0, -1, 5, -1, 0, -1, 0 }); }
+    constexpr FixedKernel<3> sobelX() { return fromValues({ -1, 0, 1, -2, 0, 2, -1, 0, 1 }); }
+    constexpr FixedKernel<3> sobelY() { return fromValues({ -1, -2, -1, 0, 0, 0, 1, 2, 1 }); }
+    constexpr FixedKernel<3> scharrX() { return fromValues({ -3, 0, 3, -10, 0, 10, -3, 0, 3 }); }
+    constexpr FixedKernel<3> scharrY() { return fromValues({ -3, -10, -3, 0, 0, 0, 3, 10, 3 }); }
+
+    /*
+        Provjera separabilnosti u vrijeme kompajliranja (isti postupak kao separateKernel() u convolution.cpp):
+        oslonac je element najvece apsolutne vrijednosti, kolona i red se citaju kroz njega,
+        a zatim se svaki element poredi sa proizvodom uz relativnu toleranciju.
+    */
+    template <int N>
+    constexpr KernelFactors<N> factorize(const FixedKernel<N>& kernel) {
+        KernelFactors<N> factors;
+        int pivot = 0;
+        for (int i = 1; i < N * N; ++i)
+            if (detail::absolute(kernel.values[i]) > detail::absolute(kernel.values[pivot]))
+                pivot = i;
+        float pivotValue = kernel.values[pivot];
+        if (pivotValue == 0.0f)
+            return factors;
+
+        int pivotRow = pivot / N, pivotColumn = pivot % N;
+        for (int i = 0; i < N; ++i) {
+            factors.column[i] = kernel.values[i * N + pivotColumn];
+            factors.row[i] = kernel.values[pivotRow * N + i] / pivotValue;
+        }
+
+        double tolerance = 1e-5 * detail::absolute(pivotValue);
+        for (int y = 0; y < N; ++y)
+            for (int x = 0; x < N; ++x)
+                if (detail::absolute(kernel.values[y * N + x] - static_cast<double>(factors.column[y]) * factors.row[x]) > tolerance)
+                    return KernelFactors<N>();
+        factors.separable = true;
+        return factors;
+    }
+
+    template <int N>
+    constexpr KernelSymmetry symmetry(const FixedKernel<N>& kernel) {
+        KernelSymmetry result;
+        result.horizontal = result.vertical = result.central = true;
+        for (int y = 0; y < N; ++y) {
+            for (int x = 0; x < N; ++x) {
+                float value = kernel(y, x);
+                result.horizontal = result.horizontal && value == kernel(y, N - 1 - x);
+                result.vertical = result.vertical && value == kernel(N - 1 - y, x);
+                result.central = result.central && value == kernel(N - 1 - y, N - 1 - x);
+            }
+        }
+        return result;
+    }
+
+    template <int N>
+    constexpr double sum(const FixedKernel<N>& kernel) {
+        double total = 0.0;
+        for (float value : kernel.values)
+            total += value;
+        return total;
+    }
+
+    // Ugradjeni kerneli; izracunati su u vrijeme kompajliranja
+    inline constexpr FixedKernel<3> identity3 = identity<3>();
+    inline constexpr FixedKernel<3> gaussian3 = binomial<3>();
+    inline constexpr FixedKernel<5> gaussian5 = binomial<5>();
+    inline constexpr FixedKernel<3> box3 = box<3>();
+    inline constexpr FixedKernel<5> box5 = box<5>();
+    inline constexpr FixedKernel<3> edge3 = edgeDetection();
+    inline constexpr FixedKernel<3> sharpen3 = sharpen();
+    inline constexpr FixedKernel<5> unsharp5 = unsharp<5>(1.0, 1.5);
+    inline constexpr FixedKernel<3> laplacian3 = laplacian();
+    inline constexpr FixedKernel<3> sobelX3 = sobelX();
+    inline constexpr FixedKernel<3> sobelY3 = sobelY();
+    inline constexpr FixedKernel<3> scharrX3 = scharrX();
+    inline constexpr FixedKernel<3> scharrY3 = scharrY();
+
+    inline constexpr KernelFactors<3> gaussian3Factors = factorize(gaussian3);
+    inline constexpr KernelFactors<5> gaussian5Factors = factorize(gaussian5);
+    inline constexpr KernelFactors<3> box3Factors = factorize(box3);
+    inline constexpr KernelFactors<5> box5Factors = factorize(box5);
+
+    static_assert(gaussian3Factors.separable && gaussian5Factors.separable && box3Factors.separable, "Gausov i box kernel su separabilni");
+    static_assert(!factorize(edge3).separable && !factorize(sharpen3).separable, "Detekcija ivica i izostravanje nisu separabilni");
+    static_assert(factorize(sobelX()).separable && factorize(scharrY()).separable, "Sobel i Scharr su separabilni");
+    static_assert(symmetry(gaussian5).central && symmetry(edge3).horizontal && !symmetry(sobelX()).horizontal, "Provjera simetrije");
+    static_assert(detail::absolute(sum(box3) - 1.0) < 1e-6 && detail::absolute(sum(gaussian5) - 1.0) < 1e-6, "Kerneli za zamucivanje imaju zbir 1");
+}
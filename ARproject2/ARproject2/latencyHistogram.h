@@ -0,0 +1,48 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+/*
+    Histogram kasnjenja sa logaritamskim korpama (8 po oktavi, od 1 us do oko 18 minuta).
+    Memorija je fiksna bez obzira na broj uzoraka, pa se moze puniti za svaki frejm ili posao,
+    a percentil se racuna jednim prolazom kroz korpe, uz relativnu gresku do 9% (vraca se gornja granica korpe).
+    Nije zasticen za istovremeno upisivanje iz vise niti.
+*/
+class LatencyHistogram {
+public:
+    void record(double ms) {
+        int bucket = ms <= minimumMs ? 0 : static_cast<int>(std::log2(ms / minimumMs) * bucketsPerOctave);
+        ++buckets[std::min(bucket, bucketCount - 1)];
+        ++samples;
+        maximum = std::max(maximum, ms);
+    }
+
+    uint64_t count() const { return samples; }
+
+    double max() const { return maximum; }
+
+    // Gornja granica korpe u kojoj je uzorak sa rangom ceil(fraction * count), ali ne vise od najveceg uzorka
+    double percentile(double fraction) const {
+        if (samples == 0)
+            return 0.0;
+        uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(fraction * samples)));
+        uint64_t seen = 0;
+        for (int bucket = 0; bucket < bucketCount; ++bucket) {
+            seen += buckets[bucket];
+            if (seen >= rank)
+                return std::min(maximum, minimumMs * std::exp2(static_cast<double>(bucket + 1) / bucketsPerOctave));
+        }
+        return maximum;
+    }
+
+private:
+    static const int bucketsPerOctave = 8;
+    static const int bucketCount = 30 * bucketsPerOctave;
+    static constexpr double minimumMs = 0.001;
+
+    uint64_t buckets[bucketCount] = {};
+    uint64_t samples = 0;
+    double maximum = 0.0;
+};
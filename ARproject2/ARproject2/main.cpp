@@ -3,6 +3,18 @@
 #include "kernel.h"
 #include "convolution_tester.h"
 #include "imageFolder.h"
+#include "frameStream.h"
+#include "convolutionService.h"
+#include "resultCache.h"
+#include "tileSharding.h"
+#include "autoTuner.h"
+#include "tiledImage.h"
+#include "asyncImageIO.h"
+#include "scalingStudy.h"
+#include "numaPlacement.h"
+#include "pyramid.h"
+#include "medianFilter.h"
+#include "morphology.h"
 
 #include <fstream>
 
@@ -13,6 +25,203 @@ int main(int argc, char* argv[]) {
     bool loop = true;
     bool testing;
 
+    // Vezivanje OpenMP niti za NUMA cvorove, samo ako je zatrazeno (CONVOLUTION_PIN_THREADS=1)
+    pinWorkerThreads();
+
+    // Rezim obrade video toka: --stream <bgr24:SIRINAxVISINA | y4m> <kernel[+kernel...]> [ulaz] [izlaz]
+    if (argc >= 2 && std::string(argv[1]) == "--stream") {
+        StreamOptions streamOptions;
+        if (!parseStreamOptions(argc - 2, argv + 2, streamOptions))
+            return EXIT_FAILURE;
+        return runFrameStream(streamOptions);
+    }
+
+    // Lokalni servis za konvoluciju: --serve <socket> [kapacitet reda] [velicina paketa] [folder za BMP izlaze]
+    if (argc >= 3 && std::string(argv[1]) == "--serve") {
+        ServiceOptions serviceOptions;
+        serviceOptions.socketPath = argv[2];
+        if (argc >= 4)
+            serviceOptions.queueCapacity = atoi(argv[3]);
+        if (argc >= 5)
+            serviceOptions.batchSize = atoi(argv[4]);
+        if (argc >= 6)
+            serviceOptions.outputDirectory = argv[5];
+        return runConvolutionService(serviceOptions);
+    }
+
+    // Klijent servisa: --submit <socket> <ulaz.bmp> <izlaz.bmp> [kernel] [replicate|constant|reflect] [broj ponavljanja] [bmp]
+    if (argc >= 5 && std::string(argv[1]) == "--submit") {
+        std::vector<float> kernel = Kernel::kernelByName(argc >= 6 ? argv[5] : "gaussian");
+        BorderMode border = parseBorderMode(argc >= 7 ? argv[6] : "replicate");
+        int repeat = argc >= 8 ? atoi(argv[7]) : 1;
+        ServiceOutput output = (argc >= 9 && std::string(argv[8]) == "bmp") ? ServiceOutput::BmpFile : ServiceOutput::SharedMemory;
+        return submitConvolutionJob(argv[2], argv[3], argv[4], kernel, border, output, repeat);
+    }
+
+    if (argc >= 3 && std::string(argv[1]) == "--service-stats")
+        return requestServiceStats(argv[2]);
+
+    if (argc >= 3 && std::string(argv[1]) == "--service-stop")
+        return stopConvolutionService(argv[2]);
+
+    // Raspodjela velike slike na vise procesa: --shard <ulaz.bmp> <izlaz.bmp> [kernel] [broj radnika] [redova po plocici] [rubovi] [--worker "komanda"]... [--timeout sekundi]
+    if (argc >= 2 && std::string(argv[1]) == "--shard") {
+        ShardOptions shardOptions;
+        if (!parseShardOptions(argc - 2, argv + 2, shardOptions))
+            return EXIT_FAILURE;
+        return runShardCoordinator(shardOptions);
+    }
+
+    // Radnik koji prima plocice od koordinatora preko standardnog ulaza i izlaza
+    if (argc >= 2 && std::string(argv[1]) == "--tile-worker")
+        return runTileWorker();
+
+    // Automatsko podesavanje: --autotune [profil|default] [quick]; bez putanje profil ide u defaultTuningProfilePath(),
+    // odakle ga convolutionTuned() ucitava automatski (drugi fajl se zadaje sa CONVOLUTION_TUNING_PROFILE)
+    if (argc >= 2 && std::string(argv[1]) == "--autotune") {
+        AutoTuneOptions tuneOptions;
+        if (argc >= 3 && std::string(argv[2]) != "default")
+            tuneOptions.profilePath = argv[2];
+        if (argc >= 4 && std::string(argv[3]) == "quick") {
+            tuneOptions.imageSizes = { 256, 1024 };
+            tuneOptions.kernelSizes = { 3, 9 };
+            tuneOptions.repetitions = 2;
+        }
+        return runAutoTune(tuneOptions);
+    }
+
+    // Studija skaliranja po broju niti i velicini slike: --scaling-study [csv] [quick]
+    if (argc >= 2 && std::string(argv[1]) == "--scaling-study") {
+        ScalingStudyOptions studyOptions;
+        if (argc >= 3)
+            studyOptions.csvPath = argv[2];
+        if (argc >= 4 && std::string(argv[3]) == "quick") {
+            studyOptions.imageSizes = { 64, 256, 1024, 4096 };
+            studyOptions.kernelSizes = { 3, 9 };
+            studyOptions.weakSize = 512;
+            studyOptions.repetitions = 2;
+        }
+        return runScalingStudy(studyOptions);
+    }
+
+    // Provjera rasporeda stranica slike po NUMA cvorovima: --numa-check [sirina] [visina]
+    // (na masini sa jednim cvorom topologija se moze simulirati sa CONVOLUTION_NUMA_NODES=N; niti vezuje CONVOLUTION_PIN_THREADS=1)
+    if (argc >= 2 && std::string(argv[1]) == "--numa-check") {
+        int width = argc >= 3 ? atoi(argv[2]) : 8192;
+        int height = argc >= 4 ? atoi(argv[3]) : 4096;
+        return runNumaCheck(std::max(1, width), std::max(1, height));
+    }
+
+    // Poredjenje rasporeda piksela (red po red i po plocicama): --layout-benchmark [sirina] [visina] [ponavljanja]
+    if (argc >= 2 && std::string(argv[1]) == "--layout-benchmark") {
+        int width = argc >= 3 ? atoi(argv[2]) : 16384;
+        int height = argc >= 4 ? atoi(argv[3]) : 1024;
+        int repetitions = argc >= 5 ? atoi(argv[4]) : 3;
+        return runLayoutBenchmark(std::max(1, width), std::max(1, height), repetitions);
+    }
+
+    // Paketna obrada sa asinhronim citanjem i upisivanjem: --batch-io [kernel] [broj slika] [dubina reda]
+    // Ulazi su input1.bmp ... inputN.bmp, kao u testiranju; bez broja slika koristi se num_images.txt
+    // Izlazi su output1.bmp ... (sinhrono) i output1_async.bmp ... (asinhrono)
+    if (argc >= 2 && std::string(argv[1]) == "--batch-io") {
+        std::vector<float> kernel = Kernel::kernelByName(argc >= 3 ? argv[2] : "gaussian");
+        int count = 0;
+        if (argc >= 4) {
+            count = atoi(argv[3]);
+        }
+        else {
+            std::ifstream countFile("num_images.txt");
+            countFile >> count;
+        }
+        int queueDepth = argc >= 5 ? atoi(argv[4]) : 64;
+
+        std::vector<std::string> inputPaths;
+        std::vector<std::string> outputPaths;
+        for (int i = 1; i <= count; i++) {
+            inputPaths.push_back("input" + std::to_string(i) + ".bmp");
+            outputPaths.push_back("output" + std::to_string(i) + ".bmp");
+        }
+
+        ConvolutionTester tester;
+        tester.runTestsAsync(inputPaths, outputPaths, kernel, std::max(1, queueDepth));
+        return 0;
+    }
+
+    // Provjera konvolucionih slojeva (GEMM, depthwise) prema convolution() i prema referentnoj petlji: --verify-conv-layer <ulaz.bmp> [kernel]
+    if (argc >= 3 && std::string(argv[1]) == "--verify-conv-layer") {
+        ConvolutionTester tester;
+        return tester.verifyConvLayer(argv[2], Kernel::kernelByName(argc >= 4 ? argv[3] : "gaussian")) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Provjera konvolucije sa korakom i Gausove piramide prema convolution(): --verify-strided <ulaz.bmp> [kernel]
+    if (argc >= 3 && std::string(argv[1]) == "--verify-strided") {
+        ConvolutionTester tester;
+        return tester.verifyStrided(argv[2], Kernel::kernelByName(argc >= 4 ? argv[3] : "gaussian")) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Provjera citanja i upisivanja Y4M toka (C444 i C420) kroz --stream sa identity kernelom: --verify-y4m
+    if (argc >= 2 && std::string(argv[1]) == "--verify-y4m") {
+        ConvolutionTester tester;
+        return tester.verifyY4MRoundTrip() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Gausova piramida: --pyramid <ulaz.bmp> [broj nivoa] [prefiks]; nivo i se upisuje u <prefiks>i.bmp
+    if (argc >= 3 && std::string(argv[1]) == "--pyramid") {
+        Image input = loadImage<Color>(argv[2]);
+        int levelCount = argc >= 4 ? atoi(argv[3]) : 4;
+        std::string prefix = argc >= 5 ? argv[4] : "pyramid";
+        std::vector<Image> pyramid = buildGaussianPyramid(input, std::max(1, levelCount));
+        for (size_t i = 0; i < pyramid.size(); ++i)
+            saveImage(prefix + std::to_string(i + 1) + ".bmp", pyramid[i]);
+        std::cout << "Nivoa piramide: " << pyramid.size() << std::endl;
+        return 0;
+    }
+
+    // Median filter: --median <ulaz.bmp> <izlaz.bmp> [poluprecnik] [replicate|constant|reflect]
+    if (argc >= 4 && std::string(argv[1]) == "--median") {
+        Image input = loadImage<Color>(argv[2]);
+        int radius = argc >= 5 ? atoi(argv[4]) : 1;
+        if (radius < 0 || radius > maxMedianRadius) {
+            std::cerr << "Poluprecnik median filtera mora biti izmedju 0 i " << maxMedianRadius << "." << std::endl;
+            return EXIT_FAILURE;
+        }
+        Image output(input.width, input.height);
+        medianFilter(input, radius, output, parseBorderMode(argc >= 6 ? argv[5] : "replicate"));
+        saveImage(argv[3], output);
+        return 0;
+    }
+
+    // Morfologija: --morphology <ulaz.bmp> <izlaz.bmp> [erode|dilate|open|close|gradient] [sirina] [visina] [rubovi]
+    if (argc >= 4 && std::string(argv[1]) == "--morphology") {
+        MorphologyOperation operation = MorphologyOperation::Erode;
+        if (argc >= 5 && !parseMorphologyOperation(argv[4], operation)) {
+            std::cerr << "Nepoznata morfoloska operacija: " << argv[4] << std::endl;
+            return EXIT_FAILURE;
+        }
+        int elementWidth = argc >= 6 ? atoi(argv[5]) : 3;
+        int elementHeight = argc >= 7 ? atoi(argv[6]) : elementWidth;
+        if (elementWidth < 1 || elementHeight < 1 || elementWidth % 2 == 0 || elementHeight % 2 == 0) {
+            std::cerr << "Dimenzije strukturnog elementa moraju biti neparni pozitivni brojevi." << std::endl;
+            return EXIT_FAILURE;
+        }
+        Image input = loadImage<Color>(argv[2]);
+        Image output(input.width, input.height);
+        morphology(input, operation, elementWidth, elementHeight, output, parseBorderMode(argc >= 8 ? argv[7] : "replicate"));
+        saveImage(argv[3], output);
+        return 0;
+    }
+
+    // Provjera median filtera i morfologije prema referentnim petljama i mjerenje za rastuce prozore:
+    // --median-benchmark <ulaz.bmp>, --morphology-benchmark <ulaz.bmp>
+    if (argc >= 3 && std::string(argv[1]) == "--median-benchmark") {
+        ConvolutionTester tester;
+        return tester.benchmarkMedian(argv[2]) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (argc >= 3 && std::string(argv[1]) == "--morphology-benchmark") {
+        ConvolutionTester tester;
+        return tester.benchmarkMorphology(argv[2]) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
     if (argc == 3) {
         
         // Učitavanje putanja iz argumenata komandne linije
@@ -28,15 +237,11 @@ int main(int argc, char* argv[]) {
 
         if (testing) {
 
-            // Učitavanje slike iz BMP fajla (pretpostavljamo 24-bitni nekompresovani BMP format)
-            int width = 0, height = 0;
-            std::vector<Color> pixels = loadBMP2(ulaznaPutanja, width, height);
-
-            Image inputImage(width, height);
+            // Učitavanje slike iz BMP ili QOI fajla (format se bira prema ekstenziji)
+            Image inputImage = loadImage<Color>(ulaznaPutanja);
+            int width = inputImage.width, height = inputImage.height;
             Image outputImage(width, height);
 
-            inputImage.pixels = pixels;
-
             loop = true;
 
             while (loop)
@@ -55,12 +260,12 @@ int main(int argc, char* argv[]) {
                 switch (n_for_command_line_arguments) {
 
                 case 1: {
-                    convolution(inputImage, Kernel::kernelIdentity, outputImage);
+                    cachedConvolution(inputImage, Kernel::kernelIdentity.toVector(), outputImage);
 
                     // Konvolucija koristeći OpenCV kernel
                     cv::Mat inputMat1(height, width, CV_8UC3, inputImage.pixels.data());
                     cv::Mat outputMat1;
-                    cv::Mat kernelMat1 = cv::Mat(Kernel::kernelIdentity).reshape(1, static_cast<int>(std::sqrt(Kernel::kernelIdentity.size())));
+                    cv::Mat kernelMat1 = cv::Mat(Kernel::kernelIdentity.toVector(), true).reshape(1, Kernel::kernelIdentity.size);
                     cv::filter2D(inputMat1, outputMat1, -1, kernelMat1);
                     // Čuvanje rezultata slike koristeći OpenCV kernel
                     cv::imwrite("izlaznaSlika_Identity_Kernel_opencv.bmp", outputMat1);
@@ -68,24 +273,24 @@ int main(int argc, char* argv[]) {
                     // Konvolucija koristeći optimizovanu funkciju sa SIMD instrukcijama
                     cv::Mat inputMatSimd(height, width, CV_8UC3, inputImage.pixels.data());
                     cv::Mat outputMatSimd;
-                    cv::Mat kernelMatSimd = cv::Mat(Kernel::kernelIdentity).reshape(1, static_cast<int>(std::sqrt(Kernel::kernelIdentity.size())));
+                    cv::Mat kernelMatSimd = cv::Mat(Kernel::kernelIdentity.toVector(), true).reshape(1, Kernel::kernelIdentity.size);
                     cv::filter2D(inputMatSimd, outputMatSimd, -1, kernelMatSimd, cv::Point(-1, -1), 0, cv::BORDER_CONSTANT);
                     // Čuvanje rezultata slike koristeći optimizovanu funkciju sa SIMD instrukcijama
                     cv::imwrite("izlaznaSlika_Identity_Kernel_simd.bmp", outputMatSimd);
 
                     // Čuvanje rezultata slike u BMP fajl
-                    saveBMP(izlaznaPutanja.c_str(), outputImage);
+                    saveImage(izlaznaPutanja, outputImage);
 
                     break;
                 }
 
                 case 2: {
-                    convolution(inputImage, Kernel::kernelGaussianBlur, outputImage);
+                    cachedConvolution(inputImage, Kernel::kernelGaussianBlur.toVector(), outputImage);
 
                     // Konvolucija koristeći OpenCV kernel
                     cv::Mat inputMat1(height, width, CV_8UC3, inputImage.pixels.data());
                     cv::Mat outputMat1;
-                    cv::Mat kernelMat1 = cv::Mat(Kernel::kernelGaussianBlur).reshape(1, static_cast<int>(std::sqrt(Kernel::kernelGaussianBlur.size())));
+                    cv::Mat kernelMat1 = cv::Mat(Kernel::kernelGaussianBlur.toVector(), true).reshape(1, Kernel::kernelGaussianBlur.size);
                     cv::filter2D(inputMat1, outputMat1, -1, kernelMat1);
                     // Čuvanje rezultata slike koristeći OpenCV kernel
                     cv::imwrite("izlaznaSlika_Gaussian_Blur_Kernel_opencv.bmp", outputMat1);
@@ -93,24 +298,24 @@ int main(int argc, char* argv[]) {
                     // Konvolucija koristeći optimizovanu funkciju sa SIMD instrukcijama
                     cv::Mat inputMatSimd(height, width, CV_8UC3, inputImage.pixels.data());
                     cv::Mat outputMatSimd;
-                    cv::Mat kernelMatSimd = cv::Mat(Kernel::kernelGaussianBlur).reshape(1, static_cast<int>(std::sqrt(Kernel::kernelGaussianBlur.size())));
+                    cv::Mat kernelMatSimd = cv::Mat(Kernel::kernelGaussianBlur.toVector(), true).reshape(1, Kernel::kernelGaussianBlur.size);
                     cv::filter2D(inputMatSimd, outputMatSimd, -1, kernelMatSimd, cv::Point(-1, -1), 0, cv::BORDER_CONSTANT);
                     // Čuvanje rezultata slike koristeći optimizovanu funkciju sa SIMD instrukcijama
                     cv::imwrite("izlaznaSlika_Sharpen_Kernel_simd.bmp", outputMatSimd);
 
                     // Čuvanje rezultata slike u BMP fajl
-                    saveBMP(izlaznaPutanja.c_str(), outputImage);
+                    saveImage(izlaznaPutanja, outputImage);
 
                     break;
                 }
 
                 case 3: {
-                    convolution(inputImage, Kernel::kernelEdgeDetection, outputImage);
+                    cachedConvolution(inputImage, Kernel::kernelEdgeDetection.toVector(), outputImage);
 
                     // Konvolucija koristeći OpenCV kernel
                     cv::Mat inputMat1(height, width, CV_8UC3, inputImage.pixels.data());
                     cv::Mat outputMat1;
-                    cv::Mat kernelMat1 = cv::Mat(Kernel::kernelEdgeDetection).reshape(1, static_cast<int>(std::sqrt(Kernel::kernelEdgeDetection.size())));
+                    cv::Mat kernelMat1 = cv::Mat(Kernel::kernelEdgeDetection.toVector(), true).reshape(1, Kernel::kernelEdgeDetection.size);
                     cv::filter2D(inputMat1, outputMat1, -1, kernelMat1);
                     // Čuvanje rezultata slike koristeći OpenCV kernel
                     cv::imwrite("izlaznaSlika_Edge_Detection_Kernel_opencv.bmp", outputMat1);
@@ -118,24 +323,24 @@ int main(int argc, char* argv[]) {
                     // Konvolucija koristeći optimizovanu funkciju sa SIMD instrukcijama
                     cv::Mat inputMatSimd(height, width, CV_8UC3, inputImage.pixels.data());
                     cv::Mat outputMatSimd;
-                    cv::Mat kernelMatSimd = cv::Mat(Kernel::kernelEdgeDetection).reshape(1, static_cast<int>(std::sqrt(Kernel::kernelEdgeDetection.size())));
+                    cv::Mat kernelMatSimd = cv::Mat(Kernel::kernelEdgeDetection.toVector(), true).reshape(1, Kernel::kernelEdgeDetection.size);
                     cv::filter2D(inputMatSimd, outputMatSimd, -1, kernelMatSimd, cv::Point(-1, -1), 0, cv::BORDER_CONSTANT);
                     // Čuvanje rezultata slike koristeći optimizovanu funkciju sa SIMD instrukcijama
                     cv::imwrite("izlaznaSlika_Edge_Detection_Kernel_simd.bmp", outputMatSimd);
 
                     // Čuvanje rezultata slike u BMP fajl
-                    saveBMP(izlaznaPutanja.c_str(), outputImage);
+                    saveImage(izlaznaPutanja, outputImage);
 
                     break;
                 }
 
                 case 4: {
-                    convolution(inputImage, Kernel::kernelBoxBlur, outputImage);
+                    cachedConvolution(inputImage, Kernel::kernelBoxBlur.toVector(), outputImage);
 
                     // Konvolucija koristeći OpenCV kernel
                     cv::Mat inputMat1(height, width, CV_8UC3, inputImage.pixels.data());
                     cv::Mat outputMat1;
-                    cv::Mat kernelMat1 = cv::Mat(Kernel::kernelBoxBlur).reshape(1, static_cast<int>(std::sqrt(Kernel::kernelBoxBlur.size())));
+                    cv::Mat kernelMat1 = cv::Mat(Kernel::kernelBoxBlur.toVector(), true).reshape(1, Kernel::kernelBoxBlur.size);
                     cv::filter2D(inputMat1, outputMat1, -1, kernelMat1);
                     // Čuvanje rezultata slike koristeći OpenCV kernel
                     cv::imwrite("izlaznaSlika_Box_Blur_Kernel_opencv.bmp", outputMat1);
@@ -143,24 +348,24 @@ int main(int argc, char* argv[]) {
                     // Konvolucija koristeći optimizovanu funkciju sa SIMD instrukcijama
                     cv::Mat inputMatSimd(height, width, CV_8UC3, inputImage.pixels.data());
                     cv::Mat outputMatSimd;
-                    cv::Mat kernelMatSimd = cv::Mat(Kernel::kernelBoxBlur).reshape(1, static_cast<int>(std::sqrt(Kernel::kernelBoxBlur.size())));
+                    cv::Mat kernelMatSimd = cv::Mat(Kernel::kernelBoxBlur.toVector(), true).reshape(1, Kernel::kernelBoxBlur.size);
                     cv::filter2D(inputMatSimd, outputMatSimd, -1, kernelMatSimd, cv::Point(-1, -1), 0, cv::BORDER_CONSTANT);
                     // Čuvanje rezultata slike koristeći optimizovanu funkciju sa SIMD instrukcijama
                     cv::imwrite("izlaznaSlika_Box_Blur_Kernel_simd.bmp", outputMatSimd);
 
                     // Čuvanje rezultata slike u BMP fajl
-                    saveBMP(izlaznaPutanja.c_str(), outputImage);
+                    saveImage(izlaznaPutanja, outputImage);
 
                     break;
                 }
 
                 case 5: {
-                    convolution(inputImage, Kernel::kernelSharpen, outputImage);
+                    cachedConvolution(inputImage, Kernel::kernelSharpen.toVector(), outputImage);
 
                     // Konvolucija koristeći OpenCV kernel
                     cv::Mat inputMat1(height, width, CV_8UC3, inputImage.pixels.data());
                     cv::Mat outputMat1;
-                    cv::Mat kernelMat1 = cv::Mat(Kernel::kernelSharpen).reshape(1, static_cast<int>(std::sqrt(Kernel::kernelSharpen.size())));
+                    cv::Mat kernelMat1 = cv::Mat(Kernel::kernelSharpen.toVector(), true).reshape(1, Kernel::kernelSharpen.size);
                     cv::filter2D(inputMat1, outputMat1, -1, kernelMat1);
                     // Čuvanje rezultata slike koristeći OpenCV kernel
                     cv::imwrite("izlaznaSlika_Sharpen_Kernel_opencv.bmp", outputMat1);
@@ -168,13 +373,13 @@ int main(int argc, char* argv[]) {
                     // Konvolucija koristeći optimizovanu funkciju sa SIMD instrukcijama
                     cv::Mat inputMatSimd(height, width, CV_8UC3, inputImage.pixels.data());
                     cv::Mat outputMatSimd;
-                    cv::Mat kernelMatSimd = cv::Mat(Kernel::kernelSharpen).reshape(1, static_cast<int>(std::sqrt(Kernel::kernelSharpen.size())));
+                    cv::Mat kernelMatSimd = cv::Mat(Kernel::kernelSharpen.toVector(), true).reshape(1, Kernel::kernelSharpen.size);
                     cv::filter2D(inputMatSimd, outputMatSimd, -1, kernelMatSimd, cv::Point(-1, -1), 0, cv::BORDER_CONSTANT);
                     // Čuvanje rezultata slike koristeći optimizovanu funkciju sa SIMD instrukcijama
                     cv::imwrite("izlaznaSlika_Sharpen_Kernel_simd.bmp", outputMatSimd);
 
                     // Čuvanje rezultata slike u BMP fajl
-                    saveBMP(izlaznaPutanja.c_str(), outputImage);
+                    saveImage(izlaznaPutanja, outputImage);
 
                     break;
                 }
@@ -228,6 +433,10 @@ int main(int argc, char* argv[]) {
         int n_for_kernel_choice;
         ConvolutionTester tester;
 
+        // Hardverski brojaci (IPC, promasaji u kesu) se ukljucuju promjenljivom okruzenja CONVOLUTION_PERF_COUNTERS=1
+        const char* perfCountersSetting = std::getenv("CONVOLUTION_PERF_COUNTERS");
+        tester.setHardwareCounters(perfCountersSetting && std::string(perfCountersSetting) == "1");
+
         while (loop) {
 
             std::cout << "\n\n-Odaberite Sebi Odgovarajuci Kernel-" << std::endl
@@ -245,47 +454,47 @@ int main(int argc, char* argv[]) {
 
             case 1:
                 std::cout << "Konvolucija slike koristenjem korisnicki definisane funkcije: " << std::endl;
-                tester.runTests1(inputPaths, outputPaths, kernelIdentity);
+                tester.runTests1(inputPaths, outputPaths, kernelIdentity.toVector());
                 std::cout << "Konvolucija slike koristenjem funkcije iz opecv biblioteke: " << std::endl;
-                tester.runTests2(inputPaths, outputPaths, kernelIdentity);
+                tester.runTests2(inputPaths, outputPaths, kernelIdentity.toVector());
                 std::cout << "Konvolucija slike koristenjem funkcije iz opecv(SIMD optimized) biblioteke: " << std::endl;
-                tester.runTests3(inputPaths, outputPaths, kernelIdentity);
+                tester.runTests3(inputPaths, outputPaths, kernelIdentity.toVector());
                 break;
 
             case 2:
                 std::cout << "Konvolucija slike koristenjem korisnicki definisane funkcije: " << std::endl;
-                tester.runTests1(inputPaths, outputPaths, kernelGaussianBlur);
+                tester.runTests1(inputPaths, outputPaths, kernelGaussianBlur.toVector());
                 std::cout << "Konvolucija slike koristenjem funkcije iz opecv biblioteke: " << std::endl;
-                tester.runTests2(inputPaths, outputPaths, kernelGaussianBlur);
+                tester.runTests2(inputPaths, outputPaths, kernelGaussianBlur.toVector());
                 std::cout << "Konvolucija slike koristenjem funkcije iz opecv(SIMD optimized) biblioteke: " << std::endl;
-                tester.runTests3(inputPaths, outputPaths, kernelGaussianBlur);
+                tester.runTests3(inputPaths, outputPaths, kernelGaussianBlur.toVector());
                 break;
 
             case 3:
                 std::cout << "Konvolucija slike koristenjem korisnicki definisane funkcije: " << std::endl;
-                tester.runTests1(inputPaths, outputPaths, kernelEdgeDetection);
+                tester.runTests1(inputPaths, outputPaths, kernelEdgeDetection.toVector());
                 std::cout << "Konvolucija slike koristenjem funkcije iz opecv biblioteke: " << std::endl;
-                tester.runTests2(inputPaths, outputPaths, kernelEdgeDetection);
+                tester.runTests2(inputPaths, outputPaths, kernelEdgeDetection.toVector());
                 std::cout << "Konvolucija slike koristenjem funkcije iz opecv(SIMD optimized) biblioteke: " << std::endl;
-                tester.runTests3(inputPaths, outputPaths, kernelEdgeDetection);
+                tester.runTests3(inputPaths, outputPaths, kernelEdgeDetection.toVector());
                 break;
 
             case 4:
                 std::cout << "Konvolucija slike koristenjem korisnicki definisane funkcije: " << std::endl;
-                tester.runTests1(inputPaths, outputPaths, kernelBoxBlur);
+                tester.runTests1(inputPaths, outputPaths, kernelBoxBlur.toVector());
                 std::cout << "Konvolucija slike koristenjem funkcije iz opecv biblioteke: " << std::endl;
-                tester.runTests2(inputPaths, outputPaths, kernelBoxBlur);
+                tester.runTests2(inputPaths, outputPaths, kernelBoxBlur.toVector());
                 std::cout << "Konvolucija slike koristenjem funkcije iz opecv(SIMD optimized) biblioteke: " << std::endl;
-                tester.runTests3(inputPaths, outputPaths, kernelBoxBlur);
+                tester.runTests3(inputPaths, outputPaths, kernelBoxBlur.toVector());
                 break;
 
             case 5:
                 std::cout << "Konvolucija slike koristenjem korisnicki definisane funkcije: " << std::endl;
-                tester.runTests1(inputPaths, outputPaths, kernelSharpen);
+                tester.runTests1(inputPaths, outputPaths, kernelSharpen.toVector());
                 std::cout << "Konvolucija slike koristenjem funkcije iz opecv biblioteke: " << std::endl;
-                tester.runTests2(inputPaths, outputPaths, kernelSharpen);
+                tester.runTests2(inputPaths, outputPaths, kernelSharpen.toVector());
                 std::cout << "Konvolucija slike koristenjem funkcije iz opecv(SIMD optimized) biblioteke: " << std::endl;
-                tester.runTests3(inputPaths, outputPaths, kernelSharpen);
+                tester.runTests3(inputPaths, outputPaths, kernelSharpen.toVector());
                 break;
 
             case 0:
@@ -331,7 +540,7 @@ int main(int argc, char* argv[]) {
         Image inputImage(width, height);
         Image outputImage(width, height);
 
-        inputImage.pixels = pixels;
+        inputImage.pixels.assign(pixels.begin(), pixels.end());
 
         loop = true;
         
@@ -351,7 +560,7 @@ int main(int argc, char* argv[]) {
             switch (n_for_kernel_testing){
 
             case 1: {
-                convolution(inputImage, Kernel::kernelIdentity, outputImage);
+                cachedConvolution(inputImage, Kernel::kernelIdentity.toVector(), outputImage);
                 // Čuvanje rezultata slike u BMP fajl
                 saveBMP("izlaznaSlika_Identity_Kernel_my.bmp", outputImage);
                 saveImageToFolder(outputImage, folder1, "output_image_my.bmp");
@@ -359,7 +568,7 @@ int main(int argc, char* argv[]) {
                 // Konvolucija koristeći OpenCV kernel
                 cv::Mat inputMat1(height, width, CV_8UC3, inputImage.pixels.data());
                 cv::Mat outputMat1;
-                cv::Mat kernelMat1 = cv::Mat(Kernel::kernelIdentity).reshape(1, static_cast<int>(std::sqrt(Kernel::kernelIdentity.size())));
+                cv::Mat kernelMat1 = cv::Mat(Kernel::kernelIdentity.toVector(), true).reshape(1, Kernel::kernelIdentity.size);
                 cv::filter2D(inputMat1, outputMat1, -1, kernelMat1);
                 // Čuvanje rezultata slike koristeći OpenCV kernel
                 cv::imwrite("izlaznaSlika_Identity_Kernel_opencv.bmp", outputMat1);
@@ -368,7 +577,7 @@ int main(int argc, char* argv[]) {
                 // Konvolucija koristeći optimizovanu funkciju sa SIMD instrukcijama
                 cv::Mat inputMatSimd(height, width, CV_8UC3, inputImage.pixels.data());
                 cv::Mat outputMatSimd;
-                cv::Mat kernelMatSimd = cv::Mat(Kernel::kernelIdentity).reshape(1, static_cast<int>(std::sqrt(Kernel::kernelIdentity.size())));
+                cv::Mat kernelMatSimd = cv::Mat(Kernel::kernelIdentity.toVector(), true).reshape(1, Kernel::kernelIdentity.size);
                 cv::filter2D(inputMatSimd, outputMatSimd, -1, kernelMatSimd, cv::Point(-1, -1), 0, cv::BORDER_CONSTANT);
                 // Čuvanje rezultata slike koristeći optimizovanu funkciju sa SIMD instrukcijama
                 cv::imwrite("izlaznaSlika_Identity_Kernel_simd.bmp", outputMatSimd);
@@ -378,7 +587,7 @@ int main(int argc, char* argv[]) {
             }
 
             case 2: {
-                convolution(inputImage, Kernel::kernelGaussianBlur, outputImage);
+                cachedConvolution(inputImage, Kernel::kernelGaussianBlur.toVector(), outputImage);
                 // Čuvanje rezultata slike u BMP fajl
                 saveBMP("izlaznaSlika_Gaussian_Blur_Kernel_my.bmp", outputImage);
                 saveImageToFolder(outputImage, folder4, "output_image_my.bmp");
@@ -386,7 +595,7 @@ int main(int argc, char* argv[]) {
                 // Konvolucija koristeći OpenCV kernel
                 cv::Mat inputMat1(height, width, CV_8UC3, inputImage.pixels.data());
                 cv::Mat outputMat1;
-                cv::Mat kernelMat1 = cv::Mat(Kernel::kernelGaussianBlur).reshape(1, static_cast<int>(std::sqrt(Kernel::kernelGaussianBlur.size())));
+                cv::Mat kernelMat1 = cv::Mat(Kernel::kernelGaussianBlur.toVector(), true).reshape(1, Kernel::kernelGaussianBlur.size);
                 cv::filter2D(inputMat1, outputMat1, -1, kernelMat1);
                 // Čuvanje rezultata slike koristeći OpenCV kernel
                 cv::imwrite("izlaznaSlika_Gaussian_Blur_Kernel_opencv.bmp", outputMat1);
@@ -395,7 +604,7 @@ int main(int argc, char* argv[]) {
                 // Konvolucija koristeći optimizovanu funkciju sa SIMD instrukcijama
                 cv::Mat inputMatSimd(height, width, CV_8UC3, inputImage.pixels.data());
                 cv::Mat outputMatSimd;
-                cv::Mat kernelMatSimd = cv::Mat(Kernel::kernelGaussianBlur).reshape(1, static_cast<int>(std::sqrt(Kernel::kernelGaussianBlur.size())));
+                cv::Mat kernelMatSimd = cv::Mat(Kernel::kernelGaussianBlur.toVector(), true).reshape(1, Kernel::kernelGaussianBlur.size);
                 cv::filter2D(inputMatSimd, outputMatSimd, -1, kernelMatSimd, cv::Point(-1, -1), 0, cv::BORDER_CONSTANT);
                 // Čuvanje rezultata slike koristeći optimizovanu funkciju sa SIMD instrukcijama
                 cv::imwrite("izlaznaSlika_Sharpen_Kernel_simd.bmp", outputMatSimd);
@@ -405,7 +614,7 @@ int main(int argc, char* argv[]) {
             }
             
             case 3: {
-                convolution(inputImage, Kernel::kernelEdgeDetection, outputImage);
+                cachedConvolution(inputImage, Kernel::kernelEdgeDetection.toVector(), outputImage);
                 // Čuvanje rezultata slike u BMP fajl
                 saveBMP("izlaznaSlika_Edge_Detection_Kernel_my.bmp", outputImage);
                 saveImageToFolder(outputImage, folder7, "output_image_my.bmp");
@@ -413,7 +622,7 @@ int main(int argc, char* argv[]) {
                 // Konvolucija koristeći OpenCV kernel
                 cv::Mat inputMat1(height, width, CV_8UC3, inputImage.pixels.data());
                 cv::Mat outputMat1;
-                cv::Mat kernelMat1 = cv::Mat(Kernel::kernelEdgeDetection).reshape(1, static_cast<int>(std::sqrt(Kernel::kernelEdgeDetection.size())));
+                cv::Mat kernelMat1 = cv::Mat(Kernel::kernelEdgeDetection.toVector(), true).reshape(1, Kernel::kernelEdgeDetection.size);
                 cv::filter2D(inputMat1, outputMat1, -1, kernelMat1);
                 // Čuvanje rezultata slike koristeći OpenCV kernel
                 cv::imwrite("izlaznaSlika_Edge_Detection_Kernel_opencv.bmp", outputMat1);
@@ -422,7 +631,7 @@ int main(int argc, char* argv[]) {
                 // Konvolucija koristeći optimizovanu funkciju sa SIMD instrukcijama
                 cv::Mat inputMatSimd(height, width, CV_8UC3, inputImage.pixels.data());
                 cv::Mat outputMatSimd;
-                cv::Mat kernelMatSimd = cv::Mat(Kernel::kernelEdgeDetection).reshape(1, static_cast<int>(std::sqrt(Kernel::kernelEdgeDetection.size())));
+                cv::Mat kernelMatSimd = cv::Mat(Kernel::kernelEdgeDetection.toVector(), true).reshape(1, Kernel::kernelEdgeDetection.size);
                 cv::filter2D(inputMatSimd, outputMatSimd, -1, kernelMatSimd, cv::Point(-1, -1), 0, cv::BORDER_CONSTANT);
                 // Čuvanje rezultata slike koristeći optimizovanu funkciju sa SIMD instrukcijama
                 cv::imwrite("izlaznaSlika_Edge_Detection_Kernel_simd.bmp", outputMatSimd);
@@ -432,7 +641,7 @@ int main(int argc, char* argv[]) {
             }
 
             case 4: {
-                convolution(inputImage, Kernel::kernelBoxBlur, outputImage);
+                cachedConvolution(inputImage, Kernel::kernelBoxBlur.toVector(), outputImage);
                 // Čuvanje rezultata slike u BMP fajl
                 saveBMP("izlaznaSlika_Box_Blur_kernel_my.bmp", outputImage);
                 saveImageToFolder(outputImage, folder10, "output_image_my.bmp");
@@ -440,7 +649,7 @@ int main(int argc, char* argv[]) {
                 // Konvolucija koristeći OpenCV kernel
                 cv::Mat inputMat1(height, width, CV_8UC3, inputImage.pixels.data());
                 cv::Mat outputMat1;
-                cv::Mat kernelMat1 = cv::Mat(Kernel::kernelBoxBlur).reshape(1, static_cast<int>(std::sqrt(Kernel::kernelBoxBlur.size())));
+                cv::Mat kernelMat1 = cv::Mat(Kernel::kernelBoxBlur.toVector(), true).reshape(1, Kernel::kernelBoxBlur.size);
                 cv::filter2D(inputMat1, outputMat1, -1, kernelMat1);
                 // Čuvanje rezultata slike koristeći OpenCV kernel
                 cv::imwrite("izlaznaSlika_Box_Blur_Kernel_opencv.bmp", outputMat1);
@@ -449,7 +658,7 @@ int main(int argc, char* argv[]) {
                 // Konvolucija koristeći optimizovanu funkciju sa SIMD instrukcijama
                 cv::Mat inputMatSimd(height, width, CV_8UC3, inputImage.pixels.data());
                 cv::Mat outputMatSimd;
-                cv::Mat kernelMatSimd = cv::Mat(Kernel::kernelBoxBlur).reshape(1, static_cast<int>(std::sqrt(Kernel::kernelBoxBlur.size())));
+                cv::Mat kernelMatSimd = cv::Mat(Kernel::kernelBoxBlur.toVector(), true).reshape(1, Kernel::kernelBoxBlur.size);
                 cv::filter2D(inputMatSimd, outputMatSimd, -1, kernelMatSimd, cv::Point(-1, -1), 0, cv::BORDER_CONSTANT);
                 // Čuvanje rezultata slike koristeći optimizovanu funkciju sa SIMD instrukcijama
                 cv::imwrite("izlaznaSlika_Box_Blur_Kernel_simd.bmp", outputMatSimd);
@@ -459,7 +668,7 @@ int main(int argc, char* argv[]) {
             }
 
             case 5: {
-                convolution(inputImage, Kernel::kernelSharpen, outputImage);
+                cachedConvolution(inputImage, Kernel::kernelSharpen.toVector(), outputImage);
                 // Čuvanje rezultata slike u BMP fajl
                 saveBMP("izlaznaSlika_Sharpen_Kernel_my.bmp", outputImage);
                 saveImageToFolder(outputImage, folder13, "output_image_my.bmp");
@@ -467,7 +676,7 @@ int main(int argc, char* argv[]) {
                 // Konvolucija koristeći OpenCV kernel
                 cv::Mat inputMat1(height, width, CV_8UC3, inputImage.pixels.data());
                 cv::Mat outputMat1;
-                cv::Mat kernelMat1 = cv::Mat(Kernel::kernelSharpen).reshape(1, static_cast<int>(std::sqrt(Kernel::kernelSharpen.size())));
+                cv::Mat kernelMat1 = cv::Mat(Kernel::kernelSharpen.toVector(), true).reshape(1, Kernel::kernelSharpen.size);
                 cv::filter2D(inputMat1, outputMat1, -1, kernelMat1);
                 // Čuvanje rezultata slike koristeći OpenCV kernel
                 cv::imwrite("izlaznaSlika_Sharpen_Kernel_opencv.bmp", outputMat1);
@@ -476,7 +685,7 @@ int main(int argc, char* argv[]) {
                 // Konvolucija koristeći optimizovanu funkciju sa SIMD instrukcijama
                 cv::Mat inputMatSimd(height, width, CV_8UC3, inputImage.pixels.data());
                 cv::Mat outputMatSimd;
-                cv::Mat kernelMatSimd = cv::Mat(Kernel::kernelSharpen).reshape(1, static_cast<int>(std::sqrt(Kernel::kernelSharpen.size())));
+                cv::Mat kernelMatSimd = cv::Mat(Kernel::kernelSharpen.toVector(), true).reshape(1, Kernel::kernelSharpen.size);
                 cv::filter2D(inputMatSimd, outputMatSimd, -1, kernelMatSimd, cv::Point(-1, -1), 0, cv::BORDER_CONSTANT);
                 // Čuvanje rezultata slike koristeći optimizovanu funkciju sa SIMD instrukcijama
                 cv::imwrite("izlaznaSlika_Sharpen_Kernel_simd.bmp", outputMatSimd);
@@ -497,5 +706,10 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    // Statistika kesa rezultata (ako je ukljucen i koristen)
+    if (ResultCache* cache = ResultCache::fromEnvironment())
+        if (cache->hits() + cache->misses() > 0)
+            cache->printStats(std::cout);
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,244 @@
+#include "medianFilter.h"
+#include "tracing.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+
+    /*
+        Histogram jedne kolone za jedan kanal u dva nivoa: 16 grubih korpi (gornja 4 bita vrijednosti) i 256 finih korpi,
+        pri cemu finih 16 korpi svake grube korpe stoje jedna do druge (blok od 32 bajta).
+        Brojaci su 16-bitni, pa se sabiranje i oduzimanje bloka prevodi u vektorske instrukcije
+        (16 vrijednosti po AVX2 instrukciji); prozor ima najvise 255 * 255 piksela, sto staje u 16 bita.
+    */
+    struct Histogram {
+        uint16_t coarse[16];
+        uint16_t fine[256];
+    };
+
+    /*
+        Histogram prozora za jedan kanal. Grubi nivo se azurira za svaki piksel (16 sabiranja i 16 oduzimanja),
+        a fini nivo se drzi odvojeno za svaku grubu korpu i azurira se tek kada median padne u tu korpu:
+        `updated[b]` je kolona x za koju fini blok b vazi. Median se sporo mijenja duz reda,
+        pa se u prosjeku azurira jedan blok od 16 korpi po pikselu (Perreault i Hebert, odjeljak 3.2),
+        umjesto svih 256 finih korpi.
+    */
+    struct WindowHistogram {
+        uint16_t coarse[16];
+        uint16_t fine[256];
+        int updated[16];
+    };
+
+    inline void addCoarse(WindowHistogram& to, const Histogram& from) {
+        for (int i = 0; i < 16; ++i)
+            to.coarse[i] += from.coarse[i];
+    }
+
+    inline void subtractCoarse(WindowHistogram& to, const Histogram& from) {
+        for (int i = 0; i < 16; ++i)
+            to.coarse[i] -= from.coarse[i];
+    }
+
+    inline void addFine(uint16_t* to, const Histogram& from, int bucket) {
+        const uint16_t* block = &from.fine[bucket * 16];
+        for (int i = 0; i < 16; ++i)
+            to[i] += block[i];
+    }
+
+    inline void subtractFine(uint16_t* to, const Histogram& from, int bucket) {
+        const uint16_t* block = &from.fine[bucket * 16];
+        for (int i = 0; i < 16; ++i)
+            to[i] -= block[i];
+    }
+
+    inline void addValue(Histogram& histogram, uint8_t value) {
+        ++histogram.coarse[value >> 4];
+        ++histogram.fine[value];
+    }
+
+    inline void removeValue(Histogram& histogram, uint8_t value) {
+        --histogram.coarse[value >> 4];
+        --histogram.fine[value];
+    }
+
+    /*
+        Trazenje vrijednosti ranga `rank` u prozoru kolone x: prvo gruba korpa (najvise 16 koraka),
+        pa se fini blok te korpe dovodi do kolone x i u njemu trazi vrijednost (najvise 16 koraka).
+        Blok koji je zaostao vise od sirine prozora se racuna iznova iz kolona prozora, sto nije skuplje od pomjeranja.
+        `column(i)` je histogram i-te kolone prozora sa pocetkom u koloni 0 (kolona x prozora je column(x + i)).
+    */
+    template <typename Column>
+    inline uint8_t findRank(WindowHistogram& histogram, int rank, int x, int window, Column column) {
+        int bucket = 0;
+        int count = 0;
+        while (count + histogram.coarse[bucket] <= rank)
+            count += histogram.coarse[bucket++];
+
+        uint16_t* fine = &histogram.fine[bucket * 16];
+        int updated = histogram.updated[bucket];
+        if (x - updated > window) {
+            memset(fine, 0, 16 * sizeof(uint16_t));
+            for (int i = 0; i < window; ++i)
+                addFine(fine, column(x + i), bucket);
+        }
+        else {
+            for (int next = updated + 1; next <= x; ++next) {
+                addFine(fine, column(next + window - 1), bucket);
+                subtractFine(fine, column(next - 1), bucket);
+            }
+        }
+        histogram.updated[bucket] = x;
+
+        int value = 0;
+        while (count + fine[value] <= rank)
+            count += fine[value++];
+        return static_cast<uint8_t>(bucket * 16 + value);
+    }
+
+    // Vrijednost kanala piksela u redu `row` i koloni `x`; red -1 znaci red van slike za BorderMode::Constant (crni piksel)
+    template <typename PixelT>
+    inline uint8_t channelValue(const PixelT* row, int x, int c) {
+        return row == nullptr ? 0 : reinterpret_cast<const uint8_t*>(&row[x])[c];
+    }
+
+    /*
+        Obrada jednog pojasa redova [firstRow, lastRow).
+        Za svaku kolonu slike se drzi histogram kolone visine 2r + 1 (po kanalu). Prelaskom u sljedeci red
+        iz histograma kolone se uklanja gornji piksel i dodaje novi donji (2 operacije po koloni).
+        Grubi histogram prozora se pomjera udesno dodavanjem kolone koja ulazi i oduzimanjem one koja izlazi,
+        a fini samo za grubu korpu u kojoj je median (vidi WindowHistogram),
+        pa je posao po pikselu konstantan i ne zavisi od poluprecnika.
+        Kolone van slike su histogrami rubnih kolona (Replicate, Reflect) ili posebna "crna" kolona (Constant).
+    */
+    template <typename PixelT>
+    void medianBand(const BasicImage<PixelT>& input, int radius, BasicImage<PixelT>& output, BorderMode border, int firstRow, int lastRow) {
+        const int channels = PixelTraits<PixelT>::channels;
+        const int width = input.width;
+        const int height = input.height;
+        const int window = 2 * radius + 1;
+        const int rank = window * window / 2;
+
+        // Kolona `width` je crna kolona za BorderMode::Constant
+        std::vector<Histogram> columns(static_cast<size_t>(width + 1) * channels);
+        memset(columns.data(), 0, columns.size() * sizeof(Histogram));
+        for (int c = 0; c < channels; ++c) {
+            Histogram& black = columns[static_cast<size_t>(width) * channels + c];
+            black.coarse[0] = static_cast<uint16_t>(window);
+            black.fine[0] = static_cast<uint16_t>(window);
+        }
+
+        auto rowPointer = [&](int y) -> const PixelT* {
+            int sourceY = borderIndex(y, height, border);
+            return sourceY < 0 ? nullptr : &input.pixels[static_cast<size_t>(sourceY) * width];
+        };
+
+        for (int dy = -radius; dy <= radius; ++dy) {
+            const PixelT* row = rowPointer(firstRow + dy);
+            for (int x = 0; x < width; ++x)
+                for (int c = 0; c < channels; ++c)
+                    addValue(columns[static_cast<size_t>(x) * channels + c], channelValue(row, x, c));
+        }
+
+        std::vector<int> columnIndex(width + 2 * radius + 1);
+        for (int i = 0; i < static_cast<int>(columnIndex.size()); ++i) {
+            int sourceX = borderIndex(i - radius, width, border);
+            columnIndex[i] = sourceX < 0 ? width : sourceX;
+        }
+
+        WindowHistogram kernel[channels];
+        for (int y = firstRow; y < lastRow; ++y) {
+            if (y > firstRow) {
+                const PixelT* removed = rowPointer(y - radius - 1);
+                const PixelT* added = rowPointer(y + radius);
+                for (int x = 0; x < width; ++x) {
+                    for (int c = 0; c < channels; ++c) {
+                        Histogram& column = columns[static_cast<size_t>(x) * channels + c];
+                        removeValue(column, channelValue(removed, x, c));
+                        addValue(column, channelValue(added, x, c));
+                    }
+                }
+            }
+
+            // Na pocetku reda fini blokovi nisu izracunati, pa se racunaju iznova kada zatrebaju
+            memset(kernel, 0, sizeof(kernel));
+            for (int c = 0; c < channels; ++c) {
+                std::fill(kernel[c].updated, kernel[c].updated + 16, -window - 1);
+                for (int i = 0; i < window; ++i)
+                    addCoarse(kernel[c], columns[static_cast<size_t>(columnIndex[i]) * channels + c]);
+            }
+
+            PixelT* result = &output.pixels[static_cast<size_t>(y) * width];
+            for (int x = 0; x < width; ++x) {
+                uint8_t* bytes = reinterpret_cast<uint8_t*>(&result[x]);
+                for (int c = 0; c < channels; ++c) {
+                    auto column = [&](int i) -> const Histogram& {
+                        return columns[static_cast<size_t>(columnIndex[i]) * channels + c];
+                    };
+                    bytes[c] = findRank(kernel[c], rank, x, window, column);
+                }
+
+                if (x + 1 < width) {
+                    const Histogram* entering = &columns[static_cast<size_t>(columnIndex[x + window]) * channels];
+                    const Histogram* leaving = &columns[static_cast<size_t>(columnIndex[x]) * channels];
+                    for (int c = 0; c < channels; ++c) {
+                        addCoarse(kernel[c], entering[c]);
+                        subtractCoarse(kernel[c], leaving[c]);
+                    }
+                }
+            }
+        }
+    }
+
+    /*
+        Slika se dijeli na horizontalne pojaseve, po jedan za svaku nit; svaki pojas ima svoje histograme kolona,
+        pa niti ne dijele podatke koji se mijenjaju. Pocetni histogrami kolona pojasa kostaju O(r) po koloni,
+        sto je zanemarljivo kada je pojas mnogo visi od prozora.
+    */
+    template <typename PixelT>
+    void medianCore(const BasicImage<PixelT>& input, int radius, BasicImage<PixelT>& output, BorderMode border) {
+        TRACE_SCOPE("medianFilter");
+        TRACE_PIXELS(static_cast<long long>(input.width) * input.height);
+
+        if (radius < 0 || radius > maxMedianRadius) {
+            std::cerr << "Poluprecnik median filtera mora biti izmedju 0 i " << maxMedianRadius << "." << std::endl;
+            return;
+        }
+
+        int bandCount = 1;
+#ifdef _OPENMP
+        bandCount = omp_get_max_threads();
+#endif
+        bandCount = std::max(1, std::min(bandCount, input.height));
+        int bandHeight = (input.height + bandCount - 1) / bandCount;
+
+        TRACE_PARALLEL_REGION("medianFilter");
+#pragma omp parallel
+        {
+            TRACE_THREAD_BUSY();
+#pragma omp for schedule(static, 1) nowait
+            for (int band = 0; band < bandCount; ++band) {
+                int firstRow = band * bandHeight;
+                int lastRow = std::min(input.height, firstRow + bandHeight);
+                if (firstRow < lastRow)
+                    medianBand(input, radius, output, border, firstRow, lastRow);
+            }
+        }
+    }
+}
+
+void medianFilter(const Image& input, int radius, Image& output, BorderMode border) {
+    medianCore(input, radius, output, border);
+}
+
+void medianFilter(const GrayImage& input, int radius, GrayImage& output, BorderMode border) {
+    medianCore(input, radius, output, border);
+}
+
+void medianFilter(const ImageBGRA& input, int radius, ImageBGRA& output, BorderMode border) {
+    medianCore(input, radius, output, border);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "image.h"
+#include "convolution.h"
+
+/*
+    Median filter sa kvadratnim prozorom (2 * radius + 1) x (2 * radius + 1), za uklanjanje "so i biber" suma.
+    Vrijeme po pikselu ne zavisi od poluprecnika (Perreault i Hebert, "Median Filtering in Constant Time"),
+    pa je i radius 10 samo malo sporiji od radius 1. Svaki kanal se filtrira nezavisno.
+    Pikseli van slike se odredjuju kao kod konvolucije (BorderMode). Najveci podrzani poluprecnik je 127.
+*/
+void medianFilter(const Image& , int , Image& , BorderMode = BorderMode::Replicate);
+
+void medianFilter(const GrayImage& , int , GrayImage& , BorderMode = BorderMode::Replicate);
+
+void medianFilter(const ImageBGRA& , int , ImageBGRA& , BorderMode = BorderMode::Replicate);
+
+const int maxMedianRadius = 127;
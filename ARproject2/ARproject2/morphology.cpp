@@ -0,0 +1,351 @@
+#include "morphology.h"
+#include "tracing.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MORPHOLOGY_SSE
+#endif
+
+namespace {
+
+#ifdef MORPHOLOGY_SSE
+    // Isti bajt 16 redova trake (element transponovanog reda); u strukturi, jer std::vector<__m128i> gubi atribute tipa
+    struct Lane {
+        __m128i bytes;
+    };
+#endif
+
+    struct MinOp {
+        static uint8_t apply(uint8_t a, uint8_t b) { return a < b ? a : b; }
+#ifdef MORPHOLOGY_SSE
+        static __m128i apply(__m128i a, __m128i b) { return _mm_min_epu8(a, b); }
+        static Lane apply(Lane a, Lane b) { return { _mm_min_epu8(a.bytes, b.bytes) }; }
+#endif
+    };
+
+    struct MaxOp {
+        static uint8_t apply(uint8_t a, uint8_t b) { return a > b ? a : b; }
+#ifdef MORPHOLOGY_SSE
+        static __m128i apply(__m128i a, __m128i b) { return _mm_max_epu8(a, b); }
+        static Lane apply(Lane a, Lane b) { return { _mm_max_epu8(a.bytes, b.bytes) }; }
+#endif
+    };
+
+    // out[i] = op(a[i], b[i]) za `count` bajtova, 16 bajtova po SSE instrukciji (out moze biti isto sto i a ili b)
+    template <typename Op>
+    inline void combine(const uint8_t* a, const uint8_t* b, uint8_t* out, size_t count) {
+        size_t i = 0;
+#ifdef MORPHOLOGY_SSE
+        for (; i + 16 <= count; i += 16) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), Op::apply(x, y));
+        }
+#endif
+        for (; i < count; ++i)
+            out[i] = Op::apply(a[i], b[i]);
+    }
+
+    // Red prosiren za r = size / 2 piksela sa obje strane: unutrasnjost se kopira, a rubno pravilo vazi samo za r piksela
+    template <typename PixelT>
+    void padRow(const PixelT* source, int width, int size, BorderMode border, uint8_t* padded) {
+        const int channels = PixelTraits<PixelT>::channels;
+        const int radius = size / 2;
+        const int length = width + size - 1;
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(source);
+
+        memcpy(padded + static_cast<size_t>(radius) * channels, bytes, static_cast<size_t>(width) * channels);
+        auto padPixel = [&](int i) {
+            int sourceX = borderIndex(i - radius, width, border);
+            for (int c = 0; c < channels; ++c)
+                padded[static_cast<size_t>(i) * channels + c] = sourceX < 0 ? 0 : bytes[static_cast<size_t>(sourceX) * channels + c];
+        };
+        for (int i = 0; i < radius; ++i)
+            padPixel(i);
+        for (int i = radius + width; i < length; ++i)
+            padPixel(i);
+    }
+
+    /*
+        van Herk / Gil-Werman nad prosirenim redom od `length` piksela sa `channels` elemenata po pikselu.
+        Red se dijeli na blokove od `size` piksela; unutar bloka se racuna minimum/maksimum od pocetka bloka (prefix)
+        i od kraja bloka (suffix). Prozor [x, x + size - 1] pokriva kraj jednog i pocetak sljedeceg bloka,
+        pa je rezultat op(suffix[x], prefix[x + size - 1]), upisan u suffix: 3 poredjenja po elementu,
+        bez obzira na velicinu prozora. Element je bajt (jedan red) ili Lane (isti bajt 16 redova).
+    */
+    template <typename Op, typename T>
+    void vanHerk(const T* padded, int length, int width, int size, int channels, T* prefix, T* suffix) {
+        for (int block = 0; block < length; block += size) {
+            const size_t first = static_cast<size_t>(block) * channels;
+            const size_t last = static_cast<size_t>(std::min(length, block + size)) * channels;
+            for (size_t j = first; j < first + channels; ++j)
+                prefix[j] = padded[j];
+            for (size_t j = first + channels; j < last; ++j)
+                prefix[j] = Op::apply(prefix[j - channels], padded[j]);
+            for (size_t j = last - channels; j < last; ++j)
+                suffix[j] = padded[j];
+            for (size_t j = last - channels; j-- > first; )
+                suffix[j] = Op::apply(suffix[j + channels], padded[j]);
+        }
+
+        const size_t shift = static_cast<size_t>(size - 1) * channels;
+        for (size_t j = 0; j < static_cast<size_t>(width) * channels; ++j)
+            suffix[j] = Op::apply(suffix[j], prefix[j + shift]);
+    }
+
+#ifdef MORPHOLOGY_SSE
+    const int bandRows = 16;
+
+    /*
+        Transponovanje bloka 16x16 bajtova sa cetiri nivoa raspakivanja (8, 16, 32 i 64 bita):
+        columns[j] sadrzi bajt j svih 16 redova (red i u bajtu i). Mreza daje kolone obrnutim redoslijedom bita indeksa.
+        Transponovanje je samo sebi inverzno, pa ista funkcija vraca kolone u redove.
+    */
+    inline void transpose16(const __m128i rows[16], __m128i columns[16]) {
+        static const int bitReversed[16] = { 0, 8, 4, 12, 2, 10, 6, 14, 1, 9, 5, 13, 3, 11, 7, 15 };
+        __m128i a[16], b[16];
+        for (int i = 0; i < 8; ++i) {
+            a[i] = _mm_unpacklo_epi8(rows[2 * i], rows[2 * i + 1]);
+            a[i + 8] = _mm_unpackhi_epi8(rows[2 * i], rows[2 * i + 1]);
+        }
+        for (int i = 0; i < 8; ++i) {
+            b[i] = _mm_unpacklo_epi16(a[2 * i], a[2 * i + 1]);
+            b[i + 8] = _mm_unpackhi_epi16(a[2 * i], a[2 * i + 1]);
+        }
+        for (int i = 0; i < 8; ++i) {
+            a[i] = _mm_unpacklo_epi32(b[2 * i], b[2 * i + 1]);
+            a[i + 8] = _mm_unpackhi_epi32(b[2 * i], b[2 * i + 1]);
+        }
+        for (int i = 0; i < 8; ++i) {
+            columns[bitReversed[i]] = _mm_unpacklo_epi64(a[2 * i], a[2 * i + 1]);
+            columns[bitReversed[i + 8]] = _mm_unpackhi_epi64(a[2 * i], a[2 * i + 1]);
+        }
+    }
+
+    /*
+        Horizontalni prolaz za traku od najvise 16 redova [first, first + rowCount). Prefix i suffix zavise od
+        susjednog piksela istog reda, pa se unutar reda ne mogu vektorizovati; zato se prosireni redovi trake
+        transponuju (blokovi 16x16 bajtova), tako da je element j jedan SSE vektor sa bajtom j svih 16 redova,
+        van Herk se racuna nad vektorima (16 redova po instrukciji), a rezultat se transponuje nazad u redove.
+        Redovi trake iza posljednjeg (rowCount < 16) se popunjavaju kopijom posljednjeg reda i ne upisuju se.
+    */
+    template <typename Op, typename PixelT>
+    void horizontalBand(const BasicImage<PixelT>& input, int first, int rowCount, int size, BorderMode border,
+        BasicImage<PixelT>& output, std::vector<uint8_t>& padded, std::vector<Lane>& lanes,
+        std::vector<Lane>& prefix, std::vector<Lane>& suffix) {
+        const int channels = PixelTraits<PixelT>::channels;
+        const int width = input.width;
+        const int length = width + size - 1;
+        const size_t stride = lanes.size();  // prosireni red zaokruzen na 16 bajtova
+        const size_t rowBytes = static_cast<size_t>(width) * channels;
+
+        for (int r = 0; r < bandRows; ++r) {
+            int y = first + std::min(r, rowCount - 1);
+            padRow(&input.pixels[static_cast<size_t>(y) * width], width, size, border, &padded[r * stride]);
+        }
+
+        __m128i rows[bandRows], columns[16];
+        for (size_t block = 0; block < stride; block += 16) {
+            for (int r = 0; r < bandRows; ++r)
+                rows[r] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&padded[r * stride + block]));
+            transpose16(rows, columns);
+            for (int j = 0; j < 16; ++j)
+                lanes[block + j].bytes = columns[j];
+        }
+
+        vanHerk<Op>(lanes.data(), length, width, size, channels, prefix.data(), suffix.data());
+
+        for (size_t block = 0; block < rowBytes; block += 16) {
+            for (int j = 0; j < 16; ++j)
+                columns[j] = suffix[block + j].bytes;
+            transpose16(columns, rows);
+            const size_t count = std::min<size_t>(16, rowBytes - block);
+            for (int r = 0; r < rowCount; ++r) {
+                uint8_t* target = reinterpret_cast<uint8_t*>(&output.pixels[static_cast<size_t>(first + r) * width]) + block;
+                if (count == 16)
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(target), rows[r]);
+                else {
+                    alignas(16) uint8_t tail[16];
+                    _mm_store_si128(reinterpret_cast<__m128i*>(tail), rows[r]);
+                    memcpy(target, tail, count);
+                }
+            }
+        }
+    }
+#else
+    // Horizontalni prolaz za jedan red bez SSE2: van Herk nad bajtovima reda
+    template <typename Op, typename PixelT>
+    void horizontalRow(const PixelT* source, int width, int size, BorderMode border, PixelT* target,
+        std::vector<uint8_t>& padded, std::vector<uint8_t>& prefix, std::vector<uint8_t>& suffix) {
+        const int channels = PixelTraits<PixelT>::channels;
+        padRow(source, width, size, border, padded.data());
+        vanHerk<Op>(padded.data(), width + size - 1, width, size, channels, prefix.data(), suffix.data());
+        memcpy(target, suffix.data(), static_cast<size_t>(width) * channels);
+    }
+#endif
+
+    /*
+        Vertikalni prolaz za grupu od najvise `size` izlaznih redova [first, last), isti algoritam kao horizontalni,
+        ali su elementi cijeli redovi: svaka operacija se radi nad svim bajtovima reda odjednom (vektorski).
+        Prozori redova grupe pocinju u bloku A = redovi [first - r, first - r + size) i zavrsavaju u bloku B iza njega.
+        Za blok A se racuna suffix (size redova), a za blok B prefix se racuna u hodu, u jednom redu,
+        pa je za grupu potrebno size + 1 redova memorije umjesto kopije cijele slike.
+    */
+    template <typename Op, typename PixelT>
+    void verticalGroup(const BasicImage<PixelT>& input, int size, BorderMode border, BasicImage<PixelT>& output, int first, int last,
+        std::vector<uint8_t>& suffix, std::vector<uint8_t>& running, const std::vector<uint8_t>& zeroRow) {
+        const int width = input.width;
+        const int height = input.height;
+        const size_t rowBytes = static_cast<size_t>(width) * sizeof(PixelT);
+        const int start = first - size / 2;
+
+        auto row = [&](int y) -> const uint8_t* {
+            int sourceY = borderIndex(y, height, border);
+            return sourceY < 0 ? zeroRow.data() : reinterpret_cast<const uint8_t*>(&input.pixels[static_cast<size_t>(sourceY) * width]);
+        };
+
+        memcpy(&suffix[static_cast<size_t>(size - 1) * rowBytes], row(start + size - 1), rowBytes);
+        for (int i = size - 2; i >= 0; --i)
+            combine<Op>(&suffix[static_cast<size_t>(i + 1) * rowBytes], row(start + i), &suffix[static_cast<size_t>(i) * rowBytes], rowBytes);
+
+        uint8_t* target = reinterpret_cast<uint8_t*>(&output.pixels[static_cast<size_t>(first) * width]);
+        memcpy(target, suffix.data(), rowBytes);
+        if (last - first > 1)
+            memcpy(running.data(), row(start + size), rowBytes);
+        for (int j = 1; j < last - first; ++j) {
+            combine<Op>(&suffix[static_cast<size_t>(j) * rowBytes], running.data(), target + j * rowBytes, rowBytes);
+            if (j + 1 < last - first)
+                combine<Op>(running.data(), row(start + size + j), running.data(), rowBytes);
+        }
+    }
+
+    /*
+        Erozija ili dilatacija: pravougaoni element je proizvod reda i kolone, pa se radi horizontalni prolaz
+        u medjurezultat, pa vertikalni prolaz u izlaz. Rubna pravila vaze za svaku osu posebno, kao kod konvolucije,
+        pa je rezultat isti kao minimum/maksimum nad cijelim prozorom. Horizontalni prolaz dijeli sliku nitima
+        po trakama od 16 redova (sa SSE2), a vertikalni na grupe od `elementHeight` redova, statickim rasporedom.
+    */
+    template <typename Op, typename PixelT>
+    void rankFilter(const BasicImage<PixelT>& input, int elementWidth, int elementHeight, BasicImage<PixelT>& output, BorderMode border) {
+        const int width = input.width;
+        const int height = input.height;
+        const int channels = PixelTraits<PixelT>::channels;
+        BasicImage<PixelT> horizontal(width, height);
+        std::vector<uint8_t> zeroRow(static_cast<size_t>(width) * sizeof(PixelT), 0);
+        int groups = (height + elementHeight - 1) / elementHeight;
+
+        TRACE_PARALLEL_REGION("morphology");
+#pragma omp parallel
+        {
+            TRACE_THREAD_BUSY();
+            size_t paddedBytes = static_cast<size_t>(width + elementWidth - 1) * channels;
+#ifdef MORPHOLOGY_SSE
+            // Traka od 16 redova: prosireni redovi i njihovi transponovani elementi (van Herk nad vektorima)
+            size_t stride = (paddedBytes + 15) / 16 * 16;
+            std::vector<uint8_t> padded(bandRows * stride);
+            std::vector<Lane> lanes(stride), prefix(stride), suffix(stride);
+            int bands = (height + bandRows - 1) / bandRows;
+
+#pragma omp for schedule(static)
+            for (int band = 0; band < bands; ++band) {
+                int first = band * bandRows;
+                horizontalBand<Op>(input, first, std::min(bandRows, height - first), elementWidth, border, horizontal,
+                    padded, lanes, prefix, suffix);
+            }
+#else
+            std::vector<uint8_t> padded(paddedBytes), prefix(paddedBytes), suffix(paddedBytes);
+
+#pragma omp for schedule(static)
+            for (int y = 0; y < height; ++y) {
+                horizontalRow<Op>(&input.pixels[static_cast<size_t>(y) * width], width, elementWidth, border,
+                    &horizontal.pixels[static_cast<size_t>(y) * width], padded, prefix, suffix);
+            }
+#endif
+
+            std::vector<uint8_t> rows(static_cast<size_t>(elementHeight) * width * sizeof(PixelT));
+            std::vector<uint8_t> running(static_cast<size_t>(width) * sizeof(PixelT));
+
+#pragma omp for schedule(static) nowait
+            for (int group = 0; group < groups; ++group) {
+                int first = group * elementHeight;
+                verticalGroup<Op>(horizontal, elementHeight, border, output, first, std::min(height, first + elementHeight), rows, running, zeroRow);
+            }
+        }
+    }
+
+    template <typename PixelT>
+    void morphologyCore(const BasicImage<PixelT>& input, MorphologyOperation operation, int elementWidth, int elementHeight,
+        BasicImage<PixelT>& output, BorderMode border) {
+        TRACE_SCOPE("morphology");
+        TRACE_PIXELS(static_cast<long long>(input.width) * input.height);
+
+        if (elementWidth < 1 || elementHeight < 1 || elementWidth % 2 == 0 || elementHeight % 2 == 0) {
+            std::cerr << "Dimenzije strukturnog elementa moraju biti neparni pozitivni brojevi." << std::endl;
+            return;
+        }
+        if (input.width == 0 || input.height == 0)
+            return;
+
+        switch (operation) {
+        case MorphologyOperation::Erode:
+            rankFilter<MinOp>(input, elementWidth, elementHeight, output, border);
+            break;
+        case MorphologyOperation::Dilate:
+            rankFilter<MaxOp>(input, elementWidth, elementHeight, output, border);
+            break;
+        case MorphologyOperation::Open: {
+            BasicImage<PixelT> eroded(input.width, input.height);
+            rankFilter<MinOp>(input, elementWidth, elementHeight, eroded, border);
+            rankFilter<MaxOp>(eroded, elementWidth, elementHeight, output, border);
+            break;
+        }
+        case MorphologyOperation::Close: {
+            BasicImage<PixelT> dilated(input.width, input.height);
+            rankFilter<MaxOp>(input, elementWidth, elementHeight, dilated, border);
+            rankFilter<MinOp>(dilated, elementWidth, elementHeight, output, border);
+            break;
+        }
+        case MorphologyOperation::Gradient: {
+            // Dilatacija je uvijek >= erozije, pa razlika ne moze biti negativna
+            BasicImage<PixelT> eroded(input.width, input.height);
+            rankFilter<MinOp>(input, elementWidth, elementHeight, eroded, border);
+            rankFilter<MaxOp>(input, elementWidth, elementHeight, output, border);
+            uint8_t* target = reinterpret_cast<uint8_t*>(output.pixels.data());
+            const uint8_t* subtrahend = reinterpret_cast<const uint8_t*>(eroded.pixels.data());
+            long long count = static_cast<long long>(output.pixels.size()) * sizeof(PixelT);
+#pragma omp parallel for schedule(static)
+            for (long long i = 0; i < count; ++i)
+                target[i] = static_cast<uint8_t>(target[i] - subtrahend[i]);
+            break;
+        }
+        }
+    }
+}
+
+void morphology(const Image& input, MorphologyOperation operation, int elementWidth, int elementHeight, Image& output, BorderMode border) {
+    morphologyCore(input, operation, elementWidth, elementHeight, output, border);
+}
+
+void morphology(const GrayImage& input, MorphologyOperation operation, int elementWidth, int elementHeight, GrayImage& output, BorderMode border) {
+    morphologyCore(input, operation, elementWidth, elementHeight, output, border);
+}
+
+void morphology(const ImageBGRA& input, MorphologyOperation operation, int elementWidth, int elementHeight, ImageBGRA& output, BorderMode border) {
+    morphologyCore(input, operation, elementWidth, elementHeight, output, border);
+}
+
+bool parseMorphologyOperation(const std::string& name, MorphologyOperation& operation) {
+    const char* names[5] = { "erode", "dilate", "open", "close", "gradient" };
+    const MorphologyOperation operations[5] = { MorphologyOperation::Erode, MorphologyOperation::Dilate,
+        MorphologyOperation::Open, MorphologyOperation::Close, MorphologyOperation::Gradient };
+    for (int i = 0; i < 5; ++i) {
+        if (name == names[i]) {
+            operation = operations[i];
+            return true;
+        }
+    }
+    return false;
+}
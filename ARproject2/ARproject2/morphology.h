@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include "image.h"
+#include "convolution.h"
+
+// Morfoloske operacije sa pravougaonim strukturnim elementom
+enum class MorphologyOperation {
+    Erode,      // minimum nad prozorom
+    Dilate,     // maksimum nad prozorom
+    Open,       // erozija pa dilatacija: uklanja svijetle detalje manje od elementa
+    Close,      // dilatacija pa erozija: popunjava tamne rupe manje od elementa
+    Gradient    // dilatacija - erozija: ivice oblika
+};
+
+/*
+    Morfologija sa pravougaonim strukturnim elementom sirine x visine (neparne dimenzije, centar je sidro),
+    za sive slike (npr. maske) i po kanalu za slike u boji. Koristi se van Herk / Gil-Werman algoritam,
+    pa je posao po pikselu (oko 3 poredjenja po prolazu) isti za element 3x3 i 51x51.
+    Pikseli van slike se odredjuju kao kod konvolucije (BorderMode); kod BorderMode::Constant su crni (0).
+*/
+void morphology(const Image& , MorphologyOperation , int , int , Image& , BorderMode = BorderMode::Replicate);
+
+void morphology(const GrayImage& , MorphologyOperation , int , int , GrayImage& , BorderMode = BorderMode::Replicate);
+
+void morphology(const ImageBGRA& , MorphologyOperation , int , int , ImageBGRA& , BorderMode = BorderMode::Replicate);
+
+// Naziv operacije (erode, dilate, open, close, gradient) u MorphologyOperation; false za nepoznat naziv
+bool parseMorphologyOperation(const std::string& , MorphologyOperation& );
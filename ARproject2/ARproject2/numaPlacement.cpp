@@ -0,0 +1,362 @@
+#include "numaPlacement.h"
+#include "image.h"
+#include "tracing.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    // Ispod ove velicine (u bajtovima) pokretanje paralelnog regiona traje duze od samog punjenja
+    const size_t parallelTouchBytes = 1 << 22;
+
+    std::vector<int> pinnedNodes;
+
+    // Lista procesora u formatu sysfs-a, npr. "0-3,8-11"
+    std::vector<int> parseCpuList(const std::string& text) {
+        std::vector<int> cpus;
+        std::stringstream list(text);
+        std::string range;
+        while (std::getline(list, range, ',')) {
+            if (range.empty() || range == "\n")
+                continue;
+            size_t dash = range.find('-');
+            int first = atoi(range.c_str());
+            int last = dash == std::string::npos ? first : atoi(range.c_str() + dash + 1);
+            for (int cpu = first; cpu <= last; ++cpu)
+                cpus.push_back(cpu);
+        }
+        return cpus;
+    }
+
+    // Procesori na kojima procesu smije da radi (npr. ogranicenje taskset-om ili kontejnerom)
+    std::vector<int> allowedCpus() {
+        std::vector<int> cpus;
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                if (CPU_ISSET(cpu, &set))
+                    cpus.push_back(cpu);
+        }
+#endif
+        if (cpus.empty())
+            cpus.push_back(0);
+        return cpus;
+    }
+
+    NumaTopology detectTopology() {
+        NumaTopology topology;
+        std::vector<int> allowed = allowedCpus();
+
+        // Simulirani cvorovi: dozvoljeni procesori se dijele na N uzastopnih grupa; ako procesora ima manje
+        // nego cvorova, cvorovi dijele procesore (raspored traka i niti se i dalje moze provjeriti)
+        const char* simulated = std::getenv("CONVOLUTION_NUMA_NODES");
+        int simulatedNodes = simulated ? atoi(simulated) : 0;
+        if (simulatedNodes > 0) {
+            topology.simulated = true;
+            topology.nodeCpus.resize(simulatedNodes);
+            for (int node = 0; node < simulatedNodes; ++node) {
+                size_t begin = allowed.size() * node / simulatedNodes;
+                size_t end = allowed.size() * (node + 1) / simulatedNodes;
+                if (begin == end)
+                    topology.nodeCpus[node].push_back(allowed[node % allowed.size()]);
+                for (size_t i = begin; i < end; ++i)
+                    topology.nodeCpus[node].push_back(allowed[i]);
+            }
+            return topology;
+        }
+
+        for (int node = 0; ; ++node) {
+            std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            if (!file)
+                break;
+            std::string text;
+            std::getline(file, text);
+            std::vector<int> cpus;
+            for (int cpu : parseCpuList(text))
+                if (std::find(allowed.begin(), allowed.end(), cpu) != allowed.end())
+                    cpus.push_back(cpu);
+            // Cvor bez dozvoljenih procesora (npr. samo memorija) se preskace
+            if (!cpus.empty())
+                topology.nodeCpus.push_back(cpus);
+        }
+        if (topology.nodeCpus.empty())
+            topology.nodeCpus.push_back(allowed);
+        return topology;
+    }
+
+    int threadNumber() {
+#ifdef _OPENMP
+        return omp_get_thread_num();
+#else
+        return 0;
+#endif
+    }
+
+    int threadCount() {
+#ifdef _OPENMP
+        return omp_get_num_threads();
+#else
+        return 1;
+#endif
+    }
+}
+
+/*
+    Ista podjela kao kod omp for schedule(static) bez velicine dijela (i sa collapse(2) nad redovima i kolonama,
+    gdje je broj iteracija visina * sirina): svaka nit dobija count / threads uzastopnih iteracija,
+    a prvih count % threads niti po jednu vise.
+*/
+void staticBand(size_t count, int thread, int threads, size_t& begin, size_t& end) {
+    size_t quotient = count / threads;
+    size_t remainder = count % threads;
+    size_t index = static_cast<size_t>(thread);
+    if (index < remainder) {
+        begin = index * (quotient + 1);
+        end = begin + quotient + 1;
+    }
+    else {
+        begin = index * quotient + remainder;
+        end = begin + quotient;
+    }
+}
+
+void currentStaticBand(size_t count, size_t& begin, size_t& end) {
+    staticBand(count, threadNumber(), threadCount(), begin, end);
+}
+
+/*
+    Paralelno punjenje nulama za prvi dodir stranica. Nit t puni piksele [begin, end) svoje trake,
+    a konvolucija (omp for collapse(2) schedule(static) nad cijelom slikom) istoj niti daje iste piksele,
+    pa svaka nit cita i upisuje stranice sa svog cvora; samo stranice na granicama traka dijele dvije niti.
+*/
+void firstTouchZero(void* data, size_t count, size_t elementSize) {
+    unsigned char* bytes = static_cast<unsigned char*>(data);
+    if (count * elementSize < parallelTouchBytes) {
+        if (count > 0)
+            memset(bytes, 0, count * elementSize);
+        return;
+    }
+
+#pragma omp parallel
+    {
+        size_t begin, end;
+        staticBand(count, threadNumber(), threadCount(), begin, end);
+        memset(bytes + begin * elementSize, 0, (end - begin) * elementSize);
+    }
+}
+
+const NumaTopology& numaTopology() {
+    static NumaTopology topology = detectTopology();
+    return topology;
+}
+
+/*
+    Niti se rasporedjuju po listi (cvor, procesor), cvor po cvor: nit t od n dobija mjesto t * mjesta / n.
+    Kada niti ima manje nego procesora, svaki cvor dobija srazmjeran broj niti (a ne samo prvi cvor),
+    a kako su trake slike poredane po broju niti, prva polovina slike je na prvom cvoru, druga na drugom.
+    Vezuju se niti tima koji postoji pri pozivu; OpenMP ih zadrzava i za sljedece paralelne regione
+    sa istim brojem niti. Nit 0 je nit koja je pozvala funkciju (glavna nit programa) i ostaje nevezana:
+    niti koje ona kasnije pokrene (citac i pisac toka, radnici servisa, bazen asinhronog U/I) nasljedjuju
+    njenu masku procesora, pa bi inace sve radile na jednom procesoru.
+*/
+void pinWorkerThreads() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+        const char* requested = std::getenv("CONVOLUTION_PIN_THREADS");
+        if (!requested || strcmp(requested, "1") != 0)
+            return;
+        if (std::getenv("OMP_PROC_BIND") || std::getenv("OMP_PLACES"))
+            return;
+
+        // Na masini sa jednim cvorom vezivanje ne donosi nista, a oduzima rasporedjivacu slobodu
+        const NumaTopology& topology = numaTopology();
+        if (topology.nodeCpus.size() < 2)
+            return;
+
+        std::vector<std::pair<int, int>> slots;
+        for (size_t node = 0; node < topology.nodeCpus.size(); ++node)
+            for (int cpu : topology.nodeCpus[node])
+                slots.push_back(std::make_pair(static_cast<int>(node), cpu));
+
+        std::vector<int> nodes;
+#pragma omp parallel
+        {
+            int thread = threadNumber();
+            int threads = threadCount();
+#pragma omp single
+            nodes.assign(threads, 0);
+
+            const std::pair<int, int>& slot = slots[static_cast<size_t>(thread) * slots.size() / threads];
+            nodes[thread] = thread == 0 ? -1 : slot.first;
+#ifdef __linux__
+            if (thread != 0) {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(slot.second, &set);
+                if (sched_setaffinity(0, sizeof(set), &set) != 0)
+                    nodes[thread] = -1;
+            }
+#endif
+        }
+        pinnedNodes = nodes;
+    });
+}
+
+const std::vector<int>& workerNodes() {
+    return pinnedNodes;
+}
+
+/*
+    Provjera rasporeda (slicno kao numactl --hardware i numastat -p):
+    1) topologija (pravi ili simulirani cvorovi) i cvor svake niti nakon vezivanja;
+    2) da li petlja istog oblika kao u konvoluciji (collapse(2) schedule(static)) svakoj stranici
+       dodjeljuje nit koja je tu stranicu prva dotakla u konstruktoru slike;
+    3) stvarni cvor svake stranice, upitom move_pages bez premjestanja (samo Linux).
+       Za pravu topologiju se racuna udio stranica na cvoru niti koja ih obradjuje; za simuliranu
+       se ispisuje ocekivani raspored, jer su sve stranice fizicki na stvarnim cvorovima masine.
+    Uz transparentne velike stranice (2 MB) jednu stranicu dodiruje vise niti, pa je udio nesto manji.
+*/
+int runNumaCheck(int width, int height) {
+    TRACE_SCOPE("numaCheck");
+
+    const NumaTopology& topology = numaTopology();
+    std::cout << "NUMA cvorova: " << topology.nodeCpus.size() << (topology.simulated ? " (simulirano)" : "") << std::endl;
+    for (size_t node = 0; node < topology.nodeCpus.size(); ++node) {
+        std::cout << "cvor " << node << " procesori:";
+        for (int cpu : topology.nodeCpus[node])
+            std::cout << " " << cpu;
+        std::cout << std::endl;
+    }
+
+    pinWorkerThreads();
+    const std::vector<int>& nodes = workerNodes();
+    if (nodes.empty())
+        std::cout << "Niti nisu vezane (ukljucuje se sa CONVOLUTION_PIN_THREADS=1 na masini sa vise cvorova, "
+            "osim ako je zadan OMP_PROC_BIND ili OMP_PLACES)." << std::endl;
+    for (size_t thread = 0; thread < nodes.size(); ++thread) {
+        if (nodes[thread] < 0)
+            std::cout << "nit " << thread << " -> nije vezana" << std::endl;
+        else
+            std::cout << "nit " << thread << " -> cvor " << nodes[thread] << std::endl;
+    }
+
+    Image image(width, height);
+    size_t pixels = image.pixels.size();
+#ifdef __linux__
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+    size_t pageSize = 4096;
+#endif
+    uintptr_t firstByte = reinterpret_cast<uintptr_t>(image.pixels.data());
+    uintptr_t firstPage = firstByte / pageSize * pageSize;
+    size_t pageCount = (firstByte + pixels * sizeof(Color) - firstPage + pageSize - 1) / pageSize;
+
+    // Nit koja obradjuje svaki piksel u petlji oblika kao u konvoluciji
+    std::vector<uint16_t> owner(pixels);
+    int threads = 1;
+#pragma omp parallel
+    {
+#pragma omp single
+        threads = threadCount();
+
+#pragma omp for collapse(2) schedule(static)
+        for (int y = 0; y < height; ++y)
+            for (int x = 0; x < width; ++x)
+                owner[static_cast<size_t>(y) * width + x] = static_cast<uint16_t>(threadNumber());
+    }
+
+    // Poredjenje sa trakama prvog dodira, po pikselu na pocetku svake stranice
+    std::vector<int> pageOwner(pageCount);
+    size_t matching = 0;
+    for (size_t page = 0; page < pageCount; ++page) {
+        uintptr_t address = std::max(firstByte, firstPage + page * pageSize);
+        size_t pixel = std::min(pixels - 1, (address - firstByte + sizeof(Color) - 1) / sizeof(Color));
+        int toucher = 0;
+        if (pixels * sizeof(Color) >= parallelTouchBytes) {
+            for (int thread = 0; thread < threads; ++thread) {
+                size_t begin, end;
+                staticBand(pixels, thread, threads, begin, end);
+                if (pixel >= begin && pixel < end)
+                    toucher = thread;
+            }
+        }
+        pageOwner[page] = owner[pixel];
+        if (toucher == owner[pixel])
+            ++matching;
+    }
+    std::cout << "Stranica: " << pageCount << ", niti: " << threads << ", stranice koje obradjuje nit koja ih je prva dotakla: "
+        << std::fixed << std::setprecision(2) << 100.0 * matching / pageCount << "%" << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+
+    if (!nodes.empty() && static_cast<int>(nodes.size()) == threads) {
+        std::vector<size_t> expected(topology.nodeCpus.size());
+        for (int ownerThread : pageOwner)
+            if (nodes[ownerThread] >= 0)
+                ++expected[nodes[ownerThread]];
+        std::cout << "Ocekivani raspored stranica:";
+        for (size_t node = 0; node < expected.size(); ++node)
+            std::cout << " cvor " << node << " " << expected[node];
+        std::cout << std::endl;
+    }
+
+#if defined(__linux__) && defined(SYS_move_pages)
+    // move_pages bez ciljnih cvorova samo vraca trenutni cvor svake stranice
+    std::vector<void*> addresses(pageCount);
+    for (size_t page = 0; page < pageCount; ++page)
+        addresses[page] = reinterpret_cast<void*>(firstPage + page * pageSize);
+    std::vector<int> status(pageCount, -1);
+    if (syscall(SYS_move_pages, 0, pageCount, addresses.data(), nullptr, status.data(), 0) != 0) {
+        std::cout << "Upit move_pages nije dostupan; stvarni raspored stranica nije poznat." << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    std::vector<size_t> actual;
+    size_t local = 0, known = 0;
+    for (size_t page = 0; page < pageCount; ++page) {
+        if (status[page] < 0)
+            continue;
+        if (static_cast<size_t>(status[page]) >= actual.size())
+            actual.resize(status[page] + 1);
+        ++actual[status[page]];
+        ++known;
+        int ownerThread = pageOwner[page];
+        if (!nodes.empty() && ownerThread < static_cast<int>(nodes.size()) && nodes[ownerThread] == status[page])
+            ++local;
+    }
+    std::cout << "Stvarni raspored stranica:";
+    for (size_t node = 0; node < actual.size(); ++node)
+        std::cout << " cvor " << node << " " << actual[node];
+    std::cout << std::endl;
+
+    if (topology.simulated)
+        std::cout << "Topologija je simulirana, pa se stvarni raspored ne poredi sa ocekivanim." << std::endl;
+    else if (!nodes.empty() && known > 0)
+        std::cout << "Lokalnih stranica (na cvoru niti koja ih obradjuje): " << std::fixed << std::setprecision(2)
+            << 100.0 * local / known << "%" << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+#else
+    std::cout << "Stvarni raspored stranica se moze provjeriti samo na Linuxu." << std::endl;
+#endif
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Oznaka za eksplicitan prvi dodir: FirstTouchAllocator<T>(firstTouch, n) ne konstruise prvih n elemenata
+struct FirstTouchTag {};
+constexpr FirstTouchTag firstTouch{};
+
+/*
+    Alokator za piksele slike i float medjurezultate. Elementi se inicijalizuju kao kod std::allocator
+    (resize() i std::vector(n) daju nule), osim kada je alokator napravljen sa oznakom firstTouch: tada se
+    sljedecih n konstrukcija bez argumenata preskace, pa std::vector(n, alokator) samo rezervise adrese,
+    a stranice dobijaju fizicku memoriju tek pri prvom upisu. Na NUMA masini stranica zavrsava na cvoru niti
+    koja je prva upisala u nju (first touch), pa konstruktor slike tako pravi vektor i puni piksele nulama
+    paralelno (firstTouchZero), istim trakama koje niti kasnije obradjuju u konvoluciji.
+    Preskakanje se trosi pri konstrukciji, pa kasniji resize() istog vektora ponovo inicijalizuje elemente.
+    Koristi se samo za tipove kojima su sve nule ispravna podrazumijevana vrijednost (pikseli, float).
+*/
+template <typename T>
+struct FirstTouchAllocator : std::allocator<T> {
+    template <typename U> struct rebind { typedef FirstTouchAllocator<U> other; };
+
+    size_t untouched = 0;  // broj preostalih konstrukcija bez argumenata koje ne diraju memoriju
+
+    FirstTouchAllocator() noexcept {}
+    FirstTouchAllocator(FirstTouchTag , size_t count) noexcept : untouched(count) {}
+    template <typename U> FirstTouchAllocator(const FirstTouchAllocator<U>& ) noexcept {}
+
+    // Kopija kontejnera uvijek inicijalizuje svoje elemente
+    FirstTouchAllocator select_on_container_copy_construction() const noexcept { return FirstTouchAllocator(); }
+
+    template <typename U> void construct(U* pointer) {
+        if (untouched > 0) {
+            --untouched;
+            return;
+        }
+        ::new (static_cast<void*>(pointer)) U();
+    }
+
+    template <typename U, typename... Args>
+    void construct(U* pointer, Args&&... args) { ::new (static_cast<void*>(pointer)) U(std::forward<Args>(args)...); }
+};
+
+/*
+    Medjubafer od najmanje `count` elemenata bez punjenja nulama (eksplicitan prvi dodir): ako je premali,
+    pravi se novi, ciji elementi prvi upisuje paralelni prolaz koji ih koristi. Postojeci sadrzaj se ne cuva,
+    a pozivalac mora upisati svaki element prije nego sto ga procita.
+*/
+template <typename T>
+void reserveUntouched(std::vector<T, FirstTouchAllocator<T>>& buffer, size_t count) {
+    if (buffer.size() < count)
+        buffer = std::vector<T, FirstTouchAllocator<T>>(count, FirstTouchAllocator<T>(firstTouch, count));
+}
+
+// Granice trake [begin, end) koju nit `thread` od `threads` dobija za `count` iteracija kod omp for schedule(static)
+void staticBand(size_t , int , int , size_t& , size_t& );
+
+// Traka [begin, end) niti koja poziva funkciju, unutar paralelnog regiona (van regiona cijeli opseg)
+void currentStaticBand(size_t , size_t& , size_t& );
+
+// Punjenje nulama `count` elemenata velicine `elementSize`; za velike nizove paralelno, po trakama staticBand()
+void firstTouchZero(void* , size_t , size_t );
+
+// NUMA cvorovi i njihovi procesori (iz /sys/devices/system/node ili simulirani sa CONVOLUTION_NUMA_NODES=N)
+struct NumaTopology {
+    std::vector<std::vector<int>> nodeCpus;
+    bool simulated = false;
+};
+
+const NumaTopology& numaTopology();
+
+/*
+    Vezivanje OpenMP niti za procesore: niti su ravnomjerno rasporedjene po procesorima, cvor po cvor,
+    pa susjedne niti (i susjedne trake slike) dijele cvor. Ukljucuje se samo eksplicitno, sa CONVOLUTION_PIN_THREADS=1,
+    i samo na masini sa vise (stvarnih ili simuliranih) cvorova; main() je poziva jednom, na pocetku programa.
+    Glavna nit se nikad ne vezuje. Ako je zadan OMP_PROC_BIND ili OMP_PLACES, rasporedom upravlja OpenMP.
+*/
+void pinWorkerThreads();
+
+// Cvor na koji je vezana svaka nit (indeks je broj niti, -1 za nevezanu nit); prazno ako niti nisu vezane
+const std::vector<int>& workerNodes();
+
+// Provjera rasporeda stranica velike slike po cvorovima (kao numastat), za sliku zadane sirine i visine
+int runNumaCheck(int , int );
@@ -0,0 +1,162 @@
+#include "perfCounters.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    const int eventCount = 8;
+
+#ifdef __linux__
+    uint64_t scaled(uint64_t value, uint64_t enabled, uint64_t running) {
+        // Kada kernel multipleksira brojace, vrijednost se skalira na cijelo vrijeme mjerenja
+        if (running == 0)
+            return 0;
+        return running < enabled ? static_cast<uint64_t>(static_cast<double>(value) * enabled / running) : value;
+    }
+
+    struct EventConfig {
+        uint32_t type;
+        uint64_t config;
+    };
+
+    const EventConfig events[eventCount] = {
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_ACCESS << 16) },
+        { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+        { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    };
+
+    int openEvent(const EventConfig& event) {
+        perf_event_attr attributes;
+        memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = event.type;
+        attributes.config = event.config;
+        attributes.disabled = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0));
+    }
+#endif
+}
+
+double PerfCounterValues::ipc() const {
+    return cycles ? static_cast<double>(instructions) / cycles : 0.0;
+}
+
+double PerfCounterValues::l1dMissRate() const {
+    return l1dAccesses ? static_cast<double>(l1dMisses) / l1dAccesses : 0.0;
+}
+
+double PerfCounterValues::llcMissRate() const {
+    return llcReferences ? static_cast<double>(llcMisses) / llcReferences : 0.0;
+}
+
+PerfCounters::PerfCounters() {
+#ifdef __linux__
+#ifdef _OPENMP
+    int threads = omp_get_max_threads();
+#else
+    int threads = 1;
+#endif
+    fds.assign(static_cast<size_t>(threads) * eventCount, -1);
+    int firstError = 0;
+
+#pragma omp parallel num_threads(threads)
+    {
+#ifdef _OPENMP
+        int thread = omp_get_thread_num();
+#else
+        int thread = 0;
+#endif
+        for (int e = 0; e < eventCount; ++e) {
+            int fd = openEvent(events[e]);
+            fds[thread * eventCount + e] = fd;
+            if (fd < 0 && e == 0) {
+#pragma omp critical
+                firstError = errno;
+            }
+        }
+    }
+
+    if (fds[0] < 0) {
+        reason = std::string("perf_event_open: ") + strerror(firstError ? firstError : ENOSYS);
+        for (int& fd : fds) {
+            if (fd >= 0)
+                close(fd);
+        }
+        fds.clear();
+    }
+#else
+    reason = "hardverski brojaci su podrzani samo na Linuxu (perf_event_open)";
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+    for (int fd : fds) {
+        if (fd >= 0)
+            close(fd);
+    }
+#endif
+}
+
+bool PerfCounters::available() const {
+    return !fds.empty();
+}
+
+const std::string& PerfCounters::unavailableReason() const {
+    return reason;
+}
+
+void PerfCounters::start() {
+#ifdef __linux__
+    for (int fd : fds) {
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+}
+
+PerfCounterValues PerfCounters::stop() {
+    PerfCounterValues values;
+#ifdef __linux__
+    if (fds.empty())
+        return values;
+
+    for (int fd : fds) {
+        if (fd >= 0)
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+
+    uint64_t* totals[eventCount] = {
+        &values.cycles, &values.instructions, &values.l1dAccesses, &values.l1dMisses,
+        &values.llcReferences, &values.llcMisses, &values.branchMisses, &values.dtlbMisses };
+
+    for (size_t i = 0; i < fds.size(); ++i) {
+        uint64_t data[3];  // vrijednost, vrijeme ukljucenosti, vrijeme stvarnog brojanja
+        if (fds[i] >= 0 && read(fds[i], data, sizeof(data)) == static_cast<ssize_t>(sizeof(data)))
+            *totals[i % eventCount] += scaled(data[0], data[1], data[2]);
+    }
+    values.valid = values.cycles > 0;
+#endif
+    return values;
+}
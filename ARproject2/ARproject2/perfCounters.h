@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Vrijednosti hardverskih brojaca za jedan mjereni region (sumirano po svim nitima)
+struct PerfCounterValues {
+    bool valid = false;
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t l1dAccesses = 0;
+    uint64_t l1dMisses = 0;
+    uint64_t llcReferences = 0;
+    uint64_t llcMisses = 0;
+    uint64_t branchMisses = 0;
+    uint64_t dtlbMisses = 0;  // promasaji u TLB-u podataka pri citanju (0 ako procesor ne podrzava dogadjaj)
+
+    double ipc() const;
+    double l1dMissRate() const;
+    double llcMissRate() const;
+};
+
+/*
+    Hardverski brojaci performansi preko Linux perf_event_open.
+    Brojaci se otvaraju u svakoj niti OpenMP tima, jer perf dogadjaj otvoren za jednu nit ne broji
+    rad niti koje su vec postojale, a konvolucija se izvrsava u postojecem OpenMP poolu.
+    Ako brojaci nisu dostupni (drugi OS, kontejner, perf_event_paranoid), available() vraca false,
+    a stop() vraca vrijednosti sa valid = false, pa se mjerenje vremena nastavlja bez njih.
+*/
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    bool available() const;
+    const std::string& unavailableReason() const;
+
+    void start();
+    PerfCounterValues stop();
+
+private:
+    std::vector<int> fds;  // za svaku nit po jedan deskriptor za svaki dogadjaj (-1 ako nije otvoren)
+    std::string reason;
+};
@@ -0,0 +1,253 @@
+#include "pipeline.h"
+#include "convolution.h"
+#include "autoTuner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <utility>
+
+namespace {
+    // Cijena dodatnog prolaza kroz memoriju: medjurezultat izmedju faza, odnosno float bafer separabilne konvolucije
+    const double stagePassCost = 4.0;
+    const double separablePassCost = 4.0;
+
+    // Velicina kvadratnog kernela, ili 0 ako broj elemenata nije kvadrat neparnog broja
+    int kernelSide(const std::vector<float>& kernel) {
+        int size = static_cast<int>(std::lround(std::sqrt(static_cast<double>(kernel.size()))));
+        return (size > 0 && size % 2 == 1 && static_cast<size_t>(size) * size == kernel.size()) ? size : 0;
+    }
+
+    /*
+        Popunjava separabilnost i cijenu faze (jeftiniji od direktnog i separabilnog nacina).
+        Separabilna konvolucija zaokruzuje float medjurezultat drugacije od direktne (+/-1), pa se ne bira za tacne faze.
+    */
+    void costStage(PlannedStage& stage) {
+        int size = kernelSide(stage.kernel);
+        double direct = static_cast<double>(stage.kernel.size());
+        stage.separable = !stage.exact && size > 1 && separateKernel(stage.kernel, stage.column, stage.row)
+            && 2.0 * size + separablePassCost < direct;
+        if (!stage.separable) {
+            stage.column.clear();
+            stage.row.clear();
+        }
+        stage.cost = stage.separable ? 2.0 * size + separablePassCost : direct;
+    }
+
+    // Rect prosiren za `radius` u svim smjerovima i ogranicen na sliku
+    Rect expandRect(const Rect& rect, int radius, int width, int height) {
+        int left = std::max(0, rect.x - radius), top = std::max(0, rect.y - radius);
+        int right = std::min(width, rect.x + rect.width + radius), bottom = std::min(height, rect.y + rect.height + radius);
+        return Rect(left, top, right - left, bottom - top);
+    }
+
+    /*
+        Racuna pravougaonik `strip` izlaza grupe faza tacno kao da se faze primjenjuju jedna za drugom.
+        Svaka faza racuna samo pravougaonik potreban sljedecim fazama (strip prosiren za zbir poluprecnika
+        preostalih faza, ogranicen na sliku). Rubno pravilo se tako primjenjuje na medjurezultat na pravom rubu slike,
+        a na unutrasnjim granicama medjurezultata prosirenje je dovoljno da se rub ne koristi.
+    */
+    void convolveStripStaged(const Image& input, const std::vector<std::vector<float>>& parts, const Rect& strip, Image& output,
+        std::vector<Color> (&buffers)[2]) {
+        // Zbir poluprecnika faza nakon trenutne
+        int remaining = 0;
+        for (size_t i = 1; i < parts.size(); ++i)
+            remaining += kernelSide(parts[i]) / 2;
+
+        // Medjurezultati faza se smjenjuju u dva bafera pozivaoca, koji se prosiruju samo kada su premali
+        ConstImageView source(input);
+        Rect bufferRect(0, 0, input.width, input.height);
+        for (size_t i = 0; i < parts.size(); ++i) {
+            if (i > 0)
+                remaining -= kernelSide(parts[i]) / 2;
+            Rect target = expandRect(strip, remaining, input.width, input.height);
+            Rect roi(target.x - bufferRect.x, target.y - bufferRect.y, target.width, target.height);
+
+            if (i + 1 == parts.size()) {
+                convolutionROI(source, parts[i], roi, ImageView(output).subView(strip));
+            }
+            else {
+                std::vector<Color>& next = buffers[i % 2];
+                size_t needed = static_cast<size_t>(target.width) * target.height;
+                if (next.size() < needed)
+                    next.resize(needed);
+                convolutionROI(source, parts[i], roi, ImageView(next.data(), target.width, target.height));
+                source = ConstImageView(next.data(), target.width, target.height);
+                bufferRect = target;
+            }
+        }
+    }
+
+    // Pikseli uz rub (sirine zbira poluprecnika svih faza osim prve) gdje se spojeni kernel razlikuje od faza redom
+    void fixCollapsedBorder(const Image& input, const PlannedStage& stage, Image& output, std::vector<Color> (&buffers)[2]) {
+        int band = 0;
+        for (size_t i = 1; i < stage.parts.size(); ++i)
+            band += kernelSide(stage.parts[i]) / 2;
+        if (band == 0)
+            return;
+
+        const int width = input.width, height = input.height;
+        if (2 * band >= width || 2 * band >= height) {
+            convolveStripStaged(input, stage.parts, Rect(0, 0, width, height), output, buffers);
+            return;
+        }
+
+        convolveStripStaged(input, stage.parts, Rect(0, 0, width, band), output, buffers);
+        convolveStripStaged(input, stage.parts, Rect(0, height - band, width, band), output, buffers);
+        convolveStripStaged(input, stage.parts, Rect(0, band, band, height - 2 * band), output, buffers);
+        convolveStripStaged(input, stage.parts, Rect(width - band, band, band, height - 2 * band), output, buffers);
+    }
+}
+
+/*
+    Konvolucija je linearna i asocijativna: primjena kernela A pa kernela B je isto sto i jedna konvolucija
+    sa kernelom C koji je "konvolucija" ta dva kernela, C(m) = suma A(i) * B(j) za i + j = m.
+    Buduci da convolution() racuna sumu ulaz(p + i) * kernel(i), indeksi se samo sabiraju (bez okretanja kernela).
+*/
+std::vector<float> composeKernels(const std::vector<float>& first, const std::vector<float>& second) {
+    int firstSize = kernelSide(first);
+    int secondSize = kernelSide(second);
+    int size = firstSize + secondSize - 1;
+    std::vector<double> composed(static_cast<size_t>(size) * size, 0.0);
+
+    for (int ay = 0; ay < firstSize; ++ay)
+        for (int ax = 0; ax < firstSize; ++ax)
+            for (int by = 0; by < secondSize; ++by)
+                for (int bx = 0; bx < secondSize; ++bx)
+                    composed[(ay + by) * size + (ax + bx)] += static_cast<double>(first[ay * firstSize + ax]) * second[by * secondSize + bx];
+
+    return std::vector<float>(composed.begin(), composed.end());
+}
+
+bool isClampFree(const std::vector<float>& kernel) {
+    double sum = 0.0;
+    for (float weight : kernel) {
+        if (weight < 0.0f)
+            return false;
+        sum += weight;
+    }
+    return sum <= 1.0 + 1e-6;
+}
+
+/*
+    Planiranje izvrsavanja niza kernela. Za svaku grupu uzastopnih faza koja se smije spojiti racuna se spojeni kernel
+    i njegova cijena po pikselu (n * n za direktnu konvoluciju, 2n plus prolaz kroz float bafer ako je separabilan),
+    a zatim se dinamickim programiranjem bira podjela niza na grupe sa najmanjom ukupnom cijenom; svaka faza
+    plana dodaje jos i cijenu prolaza kroz medjurezultat. Npr. dva 3x3 Gausova kernela postaju jedan separabilan 5x5
+    (10 + 4 umjesto 9 + 4 + 9), dok Gaus pa izostravanje ostaju dvije faze, jer 5x5 kernel nije separabilan (25 > 22).
+    Spajanje zanemaruje odsijecanje i zaokruzivanje medjurezultata na [0, 255], pa je kod CollapsePolicy::ClampFree
+    dozvoljeno samo kada sve faze osim posljednje u grupi ne mogu izaci iz tog opsega (isClampFree). Spojena faza ne
+    zaokruzuje medjurezultat na cijeli broj (odbacivanje decimala u svakoj fazi), pa se rezultat moze razlikovati za
+    nekoliko nivoa; zato je podrazumijevano CollapsePolicy::None, a spajanje se ukljucuje eksplicitno.
+    Kod CollapsePolicy::None ni pojedinacne faze se ne prepisuju u separabilan oblik, jer ni on nije bit po bit isti. Uz rub slike spojeni kernel bi rubno pravilo primijenio na ulaz, a ne na medjurezultat,
+    pa runPipeline() taj uski rub racuna faza po faza (vidi convolveStripStaged()).
+*/
+PipelinePlan planPipeline(const Pipeline& stages, CollapsePolicy policy) {
+    const size_t count = stages.size();
+
+    // best[i] je cijena najjeftinijeg plana za prvih i faza, a lastGroup[i] posljednja grupa u tom planu
+    std::vector<double> best(count + 1, std::numeric_limits<double>::infinity());
+    std::vector<PlannedStage> lastGroup(count + 1);
+    best[0] = 0.0;
+
+    for (size_t first = 0; first < count; ++first) {
+        if (std::isinf(best[first]))
+            continue;
+
+        PlannedStage group;
+        group.firstStage = first;
+        group.exact = policy == CollapsePolicy::None;
+        for (size_t last = first; last < count; ++last) {
+            if (last == first) {
+                group.kernel = stages[first];
+                group.parts.assign(1, stages[first]);
+            }
+            else {
+                bool allowed = policy == CollapsePolicy::Always
+                    || (policy == CollapsePolicy::ClampFree && isClampFree(stages[last - 1]));
+                if (!allowed || kernelSide(group.kernel) == 0 || kernelSide(stages[last]) == 0)
+                    break;
+                group.kernel = composeKernels(group.kernel, stages[last]);
+                group.parts.push_back(stages[last]);
+            }
+            group.stageCount = last - first + 1;
+            costStage(group);
+
+            double total = best[first] + group.cost + stagePassCost;
+            if (total < best[last + 1]) {
+                best[last + 1] = total;
+                lastGroup[last + 1] = group;
+            }
+        }
+    }
+
+    PipelinePlan plan;
+    for (size_t end = count; end > 0; end = lastGroup[end].firstStage)
+        plan.insert(plan.begin(), lastGroup[end]);
+    return plan;
+}
+
+void printPipelinePlan(std::ostream& out, const PipelinePlan& plan) {
+    for (const PlannedStage& stage : plan) {
+        int size = kernelSide(stage.kernel);
+        out << "Faze " << stage.firstStage + 1 << "-" << stage.firstStage + stage.stageCount << ": kernel "
+            << size << "x" << size << (stage.separable ? " (separabilan)" : "") << ", cijena " << stage.cost << std::endl;
+    }
+}
+
+/*
+    Ova funkcija primjenjuje niz kernela nad slikom, tako da je izlaz svake faze ulaz sljedece.
+    Medjurezultati se naizmjenicno smjestaju u `output` i `scratch.image` ("ping-pong"),
+    i to tako da posljednja faza uvijek pise u `output`. Float bafer separabilnih faza i medjurezultati
+    rubnih traka spojenih faza su takodje u `scratch`, pa se funkcija moze pozivati za svaki frejm video toka
+    sa istim, unaprijed alociranim slikama, bez alokacije memorije po frejmu.
+    Slike `output` i `scratch.image` moraju biti istih dimenzija kao `input`.
+    Statistika izlaza (ako je trazena) se racuna u posljednjoj fazi, dok se pikseli upisuju u `output`.
+*/
+void runPipeline(const Image& input, const PipelinePlan& plan, Image& output, PipelineScratch& scratch, ImageStatistics* statistics) {
+    if (plan.empty()) {
+        output.pixels = input.pixels;
+        if (statistics)
+            computeStatistics(output, *statistics);
+        return;
+    }
+
+    // Odredjivanje prvog odredista tako da posljednja faza zavrsi u `output`
+    Image* target = (plan.size() % 2 == 1) ? &output : &scratch.image;
+    Image* other = (target == &output) ? &scratch.image : &output;
+
+    const Image* source = &input;
+    for (size_t stage = 0; stage < plan.size(); ++stage) {
+        const PlannedStage& planned = plan[stage];
+        bool collapsed = planned.parts.size() > 1;
+        bool last = stage + 1 == plan.size();
+
+        /*
+            Nacin racunanja faze ne zavisi od toga da li je trazena statistika, pa je izlaz isti u oba slucaja.
+            Statistika se racuna usput samo kada bi faza ionako bila direktna konvolucija (nije separabilna,
+            tacna je ili nema profila podesavanja) i rub se ne prepravlja nakon nje; inace se racuna posebnim prolazom.
+        */
+        bool fused = statistics && last && !collapsed && !planned.separable && (planned.exact || activeTuningProfile().empty());
+        if (fused)
+            convolution(*source, planned.kernel, *target, BorderMode::Replicate, *statistics);
+        else if (planned.separable)
+            convolutionSeparable(*source, planned.column, planned.row, *target, BorderMode::Replicate, scratch.separable);
+        else if (planned.exact)
+            convolution(*source, planned.kernel, *target);
+        else
+            convolutionTuned(*source, planned.kernel, *target);
+
+        if (collapsed)
+            fixCollapsedBorder(*source, planned, *target, scratch.strips);
+        if (statistics && last && !fused)
+            computeStatistics(*target, *statistics);
+        source = target;
+        std::swap(target, other);
+    }
+}
+
+// Oblik koji svaki put pravi plan (CollapsePolicy::None); za ponavljane pozive plan treba napraviti jednom
+void runPipeline(const Image& input, const Pipeline& stages, Image& output, PipelineScratch& scratch, ImageStatistics* statistics) {
+    runPipeline(input, planPipeline(stages), output, scratch, statistics);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <iosfwd>
+#include <vector>
+#include "image.h"
+#include "convolution.h"
+#include "imageStatistics.h"
+
+// Niz kernela koji se primjenjuju jedan za drugim
+typedef std::vector<std::vector<float>> Pipeline;
+
+// Kada se uzastopne linearne faze smiju spojiti u jedan kernel
+enum class CollapsePolicy {
+    None,       // svaka faza se racuna posebno, direktnom konvolucijom (convolution()); rezultat je bit po bit isti
+                // kao kod primjene kernela jedan za drugim (podrazumijevano)
+    ClampFree,  // spajaju se samo faze ciji medjurezultat ne izlazi iz [0, 255]: odsijecanje se ne gubi, ali se gubi
+                // odbacivanje decimala medjurezultata, pa se rezultat moze razlikovati za nekoliko nivoa (obicno +/-1);
+                // separabilni kerneli (i pojedinacne faze) se racunaju u dva prolaza, sto takodje daje +/-1
+    Always      // spajaju se sve faze; odsijecanje i zaokruzivanje medjurezultata se zanemaruju, separabilni kao kod ClampFree
+};
+
+// Jedna faza izvrsnog plana: kernel nastao spajanjem faza [firstStage, firstStage + stageCount) ulaznog niza
+struct PlannedStage {
+    std::vector<float> kernel;
+    std::vector<std::vector<float>> parts;  // originalni kerneli grupe; rub slike se racuna faza po faza
+    bool exact = false;  // CollapsePolicy::None: racuna se sa convolution(), bez separabilnog ili podesenog nacina
+    bool separable = false;
+    std::vector<float> column, row;
+    size_t firstStage = 0, stageCount = 0;
+    double cost = 0.0;  // procijenjeni broj mnozenja i sabiranja po kanalu piksela
+};
+
+typedef std::vector<PlannedStage> PipelinePlan;
+
+// Kernel koji daje isti rezultat kao primjena kernela `first`, pa `second` (velicine n1 + n2 - 1)
+std::vector<float> composeKernels(const std::vector<float>& , const std::vector<float>& );
+
+// Da li je izlaz kernela za svaki ulaz iz [0, 255] takodje u [0, 255] (nenegativne tezine, zbir najvise 1)
+bool isClampFree(const std::vector<float>& );
+
+PipelinePlan planPipeline(const Pipeline& , CollapsePolicy = CollapsePolicy::None);
+
+void printPipelinePlan(std::ostream& , const PipelinePlan& );
+
+/*
+    Radna memorija za runPipeline(): pravi se jednom (npr. po slotu video toka) i koristi za svaki frejm,
+    pa runPipeline() nakon prvog frejma ne alocira memoriju.
+*/
+struct PipelineScratch {
+    Image image;                    // medjurezultat izmedju faza (naizmjenicno sa izlazom)
+    SeparableBuffer separable;      // float medjurezultat separabilne faze
+    std::vector<Color> strips[2];   // medjurezultati faza pri racunanju ruba spojene faze
+
+    PipelineScratch(int w, int h) : image(w, h) {}
+};
+
+// Ako je zadana statistika, racuna se usput, tokom posljednje faze
+void runPipeline(const Image& , const PipelinePlan& , Image& , PipelineScratch& , ImageStatistics* = nullptr);
+
+void runPipeline(const Image& , const Pipeline& , Image& , PipelineScratch& , ImageStatistics* = nullptr);
@@ -0,0 +1,199 @@
+#include "pyramid.h"
+#include "convolution.h"
+#include "tracing.h"
+
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+
+    // Binomni 5x5 kernel (1 4 6 4 1) / 16 u oba smjera, standardna aproksimacija Gausovog kernela za piramide
+    const int pyramidRadius = 2;
+    const float pyramidTaps[2 * pyramidRadius + 1] = { 1.0f / 16, 4.0f / 16, 6.0f / 16, 4.0f / 16, 1.0f / 16 };
+    const int lineCount = 2 * pyramidRadius + 1;
+
+    /*
+        Stanje jednog nivoa dok nit prolazi kroz svoj pojas: prsten od 5 horizontalno filtriranih
+        i decimiranih ulaznih redova (float) i posljednji izracunati izlazni red, koji je ulaz sljedeceg nivoa.
+        Nit racuna izlazne redove [first, last), a u sliku nivoa upisuje samo svoje redove [ownFirst, ownLast);
+        ostali (halo) redovi sluze samo kao ulaz sljedeceg nivoa, pa dvije niti nikada ne pisu isti red.
+    */
+    struct LevelStream {
+        Image* output = nullptr;
+        int inWidth = 0, inHeight = 0;
+        int first = 0, last = 0;
+        int ownFirst = 0, ownLast = 0;
+        int next = 0;     // sljedeci izlazni red
+        int pushed = -1;  // posljednji ulazni red u prstenu
+        std::vector<float> ring;
+        std::vector<Color> row;
+    };
+
+    void horizontalLine(const Color* row, int inWidth, int outWidth, float* line) {
+        for (int x = 0; x < outWidth; ++x) {
+            int srcX = 2 * x;
+            float sumBlue = 0, sumGreen = 0, sumRed = 0;
+            for (int k = -pyramidRadius; k <= pyramidRadius; ++k) {
+                const Color& pixel = row[std::max(0, std::min(inWidth - 1, srcX + k))];
+                sumBlue += pixel.blue * pyramidTaps[k + pyramidRadius];
+                sumGreen += pixel.green * pyramidTaps[k + pyramidRadius];
+                sumRed += pixel.red * pyramidTaps[k + pyramidRadius];
+            }
+            line[3 * x] = sumBlue;
+            line[3 * x + 1] = sumGreen;
+            line[3 * x + 2] = sumRed;
+        }
+    }
+
+    /*
+        Dodavanje ulaznog reda `y` nivou `level`: red se filtrira horizontalno u prsten, a zatim se racunaju svi
+        izlazni redovi kojima su sada dostupni ulazni redovi 2y-2 .. 2y+2 (ograniceni na rub slike).
+        Svaki izracunati red se odmah, dok je u kesu, predaje sljedecem nivou.
+    */
+    void pushRow(std::vector<LevelStream>& levels, size_t level, int y, const Color* pixels) {
+        LevelStream& stream = levels[level];
+        const int outWidth = stream.output->width;
+        const size_t lineLength = static_cast<size_t>(outWidth) * 3;
+        horizontalLine(pixels, stream.inWidth, outWidth, &stream.ring[lineLength * (y % lineCount)]);
+        stream.pushed = y;
+
+        while (stream.next < stream.last && stream.pushed >= std::min(2 * stream.next + pyramidRadius, stream.inHeight - 1)) {
+            const float* taps[lineCount];
+            for (int k = -pyramidRadius; k <= pyramidRadius; ++k) {
+                int srcY = std::max(0, std::min(stream.inHeight - 1, 2 * stream.next + k));
+                taps[k + pyramidRadius] = &stream.ring[lineLength * (srcY % lineCount)];
+            }
+
+            Color* outRow = stream.row.data();
+            for (int x = 0; x < outWidth; ++x) {
+                float sum[3] = { 0, 0, 0 };
+                for (int k = 0; k < lineCount; ++k) {
+                    for (int c = 0; c < 3; ++c)
+                        sum[c] += taps[k][3 * x + c] * pyramidTaps[k];
+                }
+                outRow[x].blue = static_cast<uint8_t>(std::max(0.0f, std::min(255.0f, sum[0])));
+                outRow[x].green = static_cast<uint8_t>(std::max(0.0f, std::min(255.0f, sum[1])));
+                outRow[x].red = static_cast<uint8_t>(std::max(0.0f, std::min(255.0f, sum[2])));
+            }
+
+            if (stream.next >= stream.ownFirst && stream.next < stream.ownLast)
+                std::copy(outRow, outRow + outWidth, &stream.output->pixels[static_cast<size_t>(stream.next) * outWidth]);
+            if (level + 1 < levels.size())
+                pushRow(levels, level + 1, stream.next, outRow);
+            ++stream.next;
+        }
+    }
+
+    /*
+        Broj nivoa koji se prave u jednom prolazu kroz `source`. Niti dijele izvor na pojaseve i same racunaju
+        halo redove na granicama pojasa; halo u izvoru raste oko 2^(d+1) redova za d nivoa,
+        pa se dublji nivoi prave u sljedecem prolazu, iz vec zavrsenog manjeg nivoa, cim bi halo presao cetvrtinu pojasa.
+    */
+    size_t stageLevels(int sourceHeight, int threadCount, size_t remaining) {
+        if (threadCount == 1)
+            return remaining;
+        const long long band = sourceHeight / threadCount;
+        size_t depth = 1;
+        while (depth < remaining && 2 * (2LL << (depth + 1)) <= band / 4)
+            ++depth;
+        return depth;
+    }
+
+    /*
+        Prolaz niti `thread` kroz njen pojas izvora za nivoe [firstLevel, lastLevel).
+        Granice pojasa b_t = t * visina / broj niti; nivo j prolaza (redovi na razmaku 2^(j+1) u izvoru)
+        posjeduje redove [ceil(b_t / 2^(j+1)), ceil(b_(t+1) / 2^(j+1))), pa vlasnistvo dijeli svaki nivo bez preklapanja.
+        Redovi koje nit racuna su unija njenih redova i redova koje trebaju njeni redovi dubljih nivoa.
+    */
+    void streamBand(const Image& source, std::vector<Image>& pyramid, size_t firstLevel, size_t lastLevel,
+        int thread, int threadCount, std::vector<LevelStream>& levels) {
+        const long long bandFirst = static_cast<long long>(thread) * source.height / threadCount;
+        const long long bandLast = static_cast<long long>(thread + 1) * source.height / threadCount;
+
+        levels.resize(lastLevel - firstLevel);
+        for (size_t j = 0; j < levels.size(); ++j) {
+            LevelStream& stream = levels[j];
+            const Image& levelInput = j == 0 ? source : pyramid[firstLevel + j - 1];
+            const long long scale = 2LL << j;
+            stream.output = &pyramid[firstLevel + j];
+            stream.inWidth = levelInput.width;
+            stream.inHeight = levelInput.height;
+            stream.ownFirst = static_cast<int>((bandFirst + scale - 1) / scale);
+            stream.ownLast = static_cast<int>((bandLast + scale - 1) / scale);
+            stream.pushed = -1;
+            stream.ring.resize(static_cast<size_t>(stream.output->width) * 3 * lineCount);
+            stream.row.resize(stream.output->width);
+        }
+
+        for (size_t j = levels.size(); j-- > 0;) {
+            LevelStream& stream = levels[j];
+            stream.first = stream.ownFirst;
+            stream.last = stream.ownLast;
+            if (j + 1 < levels.size() && levels[j + 1].first < levels[j + 1].last) {
+                stream.first = std::min(stream.first, std::max(0, 2 * levels[j + 1].first - pyramidRadius));
+                stream.last = std::max(stream.last, std::min(stream.output->height, 2 * (levels[j + 1].last - 1) + pyramidRadius + 1));
+            }
+            stream.next = stream.first;
+        }
+
+        if (levels[0].first >= levels[0].last)
+            return;
+        int sourceFirst = std::max(0, 2 * levels[0].first - pyramidRadius);
+        int sourceLast = std::min(source.height, 2 * (levels[0].last - 1) + pyramidRadius + 1);
+        for (int y = sourceFirst; y < sourceLast; ++y)
+            pushRow(levels, 0, y, &source.pixels[static_cast<size_t>(y) * source.width]);
+    }
+}
+
+/*
+    Ova funkcija pravi Gausovu piramidu od najvise `levelCount` nivoa.
+    Povratni vektor ne sadrzi izvornu sliku: element 0 je slika upola manja od izvorne, element 1 cetvrtina itd.
+    Pravljenje nivoa se zaustavlja ranije ako bi sljedeci nivo bio manji od 1x1 piksela.
+    Svaki nivo koristi separabilni binomni filter i racuna samo piksele koji se zadrzavaju.
+    Svi nivoi se prave jednim prolazom kroz izvor: svaka nit prolazi kroz svoj pojas redova, a svaki nivo ima
+    prsten od 5 filtriranih redova, pa zavrseni red nivoa odmah, dok je u kesu, postaje ulaz sljedeceg nivoa
+    i nijedan medjurezultat velicine cijele slike se ne pravi. Kada je niti mnogo, a slika niska,
+    duboki nivoi se prave u dodatnom prolazu (vidi stageLevels) u istom paralelnom regionu, nakon barijere.
+*/
+std::vector<Image> buildGaussianPyramid(const Image& input, int levelCount) {
+    std::vector<Image> pyramid;
+    pyramid.reserve(std::max(0, levelCount));
+
+    int width = input.width, height = input.height;
+    for (int i = 0; i < levelCount && (width > 1 || height > 1); ++i) {
+        width = stridedSize(width, 2);
+        height = stridedSize(height, 2);
+        pyramid.emplace_back(width, height);
+    }
+
+    if (pyramid.empty())
+        return pyramid;
+
+    TRACE_SCOPE("gaussianPyramid");
+    TRACE_PARALLEL_REGION("gaussianPyramid");
+#pragma omp parallel
+    {
+        TRACE_THREAD_BUSY();
+        int thread = 0, threadCount = 1;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+        threadCount = omp_get_num_threads();
+#endif
+        std::vector<LevelStream> levels;
+        size_t first = 0;
+        while (first < pyramid.size()) {
+            const Image& source = first == 0 ? input : pyramid[first - 1];
+            size_t last = first + stageLevels(source.height, threadCount, pyramid.size() - first);
+            streamBand(source, pyramid, first, last, thread, threadCount, levels);
+            first = last;
+            if (first < pyramid.size()) {
+#pragma omp barrier
+            }
+        }
+    }
+
+    return pyramid;
+}
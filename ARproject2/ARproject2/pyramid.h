@@ -0,0 +1,7 @@
+#pragma once
+
+#include <vector>
+#include "image.h"
+
+// Gausova piramida: nivo i ima dimenzije stridedSize(sirina prethodnog nivoa, 2) x stridedSize(visina prethodnog nivoa, 2)
+std::vector<Image> buildGaussianPyramid(const Image& , int );
@@ -0,0 +1,445 @@
+#include "qoi.h"
+#include "tracing.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+    const uint8_t opIndex = 0x00;  // 00xxxxxx
+    const uint8_t opDiff = 0x40;   // 01xxxxxx
+    const uint8_t opLuma = 0x80;   // 10xxxxxx
+    const uint8_t opRun = 0xc0;    // 11xxxxxx
+    const uint8_t opRGB = 0xfe;
+    const uint8_t opRGBA = 0xff;
+    const uint8_t tagMask = 0xc0;
+
+    const uint8_t endMarker[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+    const size_t bufferSize = 64 * 1024;
+
+    /*
+        Pikseli se u koderu drze kao jedan 32-bitni broj (crvena, zelena, plava, alfa od najnizeg bajta),
+        pa se poredjenje i upis u tabelu svode na jednu operaciju.
+    */
+    inline uint32_t packPixel(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+        return r | (g << 8) | (b << 16) | (static_cast<uint32_t>(a) << 24);
+    }
+
+    inline uint8_t red(uint32_t p) { return static_cast<uint8_t>(p); }
+    inline uint8_t green(uint32_t p) { return static_cast<uint8_t>(p >> 8); }
+    inline uint8_t blue(uint32_t p) { return static_cast<uint8_t>(p >> 16); }
+    inline uint8_t alpha(uint32_t p) { return static_cast<uint8_t>(p >> 24); }
+
+    inline int hashPixel(uint32_t p) {
+        return (red(p) * 3 + green(p) * 5 + blue(p) * 7 + alpha(p) * 11) % 64;
+    }
+
+    inline uint32_t toPacked(const Gray& p) { return packPixel(p.value, p.value, p.value, 255); }
+    inline uint32_t toPacked(const Color& p) { return packPixel(p.red, p.green, p.blue, 255); }
+    inline uint32_t toPacked(const ColorA& p) { return packPixel(p.red, p.green, p.blue, p.alpha); }
+
+    inline void fromPacked(uint32_t p, Gray& out) { out.value = static_cast<uint8_t>((29 * blue(p) + 150 * green(p) + 77 * red(p) + 128) >> 8); }
+    inline void fromPacked(uint32_t p, Color& out) { out = Color(blue(p), green(p), red(p)); }
+    inline void fromPacked(uint32_t p, ColorA& out) { out = ColorA(blue(p), green(p), red(p), alpha(p)); }
+
+    void writeBigEndian(uint8_t* out, uint32_t value) {
+        out[0] = static_cast<uint8_t>(value >> 24);
+        out[1] = static_cast<uint8_t>(value >> 16);
+        out[2] = static_cast<uint8_t>(value >> 8);
+        out[3] = static_cast<uint8_t>(value);
+    }
+
+    uint32_t readBigEndian(const uint8_t* in) {
+        return (static_cast<uint32_t>(in[0]) << 24) | (in[1] << 16) | (in[2] << 8) | in[3];
+    }
+}
+
+QoiEncoder::QoiEncoder(std::ostream& out, int width, int height, int channels)
+    : out(out), buffer(bufferSize), used(0), previous(packPixel(0, 0, 0, 255)), run(0), finished(false) {
+    memset(index, 0, sizeof(index));
+
+    // Zaglavlje: "qoif", sirina, visina (big-endian), broj kanala (3 ili 4), prostor boja (0 = sRGB)
+    uint8_t header[14] = { 'q', 'o', 'i', 'f' };
+    writeBigEndian(header + 4, static_cast<uint32_t>(width));
+    writeBigEndian(header + 8, static_cast<uint32_t>(height));
+    header[12] = static_cast<uint8_t>(channels == 4 ? 4 : 3);
+    header[13] = 0;
+    memcpy(buffer.data(), header, sizeof(header));
+    used = sizeof(header);
+}
+
+QoiEncoder::~QoiEncoder() {
+    finish();
+}
+
+void QoiEncoder::flush() {
+    out.write(reinterpret_cast<const char*>(buffer.data()), used);
+    used = 0;
+}
+
+inline void QoiEncoder::encode(uint32_t pixel) {
+    // Najduza operacija je 5 bajta (RGBA), pa se bafer prazni malo prije nego sto se napuni
+    if (used + 8 > buffer.size())
+        flush();
+    uint8_t* outBytes = buffer.data();
+
+    if (pixel == previous) {
+        if (++run == 62) {
+            outBytes[used++] = static_cast<uint8_t>(opRun | (run - 1));
+            run = 0;
+        }
+        return;
+    }
+
+    if (run > 0) {
+        outBytes[used++] = static_cast<uint8_t>(opRun | (run - 1));
+        run = 0;
+    }
+
+    int hash = hashPixel(pixel);
+    if (index[hash] == pixel) {
+        outBytes[used++] = static_cast<uint8_t>(opIndex | hash);
+    }
+    else {
+        index[hash] = pixel;
+
+        if (alpha(pixel) == alpha(previous)) {
+            int8_t dr = static_cast<int8_t>(red(pixel) - red(previous));
+            int8_t dg = static_cast<int8_t>(green(pixel) - green(previous));
+            int8_t db = static_cast<int8_t>(blue(pixel) - blue(previous));
+            int8_t dgr = static_cast<int8_t>(dr - dg);
+            int8_t dgb = static_cast<int8_t>(db - dg);
+
+            if (dr > -3 && dr < 2 && dg > -3 && dg < 2 && db > -3 && db < 2) {
+                outBytes[used++] = static_cast<uint8_t>(opDiff | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2));
+            }
+            else if (dgr > -9 && dgr < 8 && dg > -33 && dg < 32 && dgb > -9 && dgb < 8) {
+                outBytes[used++] = static_cast<uint8_t>(opLuma | (dg + 32));
+                outBytes[used++] = static_cast<uint8_t>(((dgr + 8) << 4) | (dgb + 8));
+            }
+            else {
+                outBytes[used++] = opRGB;
+                outBytes[used++] = red(pixel);
+                outBytes[used++] = green(pixel);
+                outBytes[used++] = blue(pixel);
+            }
+        }
+        else {
+            outBytes[used++] = opRGBA;
+            outBytes[used++] = red(pixel);
+            outBytes[used++] = green(pixel);
+            outBytes[used++] = blue(pixel);
+            outBytes[used++] = alpha(pixel);
+        }
+    }
+
+    previous = pixel;
+}
+
+template <typename PixelT>
+void QoiEncoder::writePixels(const PixelT* pixels, size_t count) {
+    for (size_t i = 0; i < count; ++i)
+        encode(toPacked(pixels[i]));
+}
+
+void QoiEncoder::write(const Gray* pixels, size_t count) { writePixels(pixels, count); }
+void QoiEncoder::write(const Color* pixels, size_t count) { writePixels(pixels, count); }
+void QoiEncoder::write(const ColorA* pixels, size_t count) { writePixels(pixels, count); }
+
+void QoiEncoder::finish() {
+    if (finished)
+        return;
+    finished = true;
+
+    if (used + 1 + sizeof(endMarker) > buffer.size())
+        flush();
+    if (run > 0)
+        buffer[used++] = static_cast<uint8_t>(opRun | (run - 1));
+    run = 0;
+    memcpy(buffer.data() + used, endMarker, sizeof(endMarker));
+    used += sizeof(endMarker);
+    flush();
+}
+
+QoiDecoder::QoiDecoder(std::istream& in)
+    : in(in), buffer(bufferSize), position(0), available(0), consumed(0), previous(packPixel(0, 0, 0, 255)), run(0),
+      isValid(false), isTooLarge(false), imageWidth(0), imageHeight(0), imageChannels(0) {
+    memset(index, 0, sizeof(index));
+
+    uint8_t header[14];
+    in.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!in || memcmp(header, "qoif", 4) != 0)
+        return;
+    consumed = sizeof(header);
+
+    // Dimenzije se provjeravaju kao neoznaceni brojevi, prije pretvaranja u int
+    uint32_t width = readBigEndian(header + 4);
+    uint32_t height = readBigEndian(header + 8);
+    isTooLarge = static_cast<unsigned long long>(width) * height > static_cast<unsigned long long>(maxPixels);
+    if (isTooLarge)
+        return;
+    imageWidth = static_cast<int>(width);
+    imageHeight = static_cast<int>(height);
+    imageChannels = header[12];
+    isValid = imageWidth > 0 && imageHeight > 0 && (imageChannels == 3 || imageChannels == 4);
+}
+
+inline bool QoiDecoder::nextByte(uint8_t& value) {
+    if (position == available) {
+        consumed += available;
+        in.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+        available = static_cast<size_t>(in.gcount());
+        position = 0;
+        if (available == 0)
+            return false;
+    }
+    value = buffer[position++];
+    return true;
+}
+
+inline bool QoiDecoder::decode(uint32_t& pixel) {
+    if (run > 0) {
+        --run;
+        pixel = previous;
+        return true;
+    }
+
+    uint8_t op;
+    if (!nextByte(op))
+        return false;
+
+    if (op == opRGB || op == opRGBA) {
+        uint8_t r, g, b, a = alpha(previous);
+        if (!nextByte(r) || !nextByte(g) || !nextByte(b) || (op == opRGBA && !nextByte(a)))
+            return false;
+        pixel = packPixel(r, g, b, a);
+    }
+    else if ((op & tagMask) == opIndex) {
+        pixel = index[op];
+    }
+    else if ((op & tagMask) == opDiff) {
+        pixel = packPixel(static_cast<uint8_t>(red(previous) + ((op >> 4) & 3) - 2),
+            static_cast<uint8_t>(green(previous) + ((op >> 2) & 3) - 2),
+            static_cast<uint8_t>(blue(previous) + (op & 3) - 2), alpha(previous));
+    }
+    else if ((op & tagMask) == opLuma) {
+        uint8_t second;
+        if (!nextByte(second))
+            return false;
+        int dg = (op & 0x3f) - 32;
+        pixel = packPixel(static_cast<uint8_t>(red(previous) + dg - 8 + ((second >> 4) & 0x0f)),
+            static_cast<uint8_t>(green(previous) + dg),
+            static_cast<uint8_t>(blue(previous) + dg - 8 + (second & 0x0f)), alpha(previous));
+    }
+    else {
+        run = op & 0x3f;
+        pixel = previous;
+    }
+
+    index[hashPixel(pixel)] = pixel;
+    previous = pixel;
+    return true;
+}
+
+template <typename PixelT>
+bool QoiDecoder::readPixels(PixelT* pixels, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t pixel;
+        if (!decode(pixel))
+            return false;
+        fromPacked(pixel, pixels[i]);
+    }
+    return true;
+}
+
+bool QoiDecoder::read(Gray* pixels, size_t count) { return readPixels(pixels, count); }
+bool QoiDecoder::read(Color* pixels, size_t count) { return readPixels(pixels, count); }
+bool QoiDecoder::read(ColorA* pixels, size_t count) { return readPixels(pixels, count); }
+
+namespace {
+    // Otvaranje QOI fajla; vraca false i opis greske (sa razlogom iz errno) ako fajl nije moguce otvoriti
+    bool openQOI(std::ifstream& file, const std::string& filename, std::string& error) {
+        errno = 0;
+        file.open(filename, std::ios::binary);
+        if (!file) {
+            error = "Nije moguće otvoriti fajl: " + filename + " (" + strerror(errno ? errno : EIO) + ")";
+            return false;
+        }
+        return true;
+    }
+
+    // Provjera zaglavlja prije alokacije ili dekodiranja
+    bool checkQOIHeader(const QoiDecoder& decoder, const std::string& filename, std::string& error) {
+        if (decoder.tooLarge()) {
+            error = "QOI slika je prevelika (najviše " + std::to_string(QoiDecoder::maxPixels) + " piksela): " + filename;
+            return false;
+        }
+        if (!decoder.valid()) {
+            error = "Nevažeći QOI format: " + filename;
+            return false;
+        }
+        return true;
+    }
+
+    template <typename PixelT>
+    bool decodeQOIPixels(QoiDecoder& decoder, const BasicImageView<PixelT>& view, const std::string& filename, std::string& error) {
+        for (int y = 0; y < view.height; ++y) {
+            if (!decoder.read(view.row(y), view.width)) {
+                error = "QOI fajl je oštećen ili skraćen: " + filename;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+/*
+    Ucitavanje QOI slike u sliku sa pikselima tipa PixelT, bez prekidanja programa:
+    za nepostojeci, neispravan ili skracen fajl vraca false i opis greske, a `image` ostaje nepromijenjena.
+    Dekodira se red po red direktno u piksele slike.
+*/
+template <typename PixelT>
+bool tryLoadQOI(const std::string& filename, BasicImage<PixelT>& image, std::string& error) {
+    TRACE_SCOPE("loadQOI");
+
+    std::ifstream file;
+    if (!openQOI(file, filename, error))
+        return false;
+    QoiDecoder decoder(file);
+    if (!checkQOIHeader(decoder, filename, error))
+        return false;
+
+    BasicImage<PixelT> decoded(decoder.width(), decoder.height());
+    if (!decodeQOIPixels(decoder, BasicImageView<PixelT>(decoded), filename, error))
+        return false;
+
+    TRACE_PIXELS(decoded.pixels.size());
+    TRACE_BYTES_READ(decoder.bytesConsumed());
+
+    image = std::move(decoded);
+    return true;
+}
+
+template bool tryLoadQOI<Gray>(const std::string&, GrayImage&, std::string&);
+template bool tryLoadQOI<Color>(const std::string&, Image&, std::string&);
+template bool tryLoadQOI<ColorA>(const std::string&, ImageBGRA&, std::string&);
+
+/*
+    Funkcija za ucitavanje QOI slike u sliku sa pikselima tipa PixelT.
+    Greske se obradjuju kao kod ucitavanja BMP fajlova (poruka i prekid programa).
+*/
+template <typename PixelT>
+BasicImage<PixelT> loadQOI(const std::string& filename) {
+    BasicImage<PixelT> image(0, 0);
+    std::string error;
+    if (!tryLoadQOI(filename, image, error)) {
+        std::cerr << error << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return image;
+}
+
+template GrayImage loadQOI<Gray>(const std::string&);
+template Image loadQOI<Color>(const std::string&);
+template ImageBGRA loadQOI<ColorA>(const std::string&);
+
+template <typename PixelT>
+void loadQOI(const std::string& filename, const BasicImageView<PixelT>& view) {
+    TRACE_SCOPE("loadQOI");
+
+    std::ifstream file;
+    std::string error;
+    if (!openQOI(file, filename, error)) {
+        std::cerr << error << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    QoiDecoder decoder(file);
+    if (!checkQOIHeader(decoder, filename, error)) {
+        std::cerr << error << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (decoder.width() != view.width || decoder.height() != view.height) {
+        std::cerr << "Dimenzije QOI slike se ne poklapaju sa pogledom: " << filename << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (!decodeQOIPixels(decoder, view, filename, error)) {
+        std::cerr << error << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    TRACE_PIXELS(static_cast<long long>(view.width) * view.height);
+    TRACE_BYTES_READ(decoder.bytesConsumed());
+}
+
+template void loadQOI<Gray>(const std::string&, const GrayImageView&);
+template void loadQOI<Color>(const std::string&, const ImageView&);
+template void loadQOI<ColorA>(const std::string&, const ImageBGRAView&);
+
+namespace {
+    // Kodiranje i upis; vraca false i opis greske ako fajl nije moguce otvoriti ili upis nije uspio (npr. pun disk)
+    template <typename PixelT>
+    bool writeQOIImage(const std::string& filename, const BasicImageView<const PixelT>& image, std::string& error) {
+        TRACE_SCOPE("saveQOI");
+
+        errno = 0;
+        std::ofstream file(filename, std::ios::binary);
+        if (!file) {
+            error = "Nije moguće otvoriti fajl za čuvanje: " + filename + " (" + strerror(errno ? errno : EIO) + ")";
+            return false;
+        }
+
+        QoiEncoder encoder(file, image.width, image.height, PixelTraits<PixelT>::channels == 4 ? 4 : 3);
+        for (int y = 0; y < image.height; ++y)
+            encoder.write(image.row(y), image.width);
+        encoder.finish();
+        file.flush();
+        if (!file) {
+            error = "Greška pri upisu fajla: " + filename;
+            return false;
+        }
+
+        TRACE_PIXELS(static_cast<long long>(image.width) * image.height);
+        TRACE_BYTES_WRITTEN(file.tellp());
+        return true;
+    }
+
+    // Greske se obradjuju kao kod cuvanja BMP fajlova (poruka i prekid programa)
+    template <typename PixelT>
+    void saveQOIImage(const std::string& filename, const BasicImageView<const PixelT>& image) {
+        std::string error;
+        if (!writeQOIImage(filename, image, error)) {
+            std::cerr << error << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+// Siva slika se cuva kao 3-kanalna (QOI nema 1-kanalni format); ponovljeni kanali se dobro kompresuju
+void saveQOI(const std::string& filename, const GrayImage& image) {
+    saveQOIImage(filename, ConstGrayImageView(image));
+}
+
+void saveQOI(const std::string& filename, const Image& image) {
+    saveQOIImage(filename, ConstImageView(image));
+}
+
+void saveQOI(const std::string& filename, const ImageBGRA& image) {
+    saveQOIImage(filename, ConstImageBGRAView(image));
+}
+
+void saveQOI(const std::string& filename, const ConstGrayImageView& image) {
+    saveQOIImage(filename, image);
+}
+
+void saveQOI(const std::string& filename, const ConstImageView& image) {
+    saveQOIImage(filename, image);
+}
+
+void saveQOI(const std::string& filename, const ConstImageBGRAView& image) {
+    saveQOIImage(filename, image);
+}
+
+bool trySaveQOI(const std::string& filename, const ConstImageView& image, std::string& error) {
+    return writeQOIImage(filename, image, error);
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "image.h"
+
+/*
+    QOI ("Quite OK Image") kodek bez gubitaka, implementiran bez spoljnih biblioteka.
+    Pikseli se kodiraju jednim prolazom: ponavljanje prethodnog piksela (run), indeks u tabeli
+    od 64 nedavno vidjena piksela, mala razlika u odnosu na prethodni piksel (1 ili 2 bajta)
+    ili puna vrijednost. Na fotografijama i rezultatima filtriranja fajl je obicno 2-4 puta manji od BMP-a.
+
+    Koder i dekoder rade u protoku (streaming): pikseli se predaju ili citaju u proizvoljnim dijelovima
+    (npr. red po red), a kodirani bajtovi se upisuju/citaju kroz mali bafer, bez drzanja cijelog fajla u memoriji.
+*/
+class QoiEncoder {
+public:
+    QoiEncoder(std::ostream& , int , int , int );
+    ~QoiEncoder();
+
+    void write(const Gray* , size_t );
+    void write(const Color* , size_t );
+    void write(const ColorA* , size_t );
+
+    // Zavrsava tok (nedovrseni run i zavrsni marker); poziva se jednom, nakon svih piksela
+    void finish();
+
+private:
+    std::ostream& out;
+    std::vector<uint8_t> buffer;
+    size_t used;
+    uint32_t index[64];
+    uint32_t previous;
+    int run;
+    bool finished;
+
+    void encode(uint32_t );
+    void flush();
+    template <typename PixelT> void writePixels(const PixelT* , size_t );
+};
+
+class QoiDecoder {
+public:
+    // Najveci broj piksela koji se prihvata (kao u referentnoj implementaciji); vece zaglavlje nije valid(),
+    // pa ostecen fajl ne moze traziti gigabajte memorije prije nego sto se ijedan piksel dekodira
+    static constexpr long long maxPixels = 400000000;
+
+    explicit QoiDecoder(std::istream& );
+
+    bool valid() const { return isValid; }
+    bool tooLarge() const { return isTooLarge; }
+    int width() const { return imageWidth; }
+    int height() const { return imageHeight; }
+    int channels() const { return imageChannels; }
+
+    bool read(Gray* , size_t );
+    bool read(Color* , size_t );
+    bool read(ColorA* , size_t );
+
+    // Broj bajtova toka koje je dekoder do sada potrosio (zaglavlje i kodirani pikseli, bez procitanih unaprijed)
+    size_t bytesConsumed() const { return consumed + position; }
+
+private:
+    std::istream& in;
+    std::vector<uint8_t> buffer;
+    size_t position, available;
+    size_t consumed;  // bajtovi zaglavlja i ranije potrosenih punjenja bafera
+    uint32_t index[64];
+    uint32_t previous;
+    int run;
+    bool isValid, isTooLarge;
+    int imageWidth, imageHeight, imageChannels;
+
+    bool nextByte(uint8_t& );
+    bool decode(uint32_t& );
+    template <typename PixelT> bool readPixels(PixelT* , size_t );
+};
+
+template <typename PixelT>
+BasicImage<PixelT> loadQOI(const std::string& );
+
+// Kao loadQOI, ali za nepostojeci, neispravan ili skracen fajl vraca false i opis greske umjesto da prekine program
+template <typename PixelT>
+bool tryLoadQOI(const std::string& , BasicImage<PixelT>& , std::string& );
+
+// Ucitavanje QOI fajla u postojeci pogled (dimenzije fajla i pogleda moraju biti iste)
+template <typename PixelT>
+void loadQOI(const std::string& , const BasicImageView<PixelT>& );
+
+void saveQOI(const std::string& , const GrayImage& );
+
+void saveQOI(const std::string& , const Image& );
+
+void saveQOI(const std::string& , const ImageBGRA& );
+
+void saveQOI(const std::string& , const ConstGrayImageView& );
+
+void saveQOI(const std::string& , const ConstImageView& );
+
+void saveQOI(const std::string& , const ConstImageBGRAView& );
+
+// Kao saveQOI, ali za gresku pri otvaranju ili upisu vraca false i opis greske umjesto da prekine program
+bool trySaveQOI(const std::string& , const ConstImageView& , std::string& );
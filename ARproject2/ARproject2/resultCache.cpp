@@ -0,0 +1,308 @@
+#include "resultCache.h"
+#include "autoTuner.h"
+#include "qoi.h"
+#include "tracing.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+    const uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+    const uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+    const uint64_t prime3 = 0x165667B19E3779F9ULL;
+    const uint64_t prime4 = 0x85EBCA77C2B2AE63ULL;
+    const uint64_t prime5 = 0x27D4EB2F165667C5ULL;
+
+    inline uint64_t rotateLeft(uint64_t value, int bits) {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    inline uint64_t readWord(const uint8_t* p) {
+        uint64_t value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    inline uint64_t mixRound(uint64_t accumulator, uint64_t input) {
+        accumulator += input * prime2;
+        accumulator = rotateLeft(accumulator, 31);
+        return accumulator * prime1;
+    }
+
+    inline uint64_t mergeRound(uint64_t hash, uint64_t lane) {
+        hash ^= mixRound(0, lane);
+        return hash * prime1 + prime4;
+    }
+}
+
+/*
+    Funkcija za racunanje 64-bitnog hesa niza bajtova.
+    Podaci se obradjuju u cetiri nezavisne trake po 8 bajta, pa procesor moze da preklopi mnozenja;
+    hesiranje je znatno brze od citanja slike sa diska, pa ponovljeni posao ostaje vezan za I/O.
+*/
+uint64_t hashBytes(const void* data, size_t length, uint64_t seed) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const uint8_t* end = p + length;
+    uint64_t hash;
+
+    if (length >= 32) {
+        uint64_t v1 = seed + prime1 + prime2;
+        uint64_t v2 = seed + prime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - prime1;
+        const uint8_t* limit = end - 32;
+        do {
+            v1 = mixRound(v1, readWord(p));
+            v2 = mixRound(v2, readWord(p + 8));
+            v3 = mixRound(v3, readWord(p + 16));
+            v4 = mixRound(v4, readWord(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        hash = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+        hash = mergeRound(hash, v1);
+        hash = mergeRound(hash, v2);
+        hash = mergeRound(hash, v3);
+        hash = mergeRound(hash, v4);
+    }
+    else {
+        hash = seed + prime5;
+    }
+
+    hash += static_cast<uint64_t>(length);
+
+    for (; p + 8 <= end; p += 8) {
+        hash ^= mixRound(0, readWord(p));
+        hash = rotateLeft(hash, 27) * prime1 + prime4;
+    }
+    if (p + 4 <= end) {
+        uint32_t word;
+        memcpy(&word, p, sizeof(word));
+        hash ^= static_cast<uint64_t>(word) * prime1;
+        hash = rotateLeft(hash, 23) * prime2 + prime3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        hash ^= (*p) * prime5;
+        hash = rotateLeft(hash, 11) * prime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= prime2;
+    hash ^= hash >> 29;
+    hash *= prime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+ResultCache::ResultCache(const std::string& directory, uint64_t capacityBytes)
+    : directory(directory), capacityBytes(capacityBytes), totalBytes(0), hitCount(0), missCount(0), evictionCount(0) {
+    std::error_code error;
+    fs::create_directories(directory, error);
+
+    // Postojeci unosi se ucitavaju sortirani po vremenu izmjene (najskoriji prvi)
+    std::vector<std::pair<fs::file_time_type, Entry>> found;
+    for (const fs::directory_entry& file : fs::directory_iterator(directory, error)) {
+        std::string name = file.path().filename().string();
+        if (name.size() != 20 || file.path().extension() != ".qoi")
+            continue;
+
+        char* parsedEnd = nullptr;
+        uint64_t key = std::strtoull(name.c_str(), &parsedEnd, 16);
+        if (parsedEnd != name.c_str() + 16)
+            continue;
+
+        Entry entry = { key, static_cast<uint64_t>(file.file_size(error)) };
+        found.emplace_back(file.last_write_time(error), entry);
+    }
+    std::sort(found.begin(), found.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    for (const auto& item : found) {
+        recent.push_back(item.second);
+        entries[item.second.key] = std::prev(recent.end());
+        totalBytes += item.second.bytes;
+    }
+    evict();
+}
+
+ResultCache* ResultCache::fromEnvironment() {
+    static ResultCache* cache = []() -> ResultCache* {
+        const char* directory = std::getenv("CONVOLUTION_CACHE_DIR");
+        if (directory == nullptr || *directory == '\0')
+            return nullptr;
+
+        // Velicina mora biti pozitivan cijeli broj megabajta (0 bi izbacio svaki unos odmah nakon upisa)
+        uint64_t megabytes = 1024;
+        if (const char* size = std::getenv("CONVOLUTION_CACHE_MB")) {
+            char* parsedEnd = nullptr;
+            errno = 0;
+            unsigned long long parsed = std::strtoull(size, &parsedEnd, 10);
+            if (errno != 0 || parsedEnd == size || *parsedEnd != '\0' || strchr(size, '-') != nullptr || parsed == 0 || parsed > UINT64_MAX / (1024 * 1024))
+                std::cerr << "Neispravna velicina kesa CONVOLUTION_CACHE_MB=" << size << ", koristi se " << megabytes << " MB." << std::endl;
+            else
+                megabytes = parsed;
+        }
+
+        static ResultCache environmentCache(directory, megabytes * 1024 * 1024);
+        return &environmentCache;
+    }();
+    return cache;
+}
+
+/*
+    Funkcija za formiranje kljuca kesa.
+    Dimenzije, kernel, nacin obrade ivica i nacin racunanja se hesiraju zajedno sa pikselima, pa ista slika sa
+    drugim kernelom (ili slika drugacijih dimenzija sa istim bajtovima, ili rezultat drugog nacina) daje drugaciji kljuc.
+*/
+uint64_t ResultCache::makeKey(const Image& input, const std::vector<float>& kernel, BorderMode border, ConvolutionBackend backend) {
+    TRACE_SCOPE("cacheKey");
+
+    int32_t header[4] = { input.width, input.height, static_cast<int32_t>(border), static_cast<int32_t>(backend) };
+    uint64_t hash = hashBytes(header, sizeof(header), 0);
+    hash = hashBytes(kernel.data(), kernel.size() * sizeof(float), hash);
+    hash = hashBytes(input.pixels.data(), input.pixels.size() * sizeof(Color), hash);
+
+    TRACE_BYTES_READ(input.pixels.size() * sizeof(Color));
+    return hash;
+}
+
+std::string ResultCache::pathFor(uint64_t key) const {
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << key << ".qoi";
+    return (fs::path(directory) / name.str()).string();
+}
+
+void ResultCache::remove(std::list<Entry>::iterator entry) {
+    std::error_code error;
+    fs::remove(pathFor(entry->key), error);
+    totalBytes -= entry->bytes;
+    entries.erase(entry->key);
+    recent.erase(entry);
+}
+
+void ResultCache::evict() {
+    while (totalBytes > capacityBytes && !recent.empty()) {
+        remove(std::prev(recent.end()));
+        ++evictionCount;
+    }
+}
+
+/*
+    Funkcija za citanje rezultata iz kesa.
+    Pogodak pomjera unos na pocetak LRU liste i osvjezava vrijeme izmjene fajla.
+    Ostecen fajl se brise i racuna kao promasaj; ispravan fajl drugacijih dimenzija od izlaza
+    (npr. poziv sa pogresnom izlaznom slikom) je samo promasaj, a unos ostaje u kesu.
+*/
+bool ResultCache::lookup(uint64_t key, Image& output) {
+    TRACE_SCOPE("cacheLookup");
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto found = entries.find(key);
+    if (found == entries.end()) {
+        ++missCount;
+        return false;
+    }
+
+    std::string path = pathFor(key);
+    bool loaded = false, sizeMismatch = false;
+    {
+        std::ifstream file(path, std::ios::binary);
+        QoiDecoder decoder(file);
+        sizeMismatch = decoder.valid() && (decoder.width() != output.width || decoder.height() != output.height);
+        if (decoder.valid() && !sizeMismatch)
+            loaded = decoder.read(output.pixels.data(), output.pixels.size());
+    }
+
+    if (!loaded) {
+        if (!sizeMismatch)
+            remove(found->second);
+        ++missCount;
+        return false;
+    }
+
+    recent.splice(recent.begin(), recent, found->second);
+    std::error_code error;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+
+    ++hitCount;
+    TRACE_PIXELS(output.pixels.size());
+    return true;
+}
+
+/*
+    Funkcija za upis rezultata u kes.
+    Fajl se prvo pise pod privremenim imenom pa se preimenuje, kako prekinut upis ne bi ostavio
+    nepotpun unos koji bi se kasnije procitao kao pogodak.
+*/
+void ResultCache::store(uint64_t key, const Image& output) {
+    TRACE_SCOPE("cacheStore");
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto found = entries.find(key);
+    if (found != entries.end())
+        remove(found->second);
+
+    std::string path = pathFor(key);
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary);
+        if (!file)
+            return;
+        QoiEncoder encoder(file, output.width, output.height, 3);
+        encoder.write(output.pixels.data(), output.pixels.size());
+        encoder.finish();
+        if (!file)
+            return;
+    }
+
+    std::error_code error;
+    fs::rename(temporaryPath, path, error);
+    if (error) {
+        fs::remove(temporaryPath, error);
+        return;
+    }
+
+    Entry entry = { key, static_cast<uint64_t>(fs::file_size(path, error)) };
+    recent.push_front(entry);
+    entries[key] = recent.begin();
+    totalBytes += entry.bytes;
+    TRACE_BYTES_WRITTEN(entry.bytes);
+
+    evict();
+}
+
+void ResultCache::printStats(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    out << "Kes rezultata: pogodaka " << hitCount << ", promasaja " << missCount
+        << ", izbacenih " << evictionCount << ", unosa " << entries.size()
+        << " (" << totalBytes / (1024.0 * 1024.0) << " MB od " << capacityBytes / (1024.0 * 1024.0) << " MB)" << std::endl;
+}
+
+/*
+    Funkcija za konvoluciju preko kesa. Vraca true ako je rezultat procitan iz kesa.
+    Bez ukljucenog kesa se ponasa isto kao obicna konvolucija. Racuna se nacinom iz profila podesavanja (convolutionTuned).
+*/
+bool cachedConvolution(const Image& input, const std::vector<float>& kernel, Image& output, BorderMode border) {
+    ResultCache* cache = ResultCache::fromEnvironment();
+    if (cache == nullptr) {
+        convolutionTuned(input, kernel, output, border);
+        return false;
+    }
+
+    uint64_t key = ResultCache::makeKey(input, kernel, border, tunedBackend(input, kernel));
+    if (cache->lookup(key, output))
+        return true;
+
+    convolutionTuned(input, kernel, output, border);
+    cache->store(key, output);
+    return false;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "image.h"
+#include "convolution.h"
+#include "autoTuner.h"
+
+/*
+    Kes rezultata konvolucije na disku, adresiran sadrzajem.
+    Kljuc je 64-bitni hes piksela ulazne slike, dimenzija, vrijednosti kernela, nacina obrade ivica
+    i nacina racunanja (separabilni nacin se od direktnog moze razlikovati za +/-1).
+    Rezultati se cuvaju kao QOI fajlovi "<kljuc>.qoi" u zadatom folderu. Kada ukupna velicina predje
+    ograničenje, brisu se najdavnije koristeni unosi (LRU); vrijeme posljednjeg koristenja je vrijeme
+    izmjene fajla, pa redoslijed prezivljava ponovno pokretanje programa.
+
+    Kes je opcionalan: ukljucuje se promjenljivom okruzenja CONVOLUTION_CACHE_DIR, a velicina se
+    zadaje sa CONVOLUTION_CACHE_MB (pozitivan cijeli broj, podrazumijevano 1024 MB).
+    Statistiku ispisuje printStats(); objekat kesa ne pise nista sam (npr. pri unistavanju na kraju programa).
+*/
+class ResultCache {
+public:
+    ResultCache(const std::string& , uint64_t );
+
+    // Kes podesen iz promjenljivih okruzenja ili nullptr ako kes nije ukljucen
+    static ResultCache* fromEnvironment();
+
+    static uint64_t makeKey(const Image& , const std::vector<float>& , BorderMode , ConvolutionBackend );
+
+    bool lookup(uint64_t , Image& );
+    void store(uint64_t , const Image& );
+
+    uint64_t hits() const { return hitCount; }
+    uint64_t misses() const { return missCount; }
+    uint64_t evictions() const { return evictionCount; }
+    uint64_t sizeBytes() const { return totalBytes; }
+
+    void printStats(std::ostream& ) const;
+
+private:
+    struct Entry {
+        uint64_t key;
+        uint64_t bytes;
+    };
+
+    std::string directory;
+    uint64_t capacityBytes;
+    uint64_t totalBytes;
+    uint64_t hitCount, missCount, evictionCount;
+
+    // Najskorije koristeni unosi su na pocetku liste
+    std::list<Entry> recent;
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> entries;
+    mutable std::mutex mutex;
+
+    std::string pathFor(uint64_t ) const;
+    void remove(std::list<Entry>::iterator );
+    void evict();
+};
+
+// Brzi 64-bitni hes bajtova (nije kriptografski), po uzoru na xxHash64
+uint64_t hashBytes(const void* , size_t , uint64_t );
+
+// Konvolucija koja rezultat prvo trazi u kesu (ako je ukljucen), a izracunati rezultat upisuje u kes
+bool cachedConvolution(const Image& , const std::vector<float>& , Image& , BorderMode = BorderMode::Replicate);
@@ -0,0 +1,367 @@
+#include "scalingStudy.h"
+#include "tracing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+
+    typedef std::chrono::steady_clock Clock;
+
+    int maxThreads() {
+#ifdef _OPENMP
+        return omp_get_max_threads();
+#else
+        return 1;
+#endif
+    }
+
+    void setThreads(int threads) {
+#ifdef _OPENMP
+        omp_set_num_threads(std::max(1, threads));
+#else
+        (void)threads;
+#endif
+    }
+
+    /*
+        Vrijeme jednog poziva u milisekundama, najbolje od `repetitions` mjerenja.
+        Jedno mjerenje ponavlja poziv dok ne protekne bar `minBatchSeconds`, pa je i za slike od nekoliko
+        mikrosekundi vrijeme mnogo vece od preciznosti sata; velike slike se mjere jednim pozivom.
+        Prvo mjerenje ujedno zagrijava kes i pokrece niti OpenMP-a, pa se najbolje mjerenje ne odnosi na hladan start.
+    */
+    template <typename Function>
+    double measureMilliseconds(Function run, int repetitions, double minBatchSeconds) {
+        double best = -1.0;
+        for (int repetition = 0; repetition < std::max(1, repetitions); ++repetition) {
+            int iterations = 0;
+            double seconds = 0.0;
+            auto start = Clock::now();
+            do {
+                run();
+                ++iterations;
+                seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            } while (seconds < minBatchSeconds);
+
+            double milliseconds = seconds * 1000.0 / iterations;
+            if (best < 0.0 || milliseconds < best)
+                best = milliseconds;
+        }
+        return best;
+    }
+
+    void runBackend(ConvolutionBackend backend, int tileSize, const Image& input, const std::vector<float>& kernel,
+        const std::vector<float>& column, const std::vector<float>& row, Image& output) {
+        switch (backend) {
+        case ConvolutionBackend::Tiled:
+            convolutionTiled(input, kernel, output, BorderMode::Replicate, tileSize);
+            break;
+        case ConvolutionBackend::Separable:
+            convolutionSeparable(input, column, row, output, BorderMode::Replicate);
+            break;
+        default:
+            convolution(input, kernel, output, BorderMode::Replicate);
+            break;
+        }
+    }
+
+    // Najmanji saobracaj sa memorijom: svaki ulazni piksel se procita i svaki izlazni upise jednom
+    double compulsoryBytes(long long pixels) {
+        return 2.0 * sizeof(Color) * static_cast<double>(pixels);
+    }
+
+    // Jedan red CSV fajla
+    struct Row {
+        const char* study;
+        const char* backend;
+        int kernelSize;
+        long long width, height;
+        int threads;
+        double milliseconds;
+        double megapixelsPerSecond;
+        double speedup;
+        double efficiency;
+        double gigabytesPerSecond;
+    };
+
+    void writeRow(std::ofstream& csv, const Row& row, double peakBandwidth) {
+        csv << row.study << "," << row.backend << "," << row.kernelSize << "," << row.width << "," << row.height << "," << row.threads
+            << "," << row.milliseconds << "," << row.megapixelsPerSecond << "," << row.speedup << "," << row.efficiency
+            << "," << row.gigabytesPerSecond << "," << (peakBandwidth > 0.0 ? row.gigabytesPerSecond / peakBandwidth : 0.0) << std::endl;
+    }
+
+    // Rezultat jakog skaliranja za jednu velicinu slike: jedna nit i najbolji broj niti veci od jedan
+    struct StrongResult {
+        int size;
+        double singleThread;
+        double bestParallel;
+        int bestThreads;
+    };
+
+    Image randomImage(int width, int height, std::mt19937& random) {
+        Image image(width, height);
+        for (Color& pixel : image.pixels)
+            pixel = Color(static_cast<uint8_t>(random()), static_cast<uint8_t>(random()), static_cast<uint8_t>(random()));
+        return image;
+    }
+}
+
+/*
+    Mjerenje propusnosti memorije po uzoru na STREAM benchmark (nizovi od `elements` double vrijednosti,
+    za podrazumijevanu duzinu 128 MB po nizu, dakle mnogo vise od kesa). Nizovi se inicijalizuju u istoj
+    paralelnoj petlji (schedule static) kao i mjerenje, pa svaka nit radi nad stranicama koje je sama
+    prva dotakla (na NUMA masini to su stranice njenog cvora). Racunaju se samo bajtovi koje program
+    eksplicitno cita i upisuje (kao u STREAM-u), bez citanja linije prije upisa (write-allocate).
+*/
+StreamBandwidth measureStreamBandwidth(size_t elements, int repetitions) {
+    TRACE_SCOPE("streamBandwidth");
+
+    std::unique_ptr<double[]> a(new double[elements]);
+    std::unique_ptr<double[]> b(new double[elements]);
+    std::unique_ptr<double[]> c(new double[elements]);
+    long long count = static_cast<long long>(elements);
+
+#pragma omp parallel for schedule(static)
+    for (long long i = 0; i < count; ++i) {
+        a[i] = 1.0;
+        b[i] = 2.0;
+        c[i] = 0.0;
+    }
+
+    double bestCopy = 0.0, bestTriad = 0.0;
+    const double scalar = 3.0;
+    for (int repetition = 0; repetition < std::max(2, repetitions + 1); ++repetition) {
+        auto start = Clock::now();
+#pragma omp parallel for schedule(static)
+        for (long long i = 0; i < count; ++i)
+            c[i] = a[i];
+        double copySeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        start = Clock::now();
+#pragma omp parallel for schedule(static)
+        for (long long i = 0; i < count; ++i)
+            a[i] = b[i] + scalar * c[i];
+        double triadSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        // Prvi prolaz samo zagrijava (stranice, niti)
+        if (repetition == 0)
+            continue;
+        bestCopy = std::max(bestCopy, 2.0 * sizeof(double) * count / copySeconds / 1e9);
+        bestTriad = std::max(bestTriad, 3.0 * sizeof(double) * count / triadSeconds / 1e9);
+    }
+
+    // Rezultat se koristi, da prevodilac ne bi izbacio petlje
+    if (a[count / 2] != b[count / 2] + scalar * c[count / 2])
+        std::cerr << "Greska u mjerenju propusnosti." << std::endl;
+
+    return { bestCopy, bestTriad };
+}
+
+/*
+    Funkcija studije skaliranja.
+    1) Propusnost memorije (copy i triad) za svaki broj niti; vrh je najveca izmjerena copy propusnost,
+       jer konvolucija, kao i copy, cita jedan i upisuje jedan niz.
+    2) Jako skaliranje: ista slika sa 1, 2, 4, ... niti. Ubrzanje je T(1) / T(p), efikasnost ubrzanje / p.
+       Kernel je box kernel (separabilan), pa su moguca sva tri nacina racunanja.
+       Propusnost je najmanji saobracaj (ulaz + izlaz) kroz vrijeme; udio u vrhu pokazuje koliko je konvolucija
+       blizu granice memorije (tada vise niti ne pomaze).
+    3) Slabo skaliranje: svaka nit dobija weakSize x weakSize piksela (slika weakSize x weakSize * p),
+       efikasnost je T(1) / T(p) (idealno 1).
+    4) Prelaz: za svaki kernel i nacin, najmanja velicina slike od koje je najbolji broj niti veci od jedan
+       brzi od jedne niti za sve vece slike. Ispod prelaza paralelni region kosta vise nego sto donosi.
+    Slike koje ne stanu u memoriju se preskacu.
+*/
+int runScalingStudy(const ScalingStudyOptions& options) {
+    TRACE_SCOPE("scalingStudy");
+
+    std::vector<int> threadCounts = options.threadCounts;
+    int availableThreads = maxThreads();
+    if (threadCounts.empty()) {
+        for (int threads = 1; threads < availableThreads; threads *= 2)
+            threadCounts.push_back(threads);
+        threadCounts.push_back(availableThreads);
+    }
+    std::sort(threadCounts.begin(), threadCounts.end());
+    threadCounts.erase(std::unique(threadCounts.begin(), threadCounts.end()), threadCounts.end());
+    if (threadCounts.front() != 1)
+        threadCounts.insert(threadCounts.begin(), 1);
+
+    std::ofstream csv(options.csvPath);
+    if (!csv) {
+        std::cerr << "Nije moguce otvoriti CSV fajl: " << options.csvPath << std::endl;
+        return EXIT_FAILURE;
+    }
+    csv << "study,backend,kernel,width,height,threads,milliseconds,megapixels_per_second,speedup,efficiency,gigabytes_per_second,peak_fraction" << std::endl;
+
+    // 1) Propusnost memorije
+    std::vector<StreamBandwidth> stream;
+    double peakBandwidth = 0.0;
+    try {
+        for (int threads : threadCounts) {
+            setThreads(threads);
+            stream.push_back(measureStreamBandwidth(options.streamElements, options.repetitions));
+            peakBandwidth = std::max(peakBandwidth, stream.back().copy);
+        }
+    }
+    catch (const std::bad_alloc&) {
+        std::cerr << "Nema dovoljno memorije za mjerenje propusnosti." << std::endl;
+    }
+    for (size_t i = 0; i < stream.size(); ++i) {
+        long long elements = static_cast<long long>(options.streamElements);
+        double copyMs = 2.0 * sizeof(double) * elements / (stream[i].copy * 1e6);
+        double triadMs = 3.0 * sizeof(double) * elements / (stream[i].triad * 1e6);
+        writeRow(csv, { "stream", "copy", 0, elements, 1, threadCounts[i], copyMs, 0.0,
+            stream[i].copy / stream[0].copy, stream[i].copy / stream[0].copy / threadCounts[i], stream[i].copy }, peakBandwidth);
+        writeRow(csv, { "stream", "triad", 0, elements, 1, threadCounts[i], triadMs, 0.0,
+            stream[i].triad / stream[0].triad, stream[i].triad / stream[0].triad / threadCounts[i], stream[i].triad }, peakBandwidth);
+        std::cout << "Propusnost memorije, niti " << std::setw(2) << threadCounts[i] << ": copy " << std::fixed << std::setprecision(2)
+            << stream[i].copy << " GB/s, triad " << stream[i].triad << " GB/s" << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+    }
+
+    std::mt19937 random(12345);
+    std::vector<int> sizes = options.imageSizes;
+    std::sort(sizes.begin(), sizes.end());
+
+    // Rezultati jakog skaliranja po kernelu i nacinu, za racunanje prelaza
+    std::vector<std::vector<std::vector<StrongResult>>> strong(options.kernelSizes.size(),
+        std::vector<std::vector<StrongResult>>(options.backends.size()));
+
+    // 2) Jako skaliranje
+    for (int size : sizes) {
+        try {
+            Image input = randomImage(size, size, random);
+            Image output(size, size);
+            long long pixels = static_cast<long long>(size) * size;
+
+            for (size_t k = 0; k < options.kernelSizes.size(); ++k) {
+                int kernelSize = options.kernelSizes[k];
+                std::vector<float> kernel(static_cast<size_t>(kernelSize) * kernelSize, 1.0f / (kernelSize * kernelSize));
+                std::vector<float> column, row;
+                separateKernel(kernel, column, row);
+
+                for (size_t b = 0; b < options.backends.size(); ++b) {
+                    ConvolutionBackend backend = options.backends[b];
+                    StrongResult result = { size, 0.0, -1.0, 1 };
+
+                    for (int threads : threadCounts) {
+                        setThreads(threads);
+                        double milliseconds = measureMilliseconds([&] {
+                            runBackend(backend, options.tileSize, input, kernel, column, row, output);
+                        }, options.repetitions, options.minBatchSeconds);
+
+                        if (threads == 1)
+                            result.singleThread = milliseconds;
+                        else if (result.bestParallel < 0.0 || milliseconds < result.bestParallel) {
+                            result.bestParallel = milliseconds;
+                            result.bestThreads = threads;
+                        }
+
+                        double speedup = result.singleThread / milliseconds;
+                        writeRow(csv, { "strong", backendName(backend), kernelSize, size, size, threads, milliseconds,
+                            pixels / (milliseconds * 1000.0), speedup, speedup / threads,
+                            compulsoryBytes(pixels) / (milliseconds * 1e6) }, peakBandwidth);
+                    }
+                    strong[k][b].push_back(result);
+
+                    double fastest = result.bestParallel > 0.0 ? std::min(result.singleThread, result.bestParallel) : result.singleThread;
+                    std::cout << std::setw(5) << size << "x" << std::setw(5) << std::left << size << std::right
+                        << " kernel " << std::setw(2) << kernelSize << "x" << std::setw(2) << std::left << kernelSize << std::right
+                        << " " << std::setw(9) << std::left << backendName(backend) << std::right << std::fixed << std::setprecision(3)
+                        << " 1 nit " << result.singleThread << " ms";
+                    if (result.bestParallel > 0.0)
+                        std::cout << ", " << result.bestThreads << " niti " << result.bestParallel << " ms (ubrzanje "
+                            << std::setprecision(2) << result.singleThread / result.bestParallel << ")";
+                    std::cout << ", " << std::setprecision(2) << compulsoryBytes(pixels) / (fastest * 1e6) << " GB/s" << std::endl;
+                    std::cout.unsetf(std::ios::floatfield);
+                }
+            }
+        }
+        catch (const std::bad_alloc&) {
+            std::cerr << "Nema dovoljno memorije za sliku " << size << "x" << size << ", preskace se." << std::endl;
+        }
+    }
+
+    // 3) Slabo skaliranje
+    for (int kernelSize : options.kernelSizes) {
+        std::vector<float> kernel(static_cast<size_t>(kernelSize) * kernelSize, 1.0f / (kernelSize * kernelSize));
+        std::vector<float> column, row;
+        separateKernel(kernel, column, row);
+
+        for (ConvolutionBackend backend : options.backends) {
+            double singleThread = 0.0;
+            for (int threads : threadCounts) {
+                try {
+                    int height = options.weakSize * threads;
+                    Image input = randomImage(options.weakSize, height, random);
+                    Image output(options.weakSize, height);
+                    long long pixels = static_cast<long long>(options.weakSize) * height;
+
+                    setThreads(threads);
+                    double milliseconds = measureMilliseconds([&] {
+                        runBackend(backend, options.tileSize, input, kernel, column, row, output);
+                    }, options.repetitions, options.minBatchSeconds);
+                    if (threads == 1)
+                        singleThread = milliseconds;
+
+                    // Ubrzanje kod slabog skaliranja: koliko je puta vise posla uradjeno u jedinici vremena
+                    double efficiency = singleThread / milliseconds;
+                    writeRow(csv, { "weak", backendName(backend), kernelSize, options.weakSize, height, threads, milliseconds,
+                        pixels / (milliseconds * 1000.0), efficiency * threads, efficiency,
+                        compulsoryBytes(pixels) / (milliseconds * 1e6) }, peakBandwidth);
+                }
+                catch (const std::bad_alloc&) {
+                    std::cerr << "Nema dovoljno memorije za sliku " << options.weakSize << "x" << options.weakSize * threads << ", preskace se." << std::endl;
+                }
+            }
+        }
+    }
+    setThreads(availableThreads);
+
+    // 4) Prelaz izmedju jedne i vise niti
+    if (threadCounts.size() < 2)
+        std::cout << "Dostupna je samo jedna nit, prelaz se ne moze odrediti." << std::endl;
+    for (size_t k = 0; k < options.kernelSizes.size(); ++k) {
+        for (size_t b = 0; b < options.backends.size(); ++b) {
+            const std::vector<StrongResult>& results = strong[k][b];
+            if (results.empty() || threadCounts.size() < 2)
+                continue;
+
+            // Trazi se od najvece slike nanize, dok god vise niti pobjedjuje
+            size_t first = results.size();
+            while (first > 0 && results[first - 1].bestParallel > 0.0 && results[first - 1].bestParallel < results[first - 1].singleThread)
+                --first;
+
+            int kernelSize = options.kernelSizes[k];
+            const char* name = backendName(options.backends[b]);
+            if (first == results.size()) {
+                writeRow(csv, { "crossover", name, kernelSize, 0, 0, 1, 0.0, 0.0, 0.0, 0.0, 0.0 }, peakBandwidth);
+                std::cout << "Kernel " << kernelSize << "x" << kernelSize << " " << name << ": jedna nit je najbrza za sve velicine." << std::endl;
+                continue;
+            }
+
+            const StrongResult& crossover = results[first];
+            double speedup = crossover.singleThread / crossover.bestParallel;
+            long long pixels = static_cast<long long>(crossover.size) * crossover.size;
+            writeRow(csv, { "crossover", name, kernelSize, crossover.size, crossover.size, crossover.bestThreads, crossover.bestParallel,
+                pixels / (crossover.bestParallel * 1000.0), speedup, speedup / crossover.bestThreads,
+                compulsoryBytes(pixels) / (crossover.bestParallel * 1e6) }, peakBandwidth);
+            std::cout << "Kernel " << kernelSize << "x" << kernelSize << " " << name << ": vise niti je brze od slike "
+                << crossover.size << "x" << crossover.size << " (" << pixels * kernelSize * kernelSize << " mnozenja po kanalu)" << std::endl;
+        }
+    }
+
+    std::cout << "Rezultati su sacuvani u " << options.csvPath << std::endl;
+    return EXIT_SUCCESS;
+}
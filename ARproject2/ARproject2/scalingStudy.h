@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "autoTuner.h"
+
+// Propusnost memorije izmjerena po uzoru na STREAM (GB/s)
+struct StreamBandwidth {
+    double copy;    // c[i] = a[i]: jedno citanje i jedan upis po elementu, kao kod konvolucije
+    double triad;   // a[i] = b[i] + s * c[i]: dva citanja i jedan upis po elementu
+};
+
+struct ScalingStudyOptions {
+    std::string csvPath = "convolution_scaling.csv";
+    std::vector<int> imageSizes = { 64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384 };  // stranica kvadratne slike
+    std::vector<int> kernelSizes = { 3, 5, 9, 15 };
+    std::vector<ConvolutionBackend> backends = { ConvolutionBackend::Direct, ConvolutionBackend::Tiled, ConvolutionBackend::Separable };
+    std::vector<int> threadCounts;      // prazno = 1, 2, 4, ... do broja jezgara
+    int weakSize = 1024;                // slabo skaliranje: slika weakSize x (weakSize * broj niti)
+    int tileSize = 64;                  // velicina plocice za nacin "tiled"
+    int repetitions = 3;                // uzima se najbolje od N mjerenja
+    double minBatchSeconds = 0.05;      // male slike se ponavljaju dok jedno mjerenje ne traje bar ovoliko
+    size_t streamElements = 1 << 24;    // duzina nizova (double) za mjerenje propusnosti, mnogo veca od kesa
+};
+
+// Propusnost memorije sa trenutnim brojem niti (najbolje od `repetitions` mjerenja)
+StreamBandwidth measureStreamBandwidth(size_t , int );
+
+/*
+    Studija skaliranja: za svaku velicinu slike, velicinu kernela i nacin racunanja mjeri vrijeme
+    sa svakim brojem niti (jako skaliranje), zatim slike cija visina raste sa brojem niti (slabo skaliranje).
+    Rezultati se upisuju u CSV fajl (jedan red po mjerenju) i na kraju se ispisuje prelaz:
+    najmanja slika od koje je vise niti uvijek brze od jedne.
+*/
+int runScalingStudy(const ScalingStudyOptions& );
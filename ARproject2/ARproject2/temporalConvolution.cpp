@@ -0,0 +1,106 @@
+#include "temporalConvolution.h"
+#include "convolution.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+    // Nakon ovoliko frejmova tekuca suma se racuna iznova, da se ne bi nagomilala greska zaokruzivanja
+    const long long accumulatorRefreshInterval = 1024;
+
+    inline uint8_t clampToByte(float value) {
+        return static_cast<uint8_t>(std::max(0.0f, std::min(255.0f, value)));
+    }
+}
+
+TemporalConvolver::TemporalConvolver(int w, int h, const std::vector<float>& spatial, const std::vector<float>& temporal)
+    : width(w), height(h), spatialKernel(spatial), temporalKernel(temporal.empty() ? std::vector<float>(1, 1.0f) : temporal),
+      uniform(true), ring(temporalKernel.size()), frames(temporalKernel.size()), newest(-1), frameCount(0) {
+
+    for (float weight : temporalKernel) {
+        if (std::fabs(weight - temporalKernel[0]) > 1e-6f * std::fabs(temporalKernel[0]))
+            uniform = false;
+    }
+
+    size_t valueCount = static_cast<size_t>(width) * height * 3;
+    for (std::vector<float>& frame : ring)
+        frame.resize(valueCount);
+    incoming.resize(valueCount);
+    if (uniform)
+        accumulator.resize(valueCount);
+}
+
+void TemporalConvolver::rebuildAccumulator() {
+    const long long count = static_cast<long long>(accumulator.size());
+    std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+    for (const std::vector<float>& frame : ring) {
+        const float* values = frame.data();
+        float* sum = accumulator.data();
+#pragma omp parallel for
+        for (long long i = 0; i < count; ++i)
+            sum[i] += values[i];
+    }
+}
+
+/*
+    Ova funkcija dodaje novi frejm i racuna izlazni frejm.
+    Prostorna konvolucija se racuna samo za novi frejm, a rezultat (bez odsjecanja na [0, 255]) se cuva
+    u kruznom baferu od T frejmova, tako da se prostorni dio nikad ne racuna ponovo za starije frejmove.
+    Ako su sve vremenske tezine jednake (vremenski "box" filter), odrzava se tekuca suma:
+    novi frejm se dodaje, a najstariji oduzima, pa je cijena po frejmu jedna prostorna konvolucija
+    i dvije operacije po vrijednosti, nezavisno od T. Za proizvoljne tezine se filtrirani frejmovi
+    iz bafera kombinuju sa T mnozenja po vrijednosti, sto je i dalje mnogo jeftinije od T prostornih konvolucija.
+    Dok jos nije stiglo T frejmova, prvi frejm se ponavlja unazad u vremenu (isto kao ogranicavanje na rub u prostoru).
+*/
+void TemporalConvolver::pushFrame(const Image& frame, Image& output) {
+    const int frameSlots = static_cast<int>(ring.size());
+    const long long count = static_cast<long long>(incoming.size());
+
+    convolutionToFloat(frame, spatialKernel, incoming);
+
+    if (frameCount == 0) {
+        for (std::vector<float>& slot : ring)
+            slot = incoming;
+        newest = 0;
+        if (uniform)
+            rebuildAccumulator();
+    }
+    else {
+        int oldest = (newest + 1) % frameSlots;
+        if (uniform) {
+            const float* added = incoming.data();
+            const float* removed = ring[oldest].data();
+            float* sum = accumulator.data();
+#pragma omp parallel for
+            for (long long i = 0; i < count; ++i)
+                sum[i] += added[i] - removed[i];
+        }
+        std::swap(ring[oldest], incoming);
+        newest = oldest;
+    }
+
+    if (++frameCount % accumulatorRefreshInterval == 0 && uniform)
+        rebuildAccumulator();
+
+    uint8_t* out = reinterpret_cast<uint8_t*>(output.pixels.data());
+    if (uniform) {
+        const float weight = temporalKernel[0];
+        const float* sum = accumulator.data();
+#pragma omp parallel for
+        for (long long i = 0; i < count; ++i)
+            out[i] = clampToByte(sum[i] * weight);
+        return;
+    }
+
+    for (int k = 0; k < frameSlots; ++k)
+        frames[k] = ring[(newest - k + frameSlots) % frameSlots].data();
+
+#pragma omp parallel for
+    for (long long i = 0; i < count; ++i) {
+        float sum = 0;
+        for (int k = 0; k < frameSlots; ++k)
+            sum += frames[k][i] * temporalKernel[k];
+        out[i] = clampToByte(sum);
+    }
+}
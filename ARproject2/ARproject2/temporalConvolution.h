@@ -0,0 +1,31 @@
+#pragma once
+
+#include <vector>
+#include "image.h"
+
+/*
+    Prostorno-vremenska (3D) konvolucija nad nizom frejmova.
+    Kernel je separabilan: prostorni dio je obican kvadratni kernel kao za convolution(),
+    a vremenski dio je niz od T tezina, gdje se tezina 0 odnosi na najnoviji frejm, tezina 1 na prethodni itd.
+*/
+class TemporalConvolver {
+public:
+    TemporalConvolver(int , int , const std::vector<float>& , const std::vector<float>& );
+
+    void pushFrame(const Image& , Image& );
+
+private:
+    int width, height;
+    std::vector<float> spatialKernel;
+    std::vector<float> temporalKernel;
+    bool uniform;
+
+    std::vector<std::vector<float>> ring;  // prostorno filtrirani posljednjih T frejmova
+    std::vector<float> incoming;
+    std::vector<float> accumulator;        // tekuca suma frejmova iz ringa (samo za uniformne tezine)
+    std::vector<const float*> frames;      // frejmovi iz ringa od najnovijeg ka najstarijem
+    int newest;
+    long long frameCount;
+
+    void rebuildAccumulator();
+};
@@ -0,0 +1,557 @@
+#include "tileSharding.h"
+#include "convolutionService.h"
+#include "kernel.h"
+#include "tracing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#ifdef __linux__
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+bool parseShardOptions(int argc, char* argv[], ShardOptions& options) {
+    std::vector<std::string> positional;
+    for (int i = 0; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--worker" && i + 1 < argc)
+            options.workerCommands.push_back(argv[++i]);
+        else if (argument == "--timeout" && i + 1 < argc)
+            options.tileTimeoutSeconds = atof(argv[++i]);
+        else
+            positional.push_back(argument);
+    }
+
+    if (positional.size() < 2) {
+        std::cerr << "Upotreba: --shard <ulaz.bmp> <izlaz.bmp> [kernel] [broj radnika] [redova po plocici] "
+            "[replicate|constant|reflect] [--worker \"komanda\"]... [--timeout sekundi]" << std::endl;
+        return false;
+    }
+
+    options.inputPath = positional[0];
+    options.outputPath = positional[1];
+    options.kernel = Kernel::kernelByName(positional.size() >= 3 ? positional[2] : "gaussian");
+    if (positional.size() >= 4)
+        options.workerCount = atoi(positional[3].c_str());
+    if (positional.size() >= 5)
+        options.tileRows = atoi(positional[4].c_str());
+    if (positional.size() >= 6)
+        options.border = parseBorderMode(positional[5]);
+    if (!options.workerCommands.empty() && positional.size() < 4)
+        options.workerCount = static_cast<int>(options.workerCommands.size());
+
+    if (options.kernel.empty() || options.workerCount < 1 || options.tileRows < 1 || !(options.tileTimeoutSeconds > 0)) {
+        std::cerr << "Kernel ne smije biti prazan, a broj radnika, redova po plocici i vrijeme cekanja moraju biti pozitivni." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+#ifdef __linux__
+
+namespace {
+
+    typedef std::chrono::steady_clock Clock;
+
+    const uint32_t tileMagic = 0x454C4954;  // "TILE"
+    const int maxKernelValues = 63 * 63;
+
+    /*
+        Poruka koordinatora: zaglavlje, vrijednosti kernela i pikseli plocice (BGR24, redovi odozgo nadole).
+        Plocica ima `rows` redova ukljucujuci halo; racuna se `outputRows` redova pocevsi od reda `outputTop` plocice.
+        Halo redovi postoje samo unutar slike, pa se rubno pravilo kod radnika primjenjuje samo na rubovima slike.
+        Radnik moze biti na drugoj masini (ssh), pa su sva polja zaglavlja i vrijednosti kernela (float, IEEE 754)
+        32-bitne rijeci u little-endian redoslijedu bajtova, kao u BMP fajlu; vidi wireOrder().
+    */
+    struct TileRequest {
+        uint32_t magic;
+        int32_t tileId;
+        int32_t width;
+        int32_t rows;
+        int32_t outputTop;
+        int32_t outputRows;
+        int32_t border;  // BorderMode
+        uint32_t kernelValueCount;
+    };
+
+    struct TileResponse {
+        uint32_t magic;
+        int32_t tileId;
+        int32_t status;  // 0 = uspjeh
+        int32_t rows;
+    };
+
+    inline uint32_t littleEndian(uint32_t value) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        return __builtin_bswap32(value);
+#else
+        return value;
+#endif
+    }
+
+    // Pretvaranje niza 32-bitnih rijeci (zaglavlje ili kernel) izmedju redoslijeda masine i protokola, u oba smjera
+    inline void wireOrder(void* data, size_t size) {
+        uint8_t* bytes = static_cast<uint8_t*>(data);
+        for (size_t i = 0; i + 4 <= size; i += 4) {
+            uint32_t word;
+            memcpy(&word, bytes + i, 4);
+            word = littleEndian(word);
+            memcpy(bytes + i, &word, 4);
+        }
+    }
+
+    const Clock::time_point noDeadline = Clock::time_point::max();
+
+    /*
+        Ceka da fd bude spreman za citanje ili upis najduze do roka; vraca false ako je rok istekao.
+        Koordinator drzi svoje krajeve cijevi u neblokirajucem rezimu, pa radnik koji se zaglavio
+        (ili udaljena veza koja visi) ne moze zauvijek blokirati read ili write.
+    */
+    bool waitReady(int fd, short events, Clock::time_point deadline) {
+        for (;;) {
+            int timeout = -1;
+            if (deadline != noDeadline) {
+                auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+                if (left <= 0)
+                    return false;
+                timeout = static_cast<int>(std::min<long long>(left, 1 << 30));
+            }
+            pollfd entry = { fd, events, 0 };
+            int ready = poll(&entry, 1, timeout);
+            if (ready < 0 && errno == EINTR)
+                continue;
+            return ready > 0;
+        }
+    }
+
+    bool readAll(int fd, void* data, size_t size, Clock::time_point deadline = noDeadline) {
+        uint8_t* bytes = static_cast<uint8_t*>(data);
+        while (size > 0) {
+            ssize_t count = read(fd, bytes, size);
+            if (count < 0 && errno == EINTR)
+                continue;
+            if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                if (!waitReady(fd, POLLIN, deadline))
+                    return false;
+                continue;
+            }
+            if (count <= 0)
+                return false;
+            bytes += count;
+            size -= count;
+        }
+        return true;
+    }
+
+    bool writeAll(int fd, const void* data, size_t size, Clock::time_point deadline = noDeadline) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        while (size > 0) {
+            ssize_t count = write(fd, bytes, size);
+            if (count < 0 && errno == EINTR)
+                continue;
+            if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                if (!waitReady(fd, POLLOUT, deadline))
+                    return false;
+                continue;
+            }
+            if (count <= 0)
+                return false;
+            bytes += count;
+            size -= count;
+        }
+        return true;
+    }
+
+    bool writeAllAt(int fd, const void* data, size_t size, off_t offset) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        while (size > 0) {
+            ssize_t count = pwrite(fd, bytes, size, offset);
+            if (count < 0 && errno == EINTR)
+                continue;
+            if (count <= 0)
+                return false;
+            bytes += count;
+            size -= count;
+            offset += count;
+        }
+        return true;
+    }
+
+    // Proces radnika i cijevi prema njemu
+    struct Worker {
+        pid_t pid = -1;
+        int toWorker = -1;
+        int fromWorker = -1;
+    };
+
+    bool startWorker(const std::string& command, Worker& worker) {
+        int input[2], output[2];
+        if (pipe2(input, O_CLOEXEC) != 0)
+            return false;
+        if (pipe2(output, O_CLOEXEC) != 0) {
+            close(input[0]);
+            close(input[1]);
+            return false;
+        }
+
+        pid_t pid = fork();
+        if (pid == 0) {
+            // Radnik (i procesi koje pokrene komanda, npr. ssh) dobija svoju grupu procesa, da bi se mogao prekinuti cijeli
+            setpgid(0, 0);
+            dup2(input[0], STDIN_FILENO);
+            dup2(output[1], STDOUT_FILENO);
+            if (command.empty())
+                execl("/proc/self/exe", "convolution-worker", "--tile-worker", static_cast<char*>(nullptr));
+            else
+                execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char*>(nullptr));
+            _exit(127);
+        }
+
+        close(input[0]);
+        close(output[1]);
+        if (pid < 0) {
+            close(input[1]);
+            close(output[0]);
+            return false;
+        }
+
+        // Grupa se postavlja i ovdje, da bi stopWorker mogao prekinuti radnika i prije nego sto on stigne do setpgid
+        setpgid(pid, pid);
+        // Krajevi cijevi kod koordinatora su neblokirajuci (vidi waitReady), a radnik ima obicne blokirajuce
+        fcntl(input[1], F_SETFL, fcntl(input[1], F_GETFL) | O_NONBLOCK);
+        fcntl(output[0], F_SETFL, fcntl(output[0], F_GETFL) | O_NONBLOCK);
+
+        worker.pid = pid;
+        worker.toWorker = input[1];
+        worker.fromWorker = output[0];
+        return true;
+    }
+
+    // Zaustavljanje radnika; radnik koji nije uspio (npr. zaglavio se) se prvo prekida, da waitpid ne bi cekao zauvijek
+    void stopWorker(Worker& worker, bool kill = false) {
+        if (worker.pid < 0)
+            return;
+        if (kill)
+            if (::kill(-worker.pid, SIGKILL) != 0)
+                ::kill(worker.pid, SIGKILL);
+        close(worker.toWorker);
+        close(worker.fromWorker);
+        int status;
+        waitpid(worker.pid, &status, 0);
+        worker = Worker();
+    }
+
+    // Opis 24-bitnog BMP ulaza, dovoljan za citanje proizvoljnog reda direktno iz fajla
+    struct BMPLayout {
+        int width, height;
+        bool topDown;
+        size_t rowBytes;
+        uint32_t dataOffset;
+
+        off_t rowOffset(int y) const {
+            int fileRow = topDown ? y : height - 1 - y;
+            return static_cast<off_t>(dataOffset) + static_cast<off_t>(fileRow) * rowBytes;
+        }
+    };
+
+    bool readBMPLayout(int fd, const std::string& path, BMPLayout& layout) {
+        BMPHeader header;
+        if (pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) || header.signature != 0x4D42) {
+            std::cerr << "Nevažeći BMP format: " << path << std::endl;
+            return false;
+        }
+        if (header.bitsPerPixel != 24 || header.compression != 0) {
+            std::cerr << "Raspodjela na radnike podrzava samo nekompresovane 24-bitne BMP fajlove: " << path << std::endl;
+            return false;
+        }
+
+        layout.width = header.width;
+        layout.height = header.height < 0 ? -header.height : header.height;
+        layout.topDown = header.height < 0;
+        layout.rowBytes = (static_cast<size_t>(layout.width) * 3 + 3) & ~static_cast<size_t>(3);
+        layout.dataOffset = header.dataOffset;
+        return layout.width > 0 && layout.height > 0;
+    }
+
+    // Plocica: izlazni redovi [top, top + rows)
+    struct Tile {
+        int id;
+        int top, rows;
+        int attempts;
+    };
+
+    struct ShardState {
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::deque<Tile> pending;
+        int remaining = 0;
+        bool failed = false;
+        std::atomic<int> retries{ 0 };
+    };
+
+    /*
+        Slanje jedne plocice radniku i upis rezultata u izlazni fajl.
+        Halo se cita iz ulaza samo unutar slike: na rubu slike plocica i slika imaju isti rub,
+        pa radnik primjenjuje rubno pravilo tacno tamo gdje bi ga primijenila konvolucija cijele slike.
+        Slanje i prijem plocice moraju se zavrsiti u roku options.tileTimeoutSeconds; inace plocica nije uspjela
+        kao i kada se radnik srusi, pa se salje ponovo.
+    */
+    bool processTile(const Worker& worker, const ShardOptions& options, const BMPLayout& input, const BMPLayout& output, int inputFd, int outputFd, const Tile& tile) {
+        TRACE_SCOPE("shardTile");
+
+        int radius = static_cast<int>(std::sqrt(options.kernel.size())) / 2;
+        int first = std::max(0, tile.top - radius);
+        int last = std::min(input.height, tile.top + tile.rows + radius);
+        size_t packedRow = static_cast<size_t>(input.width) * 3;
+
+        std::vector<uint8_t> pixels(packedRow * (last - first));
+        for (int y = first; y < last; ++y) {
+            if (pread(inputFd, &pixels[(y - first) * packedRow], packedRow, input.rowOffset(y)) != static_cast<ssize_t>(packedRow))
+                return false;
+        }
+
+        const Clock::time_point deadline = Clock::now()
+            + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.tileTimeoutSeconds));
+
+        TileRequest request = { tileMagic, tile.id, input.width, last - first, tile.top - first, tile.rows,
+            static_cast<int32_t>(options.border), static_cast<uint32_t>(options.kernel.size()) };
+        std::vector<float> kernel = options.kernel;
+        wireOrder(&request, sizeof(request));
+        wireOrder(kernel.data(), kernel.size() * sizeof(float));
+        if (!writeAll(worker.toWorker, &request, sizeof(request), deadline)
+            || !writeAll(worker.toWorker, kernel.data(), kernel.size() * sizeof(float), deadline)
+            || !writeAll(worker.toWorker, pixels.data(), pixels.size(), deadline))
+            return false;
+
+        TileResponse response;
+        if (!readAll(worker.fromWorker, &response, sizeof(response), deadline))
+            return false;
+        wireOrder(&response, sizeof(response));
+        if (response.magic != tileMagic || response.tileId != tile.id || response.status != 0 || response.rows != tile.rows)
+            return false;
+
+        std::vector<uint8_t> result(packedRow * tile.rows);
+        if (!readAll(worker.fromWorker, result.data(), result.size(), deadline))
+            return false;
+
+        std::vector<uint8_t> row(output.rowBytes, 0);
+        for (int y = 0; y < tile.rows; ++y) {
+            memcpy(row.data(), &result[y * packedRow], packedRow);
+            if (!writeAllAt(outputFd, row.data(), row.size(), output.rowOffset(tile.top + y)))
+                return false;
+        }
+
+        TRACE_PIXELS(static_cast<long long>(input.width) * tile.rows);
+        TRACE_BYTES_READ(pixels.size());
+        TRACE_BYTES_WRITTEN(static_cast<long long>(output.rowBytes) * tile.rows);
+        return true;
+    }
+
+    /*
+        Nit koordinatora za jednog radnika: uzima plocice iz zajednickog reda dok ih ima.
+        Kada slanje ili prijem ne uspije (radnik se srusio, vratio gresku, prekinuo vezu ili nije odgovorio u roku),
+        plocica se vraca u red, a radnik se prekida i ponovo pokrece. Radnik koji tri puta zaredom ne uspije se povlaci, pa plocice preuzimaju ostali.
+    */
+    void workerLoop(const std::string& command, const ShardOptions& options, const BMPLayout& input, const BMPLayout& output,
+        int inputFd, int outputFd, ShardState& state) {
+        Worker worker;
+        int consecutiveFailures = 0;
+
+        while (consecutiveFailures < 3) {
+            Tile tile;
+            {
+                // Ako je red prazan, preostale plocice su kod drugih radnika; ceka se da se zavrse ili vrate u red
+                std::unique_lock<std::mutex> lock(state.mutex);
+                state.changed.wait(lock, [&] { return state.failed || state.remaining == 0 || !state.pending.empty(); });
+                if (state.failed || state.remaining == 0)
+                    break;
+                tile = state.pending.front();
+                state.pending.pop_front();
+            }
+
+            if (worker.pid < 0 && !startWorker(command, worker)) {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                state.pending.push_front(tile);
+                state.changed.notify_all();
+                ++consecutiveFailures;
+                continue;
+            }
+
+            if (processTile(worker, options, input, output, inputFd, outputFd, tile)) {
+                consecutiveFailures = 0;
+                std::lock_guard<std::mutex> lock(state.mutex);
+                if (--state.remaining == 0)
+                    state.changed.notify_all();
+                continue;
+            }
+
+            stopWorker(worker, true);
+            ++consecutiveFailures;
+            ++state.retries;
+
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (++tile.attempts >= options.maxAttempts) {
+                std::cerr << "Plocica " << tile.id << " (redovi " << tile.top << "-" << tile.top + tile.rows - 1
+                    << ") nije obradjena ni nakon " << tile.attempts << " pokusaja." << std::endl;
+                state.failed = true;
+            }
+            else {
+                state.pending.push_back(tile);
+            }
+            state.changed.notify_all();
+        }
+
+        stopWorker(worker);
+    }
+
+    // Upis zaglavlja izlaznog 24-bitnog BMP fajla i rezervisanje mjesta za sve redove
+    bool createOutputBMP(int fd, const BMPLayout& layout) {
+        BMPHeader header = {};
+        header.signature = 0x4D42;
+        header.dataOffset = sizeof(BMPHeader);
+        header.fileSize = static_cast<uint32_t>(sizeof(BMPHeader) + layout.rowBytes * layout.height);
+        header.headerSize = 40;
+        header.width = layout.width;
+        header.height = layout.height;
+        header.planes = 1;
+        header.bitsPerPixel = 24;
+        header.imageSize = static_cast<uint32_t>(static_cast<size_t>(layout.width) * layout.height * 3);
+
+        return writeAllAt(fd, &header, sizeof(header), 0) && ftruncate(fd, header.fileSize) == 0;
+    }
+}
+
+/*
+    Funkcija koordinatora: otvara ulaz, pravi izlazni BMP iste velicine (redovi odozdo nagore, kao saveBMP),
+    dijeli sliku na plocice od po tileRows redova i pokrece po jednu nit za svakog radnika.
+*/
+int runShardCoordinator(const ShardOptions& options) {
+    TRACE_SCOPE("shardCoordinator");
+
+    if (options.kernel.size() > static_cast<size_t>(maxKernelValues)) {
+        std::cerr << "Kernel moze imati najvise " << maxKernelValues << " vrijednosti." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    int inputFd = open(options.inputPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (inputFd < 0) {
+        std::cerr << "Nije moguće otvoriti fajl: " << options.inputPath << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    BMPLayout inputLayout;
+    if (!readBMPLayout(inputFd, options.inputPath, inputLayout)) {
+        close(inputFd);
+        return EXIT_FAILURE;
+    }
+
+    BMPLayout outputLayout = inputLayout;
+    outputLayout.topDown = false;
+    outputLayout.dataOffset = sizeof(BMPHeader);
+
+    int outputFd = open(options.outputPath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (outputFd < 0 || !createOutputBMP(outputFd, outputLayout)) {
+        std::cerr << "Nije moguće otvoriti fajl za čuvanje: " << options.outputPath << std::endl;
+        close(inputFd);
+        if (outputFd >= 0)
+            close(outputFd);
+        return EXIT_FAILURE;
+    }
+
+    // Radnik koji se srusi ne smije oboriti koordinatora signalom pri upisu u zatvorenu cijev
+    signal(SIGPIPE, SIG_IGN);
+
+    ShardState state;
+    for (int top = 0, id = 0; top < inputLayout.height; top += options.tileRows, ++id)
+        state.pending.push_back({ id, top, std::min(options.tileRows, inputLayout.height - top), 0 });
+    state.remaining = static_cast<int>(state.pending.size());
+    int tileCount = state.remaining;
+
+    auto start = Clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < options.workerCount; ++i) {
+        std::string command = options.workerCommands.empty() ? std::string() : options.workerCommands[i % options.workerCommands.size()];
+        threads.emplace_back(workerLoop, command, std::cref(options), std::cref(inputLayout), std::cref(outputLayout), inputFd, outputFd, std::ref(state));
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    close(inputFd);
+    close(outputFd);
+
+    if (state.remaining > 0) {
+        std::cerr << "Obrada nije zavrsena: " << state.remaining << " od " << tileCount << " plocica nije obradjeno." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Obradjeno " << tileCount << " plocica (" << inputLayout.width << "x" << inputLayout.height << ") sa "
+        << options.workerCount << " radnika za " << seconds * 1000.0 << " ms, ponovljenih slanja: " << state.retries << std::endl;
+    return EXIT_SUCCESS;
+}
+
+/*
+    Petlja radnika. Svaka plocica se racuna funkcijom convolutionROI nad pikselima plocice: halo redovi su dio
+    plocice, pa se rubno pravilo primjenjuje samo na redovima koji su i rubovi slike.
+*/
+int runTileWorker() {
+    signal(SIGPIPE, SIG_IGN);
+
+    TileRequest request;
+    std::vector<float> kernel;
+    std::vector<Color> tile, result;
+
+    while (readAll(STDIN_FILENO, &request, sizeof(request))) {
+        wireOrder(&request, sizeof(request));
+        BorderMode border = static_cast<BorderMode>(request.border);
+        if (request.magic != tileMagic || request.kernelValueCount == 0 || request.kernelValueCount > static_cast<uint32_t>(maxKernelValues)
+            || request.width <= 0 || request.rows <= 0 || request.outputTop < 0 || request.outputRows <= 0
+            || request.outputTop + request.outputRows > request.rows
+            || (border != BorderMode::Replicate && border != BorderMode::Constant && border != BorderMode::Reflect))
+            return EXIT_FAILURE;
+
+        kernel.resize(request.kernelValueCount);
+        tile.resize(static_cast<size_t>(request.width) * request.rows);
+        result.resize(static_cast<size_t>(request.width) * request.outputRows);
+        if (!readAll(STDIN_FILENO, kernel.data(), kernel.size() * sizeof(float))
+            || !readAll(STDIN_FILENO, tile.data(), tile.size() * sizeof(Color)))
+            return EXIT_FAILURE;
+        wireOrder(kernel.data(), kernel.size() * sizeof(float));
+
+        convolutionROI(ConstImageView(tile.data(), request.width, request.rows), kernel,
+            Rect(0, request.outputTop, request.width, request.outputRows), ImageView(result.data(), request.width, request.outputRows), border);
+
+        TileResponse response = { tileMagic, request.tileId, 0, request.outputRows };
+        wireOrder(&response, sizeof(response));
+        if (!writeAll(STDOUT_FILENO, &response, sizeof(response)) || !writeAll(STDOUT_FILENO, result.data(), result.size() * sizeof(Color)))
+            return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+#else
+
+int runShardCoordinator(const ShardOptions&) {
+    std::cerr << "Raspodjela na radnike je podrzana samo na Linuxu." << std::endl;
+    return EXIT_FAILURE;
+}
+
+int runTileWorker() {
+    std::cerr << "Radnik za plocice je podrzan samo na Linuxu." << std::endl;
+    return EXIT_FAILURE;
+}
+
+#endif
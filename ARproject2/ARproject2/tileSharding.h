@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "convolution.h"
+
+/*
+    Raspodjela konvolucije velike slike na vise procesa (radnika).
+    Koordinator dijeli 24-bitni BMP ulaz na pojaseve redova (plocice) prosirene za poluprecnik kernela (halo),
+    salje ih radnicima i upisuje rezultate direktno na odgovarajuce pozicije redova u izlaznom BMP fajlu,
+    pa ni koordinator ni radnici nikada ne drze cijelu sliku u memoriji.
+    Radnici su procesi sa kojima se komunicira preko standardnog ulaza i izlaza (cijevi); podrazumijevano
+    su to lokalne kopije programa (--tile-worker), a zadavanjem komande (npr. "ssh cvor1 /put/do/programa --tile-worker")
+    radnik moze biti i na drugoj masini, pa je protokol little-endian bez obzira na masinu.
+    Neuspjela plocica (radnik se srusio, prekinuo vezu ili nije odgovorio u roku) se ponovo salje
+    drugom ili ponovo pokrenutom radniku.
+    Rezultat je bit po bit identican konvoluciji cijele slike u jednom procesu.
+*/
+struct ShardOptions {
+    std::string inputPath;
+    std::string outputPath;
+    std::vector<float> kernel;
+    BorderMode border = BorderMode::Replicate;
+    int workerCount = 4;
+    int tileRows = 256;                       // broj izlaznih redova po plocici
+    int maxAttempts = 4;                      // koliko puta se ista plocica moze poslati prije odustajanja
+    double tileTimeoutSeconds = 60.0;         // rok za slanje plocice i prijem rezultata; radnik koji ga prekoraci se prekida
+    std::vector<std::string> workerCommands;  // prazno = lokalni radnici (ovaj program sa --tile-worker)
+};
+
+// Parsiranje: --shard <ulaz.bmp> <izlaz.bmp> [kernel] [broj radnika] [redova po plocici] [replicate|constant|reflect] [--worker "komanda"]... [--timeout sekundi]
+bool parseShardOptions(int , char*[] , ShardOptions& );
+
+int runShardCoordinator(const ShardOptions& );
+
+// Petlja radnika: cita plocice sa standardnog ulaza, a rezultate pise na standardni izlaz
+int runTileWorker();
@@ -0,0 +1,271 @@
+#include "tiledImage.h"
+#include "convolutionFixed.h"
+#include "perfCounters.h"
+#include "tracing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+namespace {
+    // Preplitanje bitova koordinata plocice (x na parnim, y na neparnim pozicijama): Z-kriva
+    uint32_t mortonCode(uint32_t x, uint32_t y) {
+        uint32_t code = 0;
+        for (int bit = 0; bit < 16; ++bit)
+            code |= ((x >> bit) & 1u) << (2 * bit) | ((y >> bit) & 1u) << (2 * bit + 1);
+        return code;
+    }
+
+    /*
+        Konvolucija jedne plocice: susjedstvo plocice (plocica prosirena za poluprecnik kernela, sa rubnim pravilom
+        na granicama slike) se prvo prepise u bafer niti, a zatim se svaki izlazni piksel racuna iz bafera
+        istim redoslijedom sabiranja i istom sumom po tipu piksela (PixelSum) kao convolvePixel(),
+        pa je rezultat identican obicnoj konvoluciji.
+        Pikseli van slike kod BorderMode::Constant su u baferu nule (doprinos 0 umjesto preskakanja).
+    */
+    template <typename PixelT>
+    void convolveTile(const BasicTiledImage<PixelT>& input, const std::vector<float>& kernel, int kernelSize, BorderMode border,
+        int tx, int ty, std::vector<PixelT>& halo, BasicTiledImage<PixelT>& output) {
+        const int tileSize = BasicTiledImage<PixelT>::tileSize;
+        const int radius = kernelSize / 2;
+        const int haloSize = tileSize + 2 * radius;
+        const int x0 = tx * tileSize, y0 = ty * tileSize;
+
+        for (int by = 0; by < haloSize; ++by) {
+            PixelT* target = &halo[static_cast<size_t>(by) * haloSize];
+            int imgY = borderIndex(y0 + by - radius, input.height, border);
+            for (int bx = 0; bx < haloSize; ++bx) {
+                int imgX = borderIndex(x0 + bx - radius, input.width, border);
+                target[bx] = (imgX < 0 || imgY < 0) ? PixelT() : input.at(imgX, imgY);
+            }
+        }
+
+        PixelT* out = output.tile(tx, ty);
+        const int rows = std::min(tileSize, input.height - y0);
+        const int columns = std::min(tileSize, input.width - x0);
+        for (int y = 0; y < rows; ++y) {
+            for (int x = 0; x < columns; ++x) {
+                PixelSum<PixelT> sum;
+                for (int ky = 0; ky < kernelSize; ++ky) {
+                    const PixelT* source = &halo[static_cast<size_t>(y + ky) * haloSize + x];
+                    const float* weights = &kernel[static_cast<size_t>(ky) * kernelSize];
+                    for (int kx = 0; kx < kernelSize; ++kx)
+                        sum.add(source[kx], weights[kx]);
+                }
+                sum.store(out[y * tileSize + x]);
+            }
+        }
+    }
+
+    /*
+        Plocice se obilaze redoslijedom u memoriji (Z-kriva), pa svaka nit dobija uzastopan dio memorije koji
+        pokriva kompaktnu 2D oblast slike; bafer susjedstva je po niti i ponovo se koristi za svaku plocicu.
+    */
+    template <typename PixelT>
+    void convolutionTiledLayout(const BasicTiledImage<PixelT>& input, const std::vector<float>& kernel, BasicTiledImage<PixelT>& output, BorderMode border) {
+        TRACE_SCOPE("convolutionTiledLayout");
+        TRACE_PIXELS(static_cast<long long>(input.width) * input.height);
+
+        if (output.width != input.width || output.height != input.height) {
+            std::cerr << "Ulazna i izlazna slika po plocicama moraju imati iste dimenzije." << std::endl;
+            return;
+        }
+
+        const int kernelSize = static_cast<int>(std::sqrt(kernel.size()));
+        const int haloSize = BasicTiledImage<PixelT>::tileSize + 2 * (kernelSize / 2);
+        const int tileCount = input.tilesX * input.tilesY;
+
+        TRACE_PARALLEL_REGION("convolutionTiledLayout");
+#pragma omp parallel
+        {
+            TRACE_THREAD_BUSY();
+            std::vector<PixelT> halo(static_cast<size_t>(haloSize) * haloSize);
+
+#pragma omp for schedule(static) nowait
+            for (int slot = 0; slot < tileCount; ++slot) {
+                int index = static_cast<int>(input.slotTiles[slot]);
+                convolveTile(input, kernel, kernelSize, border, index % input.tilesX, index / input.tilesX, halo, output);
+            }
+        }
+    }
+
+    // Ispis jednog reda tabele benchmarka sa vrijednostima brojaca (ako su dostupni)
+    void printLayoutResult(const char* layout, int kernelSize, double milliseconds, const PerfCounterValues& values) {
+        std::cout << std::left << std::setw(12) << layout << std::right << std::setw(4) << kernelSize << "x" << std::setw(2) << std::left << kernelSize
+            << std::right << std::setw(12) << std::fixed << std::setprecision(2) << milliseconds;
+        if (values.valid) {
+            std::cout << std::setw(16) << values.dtlbMisses << std::setw(16) << values.l1dMisses << std::setw(16) << values.llcMisses
+                << std::setw(8) << std::setprecision(2) << values.ipc();
+        }
+        std::cout << std::endl;
+    }
+}
+
+template <typename PixelT>
+BasicTiledImage<PixelT>::BasicTiledImage(int w, int h)
+    : width(w), height(h), tilesX((w + tileSize - 1) / tileSize), tilesY((h + tileSize - 1) / tileSize),
+    pixels(static_cast<size_t>(tilesX) * tilesY * tileSize * tileSize),
+    tileSlots(static_cast<size_t>(tilesX) * tilesY), slotTiles(static_cast<size_t>(tilesX) * tilesY) {
+
+    // Plocice se sortiraju po Morton kodu; slika ne mora biti kvadrat ni stepen dvojke, pa mjesta nema praznina
+    for (size_t i = 0; i < slotTiles.size(); ++i)
+        slotTiles[i] = static_cast<uint32_t>(i);
+    const int columns = tilesX;
+    std::sort(slotTiles.begin(), slotTiles.end(), [columns](uint32_t a, uint32_t b) {
+        return mortonCode(a % columns, a / columns) < mortonCode(b % columns, b / columns);
+    });
+    for (size_t slot = 0; slot < slotTiles.size(); ++slot)
+        tileSlots[slotTiles[slot]] = static_cast<uint32_t>(slot);
+}
+
+// Kopiranje red po red unutar svake plocice (tileSize uzastopnih piksela odjednom)
+template <typename PixelT>
+void toTiled(const BasicImage<PixelT>& image, BasicTiledImage<PixelT>& tiled) {
+    TRACE_SCOPE("toTiled");
+    const int tileSize = BasicTiledImage<PixelT>::tileSize;
+    if (image.width != tiled.width || image.height != tiled.height) {
+        std::cerr << "Slika i slika po plocicama moraju imati iste dimenzije." << std::endl;
+        return;
+    }
+
+#pragma omp parallel for
+    for (int index = 0; index < tiled.tilesX * tiled.tilesY; ++index) {
+        int tx = index % tiled.tilesX, ty = index / tiled.tilesX;
+        PixelT* target = tiled.tile(tx, ty);
+        int rows = std::min(tileSize, image.height - ty * tileSize);
+        int columns = std::min(tileSize, image.width - tx * tileSize);
+        for (int y = 0; y < rows; ++y) {
+            const PixelT* source = &image.pixels[static_cast<size_t>(ty * tileSize + y) * image.width + tx * tileSize];
+            std::copy(source, source + columns, target + y * tileSize);
+        }
+    }
+}
+
+template <typename PixelT>
+void fromTiled(const BasicTiledImage<PixelT>& tiled, BasicImage<PixelT>& image) {
+    TRACE_SCOPE("fromTiled");
+    const int tileSize = BasicTiledImage<PixelT>::tileSize;
+    if (image.width != tiled.width || image.height != tiled.height) {
+        std::cerr << "Slika i slika po plocicama moraju imati iste dimenzije." << std::endl;
+        return;
+    }
+
+#pragma omp parallel for
+    for (int index = 0; index < tiled.tilesX * tiled.tilesY; ++index) {
+        int tx = index % tiled.tilesX, ty = index / tiled.tilesX;
+        const PixelT* source = tiled.tile(tx, ty);
+        int rows = std::min(tileSize, image.height - ty * tileSize);
+        int columns = std::min(tileSize, image.width - tx * tileSize);
+        for (int y = 0; y < rows; ++y)
+            std::copy(source + y * tileSize, source + y * tileSize + columns, &image.pixels[static_cast<size_t>(ty * tileSize + y) * image.width + tx * tileSize]);
+    }
+}
+
+template struct BasicTiledImage<Gray>;
+template struct BasicTiledImage<Color>;
+template struct BasicTiledImage<ColorA>;
+
+template void toTiled<Gray>(const GrayImage&, GrayTiledImage&);
+template void toTiled<Color>(const Image&, TiledImage&);
+template void toTiled<ColorA>(const ImageBGRA&, TiledImageBGRA&);
+
+template void fromTiled<Gray>(const GrayTiledImage&, GrayImage&);
+template void fromTiled<Color>(const TiledImage&, Image&);
+template void fromTiled<ColorA>(const TiledImageBGRA&, ImageBGRA&);
+
+void convolution(const TiledImage& input, const std::vector<float>& kernel, TiledImage& output, BorderMode border) {
+    convolutionTiledLayout(input, kernel, output, border);
+}
+
+void convolution(const GrayTiledImage& input, const std::vector<float>& kernel, GrayTiledImage& output, BorderMode border) {
+    convolutionTiledLayout(input, kernel, output, border);
+}
+
+void convolution(const TiledImageBGRA& input, const std::vector<float>& kernel, TiledImageBGRA& output, BorderMode border) {
+    convolutionTiledLayout(input, kernel, output, border);
+}
+
+/*
+    Benchmark rasporeda piksela: ista slika (podrazumijevano 16384 piksela u sirinu) se konvoluira kao obicna slika
+    (red po red) i kao slika po plocicama, sa 3x3 i 9x9 kernelom. Kernel nije ugradjen (nije u KernelLibrary),
+    pa obje strane racunaju istom opstom petljom (PixelSum), a razlika u vremenu dolazi samo od rasporeda;
+    npr. 3x3 box kernel bi red po red isao kroz razvijeni convolutionFixed<box3>. Za svako mjerenje se ispisuje najbolje vrijeme
+    od `repetitions` ponavljanja i hardverski brojaci tog mjerenja (promasaji u TLB-u, L1D i LLC kesu, IPC),
+    ako su dostupni (Linux, perf_event_open). Rezultati oba rasporeda se porede piksel po piksel.
+    Vrijeme pretvaranja iz jednog rasporeda u drugi se ispisuje posebno, jer se isplati samo ako se slika
+    u rasporedu po plocicama obradjuje vise puta (npr. pipeline ili vise kernela).
+*/
+int runLayoutBenchmark(int width, int height, int repetitions) {
+    typedef std::chrono::steady_clock Clock;
+
+    Image image(width, height);
+    for (Color& pixel : image.pixels)
+        pixel = Color(static_cast<uint8_t>(rand()), static_cast<uint8_t>(rand()), static_cast<uint8_t>(rand()));
+
+    TiledImage tiled(width, height), tiledOutput(width, height);
+    Clock::time_point start = Clock::now();
+    toTiled(image, tiled);
+    double toMilliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    std::unique_ptr<PerfCounters> counters(new PerfCounters());
+    if (!counters->available()) {
+        std::cout << "Hardverski brojaci nisu dostupni (" << counters->unavailableReason() << "), ispisuje se samo vrijeme." << std::endl;
+        counters.reset();
+    }
+
+    std::cout << "Slika " << width << "x" << height << ", plocice " << TiledImage::tileSize << "x" << TiledImage::tileSize
+        << ", pretvaranje u plocice: " << std::fixed << std::setprecision(2) << toMilliseconds << " ms" << std::endl;
+    std::cout << std::left << std::setw(12) << "raspored" << std::right << std::setw(7) << "kernel" << std::setw(12) << "ms";
+    if (counters)
+        std::cout << std::setw(16) << "dTLB promasaji" << std::setw(16) << "L1D promasaji" << std::setw(16) << "LLC promasaji" << std::setw(8) << "IPC";
+    std::cout << std::endl;
+
+    Image output(width, height), converted(width, height);
+    bool identical = true;
+
+    for (int kernelSize : { 3, 9 }) {
+        // Neujednacene pozitivne tezine sa zbirom 1: ne poklapaju se ni sa jednim kernelom iz KernelLibrary
+        std::vector<float> kernel(static_cast<size_t>(kernelSize) * kernelSize);
+        float total = 0.0f;
+        for (size_t i = 0; i < kernel.size(); ++i)
+            total += kernel[i] = 1.0f + static_cast<float>(i * 7 % 5);
+        for (float& weight : kernel)
+            weight /= total;
+
+        for (int layout = 0; layout < 2; ++layout) {
+            double best = 0.0;
+            PerfCounterValues bestValues;
+            for (int repetition = 0; repetition < std::max(1, repetitions); ++repetition) {
+                if (counters)
+                    counters->start();
+                start = Clock::now();
+                if (layout == 0)
+                    convolution(image, kernel, output);
+                else
+                    convolution(tiled, kernel, tiledOutput);
+                double milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+                PerfCounterValues values = counters ? counters->stop() : PerfCounterValues();
+
+                if (repetition == 0 || milliseconds < best) {
+                    best = milliseconds;
+                    bestValues = values;
+                }
+            }
+            printLayoutResult(layout == 0 ? "red po red" : "plocice", kernelSize, best, bestValues);
+        }
+
+        fromTiled(tiledOutput, converted);
+        identical = identical && memcmp(converted.pixels.data(), output.pixels.data(), output.pixels.size() * sizeof(Color)) == 0;
+    }
+
+    start = Clock::now();
+    fromTiled(tiledOutput, converted);
+    std::cout << "Pretvaranje iz plocica: " << std::chrono::duration<double, std::milli>(Clock::now() - start).count() << " ms" << std::endl;
+    std::cout << (identical ? "Rezultati oba rasporeda su identicni." : "GRESKA: rezultati rasporeda se razlikuju!") << std::endl;
+    return identical ? EXIT_SUCCESS : EXIT_FAILURE;
+}
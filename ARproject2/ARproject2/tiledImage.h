@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "image.h"
+#include "convolution.h"
+
+/*
+    Slika sa pikselima po plocicama (tiled layout): slika se dijeli na kvadrate od tileSize x tileSize piksela,
+    svaka plocica je jedan neprekidan blok memorije (unutar plocice pikseli su red po red), a plocice su u memoriji
+    poredane po Z-krivoj (Morton redoslijed) nad koordinatama plocica. Kod obicne slike (red po red) vertikalni
+    susjed je udaljen cijeli red (za sirinu od 16K piksela to je 48 KB, dakle druga memorijska stranica i drugi
+    unos u TLB-u za svaki red prozora kernela); ovdje su vertikalni i horizontalni susjedi u istoj plocici
+    (3 ili 4 KB, jedna stranica), a susjedne plocice su i u memoriji uglavnom blizu.
+    Plocice na desnom i donjem rubu su pune velicine; pikseli van slike se ne koriste.
+*/
+template <typename PixelT>
+struct BasicTiledImage {
+
+    static const int tileSize = 32;
+
+    int width, height;
+    int tilesX, tilesY;
+    std::vector<PixelT> pixels;          // plocice jedna za drugom, tileSize * tileSize piksela svaka
+    std::vector<uint32_t> tileSlots;     // mjesto plocice (tx, ty) u memoriji, indeks ty * tilesX + tx
+    std::vector<uint32_t> slotTiles;     // obrnuto: indeks plocice (ty * tilesX + tx) na datom mjestu u memoriji
+
+    BasicTiledImage(int w, int h);
+
+    PixelT* tile(int tx, int ty) { return &pixels[static_cast<size_t>(tileSlots[ty * tilesX + tx]) * tileSize * tileSize]; }
+    const PixelT* tile(int tx, int ty) const { return &pixels[static_cast<size_t>(tileSlots[ty * tilesX + tx]) * tileSize * tileSize]; }
+
+    PixelT& at(int x, int y) { return tile(x / tileSize, y / tileSize)[(y % tileSize) * tileSize + x % tileSize]; }
+    const PixelT& at(int x, int y) const { return tile(x / tileSize, y / tileSize)[(y % tileSize) * tileSize + x % tileSize]; }
+};
+
+typedef BasicTiledImage<Color> TiledImage;
+typedef BasicTiledImage<Gray> GrayTiledImage;
+typedef BasicTiledImage<ColorA> TiledImageBGRA;
+
+// Pretvaranje iz obicne slike u sliku po plocicama i nazad (dimenzije moraju biti iste)
+template <typename PixelT>
+void toTiled(const BasicImage<PixelT>& , BasicTiledImage<PixelT>& );
+
+template <typename PixelT>
+void fromTiled(const BasicTiledImage<PixelT>& , BasicImage<PixelT>& );
+
+// Konvolucija nad slikom po plocicama (isti rezultat kao convolution() nad obicnom slikom)
+void convolution(const TiledImage& , const std::vector<float>& , TiledImage& , BorderMode = BorderMode::Replicate);
+
+void convolution(const GrayTiledImage& , const std::vector<float>& , GrayTiledImage& , BorderMode = BorderMode::Replicate);
+
+void convolution(const TiledImageBGRA& , const std::vector<float>& , TiledImageBGRA& , BorderMode = BorderMode::Replicate);
+
+// Poredjenje rasporeda (red po red i po plocicama) na sirokoj slici: vrijeme, promasaji u kesu i TLB-u
+int runLayoutBenchmark(int , int , int );
@@ -0,0 +1,202 @@
+#include "tracing.h"
+
+#ifdef CONVOLUTION_TRACING
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+
+    struct TraceEvent {
+        const char* name;
+        const char* category;
+        int thread;
+        double start, duration;  // mikrosekunde
+        long long pixels, bytesRead, bytesWritten;
+    };
+
+    struct ThreadUsage {
+        double busy = 0, idle = 0;
+    };
+
+    /*
+        Globalni zapis dogadjaja. Dogadjaji su grubi (po fazi i po niti paralelnog regiona, ne po pikselu),
+        pa je upis pod mutexom zanemarljiv u odnosu na posao koji se mjeri.
+        Destruktor se poziva pri normalnom zavrsetku programa i tada se ispisuje izvjestaj.
+    */
+    struct TraceLog {
+        std::mutex mutex;
+        std::vector<TraceEvent> events;
+        std::map<std::string, std::map<int, ThreadUsage>> threadUsage;
+        std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+
+        void add(const TraceEvent& event) {
+            std::lock_guard<std::mutex> lock(mutex);
+            events.push_back(event);
+        }
+
+        void writeChromeTrace(const std::string& path) {
+            std::ofstream file(path);
+            if (!file) {
+                std::cerr << "Nije moguce upisati trace fajl: " << path << std::endl;
+                return;
+            }
+
+            file << "{\"traceEvents\":[\n";
+            for (size_t i = 0; i < events.size(); ++i) {
+                const TraceEvent& event = events[i];
+                file << "{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category << "\",\"ph\":\"X\""
+                    << ",\"pid\":1,\"tid\":" << event.thread
+                    << std::fixed << std::setprecision(3)
+                    << ",\"ts\":" << event.start << ",\"dur\":" << event.duration
+                    << ",\"args\":{\"pixels\":" << event.pixels
+                    << ",\"bytesRead\":" << event.bytesRead
+                    << ",\"bytesWritten\":" << event.bytesWritten << "}}"
+                    << (i + 1 < events.size() ? ",\n" : "\n");
+            }
+            file << "],\"displayTimeUnit\":\"ms\"}\n";
+        }
+
+        void printSummary(std::ostream& out) {
+            struct StageTotals {
+                long long count = 0, pixels = 0, bytesRead = 0, bytesWritten = 0;
+                double microseconds = 0;
+            };
+            std::map<std::string, StageTotals> stages;
+            for (const TraceEvent& event : events) {
+                if (std::string(event.category) != "stage")
+                    continue;
+                StageTotals& totals = stages[event.name];
+                ++totals.count;
+                totals.microseconds += event.duration;
+                totals.pixels += event.pixels;
+                totals.bytesRead += event.bytesRead;
+                totals.bytesWritten += event.bytesWritten;
+            }
+
+            out << std::left << std::setw(28) << "Faza" << std::right
+                << std::setw(8) << "Poziva" << std::setw(14) << "Ukupno ms" << std::setw(12) << "MPix/s"
+                << std::setw(14) << "Procitano MB" << std::setw(14) << "Upisano MB" << std::endl;
+            out << std::fixed << std::setprecision(2);
+            for (const auto& stage : stages) {
+                const StageTotals& totals = stage.second;
+                double mpixPerSecond = totals.microseconds > 0 ? totals.pixels / totals.microseconds : 0.0;
+                out << std::left << std::setw(28) << stage.first << std::right
+                    << std::setw(8) << totals.count << std::setw(14) << totals.microseconds / 1000.0
+                    << std::setw(12) << mpixPerSecond
+                    << std::setw(14) << totals.bytesRead / 1e6 << std::setw(14) << totals.bytesWritten / 1e6 << std::endl;
+            }
+
+            for (const auto& region : threadUsage) {
+                out << "Paralelni region " << region.first << ":" << std::endl;
+                for (const auto& thread : region.second) {
+                    double total = thread.second.busy + thread.second.idle;
+                    out << "  nit " << std::setw(3) << thread.first
+                        << "  radi " << std::setw(10) << thread.second.busy / 1000.0 << " ms"
+                        << "  ceka " << std::setw(10) << thread.second.idle / 1000.0 << " ms"
+                        << "  (" << (total > 0 ? 100.0 * thread.second.busy / total : 0.0) << "% zauzeta)" << std::endl;
+                }
+            }
+        }
+
+        ~TraceLog() {
+            if (events.empty())
+                return;
+            const char* path = std::getenv("CONVOLUTION_TRACE_FILE");
+            writeChromeTrace(path ? path : "convolution_trace.json");
+            printSummary(std::cerr);
+        }
+    };
+
+    TraceLog& traceLog() {
+        static TraceLog log;
+        return log;
+    }
+
+    // Redni broj sistemske niti (za Chrome trace), dodijeljen pri prvom dogadjaju u toj niti
+    int currentThread() {
+        static std::atomic<int> nextThread(0);
+        thread_local int thread = nextThread++;
+        return thread;
+    }
+
+    // Indeks niti unutar OpenMP regiona
+    int teamThread() {
+#ifdef _OPENMP
+        return omp_get_thread_num();
+#else
+        return 0;
+#endif
+    }
+}
+
+namespace Tracing {
+
+    double nowMicroseconds() {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - traceLog().origin).count();
+    }
+
+    ScopedTimer::ScopedTimer(const char* name) : name(name), start(nowMicroseconds()) {}
+
+    ScopedTimer::~ScopedTimer() {
+        TraceEvent event = { name, "stage", currentThread(), start, nowMicroseconds() - start, pixels, bytesRead, bytesWritten };
+        traceLog().add(event);
+    }
+
+    ParallelRegion::ParallelRegion(const char* name) : name(name), start(nowMicroseconds()) {
+#ifdef _OPENMP
+        int threads = omp_get_max_threads();
+#else
+        int threads = 1;
+#endif
+        busyStart.assign(threads, -1.0);
+        busyEnd.assign(threads, -1.0);
+        systemThread.assign(threads, 0);
+    }
+
+    void ParallelRegion::recordBusy(int thread, double from, double to) {
+        if (thread >= 0 && thread < static_cast<int>(busyStart.size())) {
+            busyStart[thread] = from;
+            busyEnd[thread] = to;
+            systemThread[thread] = currentThread();
+        }
+    }
+
+    // Nit je neaktivna od pocetka regiona do pocetka svog rada i od kraja svog rada do kraja regiona (barijera)
+    ParallelRegion::~ParallelRegion() {
+        double end = nowMicroseconds();
+        TraceLog& log = traceLog();
+        std::lock_guard<std::mutex> lock(log.mutex);
+        for (size_t thread = 0; thread < busyStart.size(); ++thread) {
+            if (busyStart[thread] < 0)
+                continue;
+            double busy = busyEnd[thread] - busyStart[thread];
+            TraceEvent event = { name, "thread", systemThread[thread], busyStart[thread], busy, 0, 0, 0 };
+            log.events.push_back(event);
+
+            ThreadUsage& usage = log.threadUsage[name][static_cast<int>(thread)];
+            usage.busy += busy;
+            usage.idle += (end - start) - busy;
+        }
+    }
+
+    ThreadBusy::ThreadBusy(ParallelRegion& region) : region(region), start(nowMicroseconds()) {}
+
+    ThreadBusy::~ThreadBusy() {
+        region.recordBusy(teamThread(), start, nowMicroseconds());
+    }
+}
+
+#endif
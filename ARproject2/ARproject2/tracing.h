@@ -0,0 +1,94 @@
+#pragma once
+
+/*
+    Instrumentacija za mjerenje pojedinih faza obrade (ucitavanje, konvolucija, omotavanje u cv::Mat, cuvanje).
+    Ukljucuje se definisanjem makroa CONVOLUTION_TRACING prilikom kompajliranja.
+    Bez tog makroa svi TRACE_* makroi su prazni i ne generisu nikakav kod, pa instrumentacija
+    moze ostati i u produkcionom buildu.
+
+    Kada je ukljucena, na kraju programa se na stderr ispisuje tabela sa vremenom, MPix/s i procitanim/upisanim
+    bajtovima po fazi, kao i zauzetost i neaktivnost svake niti u paralelnim petljama, a svi dogadjaji se upisuju
+    u JSON fajl u Chrome trace formatu (chrome://tracing, Perfetto). Ime fajla se zadaje promjenljivom
+    okruzenja CONVOLUTION_TRACE_FILE (podrazumijevano convolution_trace.json).
+
+    Upotreba:
+        TRACE_SCOPE("saveBMP");            // mjeri vrijeme do kraja bloka
+        TRACE_PIXELS(width * height);      // broj piksela obradjenih u tom bloku (za MPix/s)
+        TRACE_BYTES_WRITTEN(bytes);
+
+        TRACE_PARALLEL_REGION("convolution");
+    #pragma omp parallel
+        {
+            TRACE_THREAD_BUSY();           // mjeri koliko je nit radila unutar regiona
+    #pragma omp for nowait
+            ...
+        }
+*/
+
+#ifdef CONVOLUTION_TRACING
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace Tracing {
+
+    double nowMicroseconds();
+
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(const char* );
+        ~ScopedTimer();
+
+        long long pixels = 0;
+        long long bytesRead = 0;
+        long long bytesWritten = 0;
+
+    private:
+        const char* name;
+        double start;
+    };
+
+    // Paralelni region: biljezi vrijeme rada svake niti i na kraju racuna koliko je koja nit cekala
+    class ParallelRegion {
+    public:
+        explicit ParallelRegion(const char* );
+        ~ParallelRegion();
+
+        void recordBusy(int , double , double );
+
+    private:
+        const char* name;
+        double start;
+        std::vector<double> busyStart, busyEnd;
+        std::vector<int> systemThread;
+    };
+
+    class ThreadBusy {
+    public:
+        explicit ThreadBusy(ParallelRegion& );
+        ~ThreadBusy();
+
+    private:
+        ParallelRegion& region;
+        double start;
+    };
+}
+
+#define TRACE_SCOPE(name) Tracing::ScopedTimer traceScope(name)
+#define TRACE_PIXELS(count) (traceScope.pixels += static_cast<long long>(count))
+#define TRACE_BYTES_READ(count) (traceScope.bytesRead += static_cast<long long>(count))
+#define TRACE_BYTES_WRITTEN(count) (traceScope.bytesWritten += static_cast<long long>(count))
+#define TRACE_PARALLEL_REGION(name) Tracing::ParallelRegion traceRegion(name)
+#define TRACE_THREAD_BUSY() Tracing::ThreadBusy traceBusy(traceRegion)
+
+#else
+
+#define TRACE_SCOPE(name)
+#define TRACE_PIXELS(count)
+#define TRACE_BYTES_READ(count)
+#define TRACE_BYTES_WRITTEN(count)
+#define TRACE_PARALLEL_REGION(name)
+#define TRACE_THREAD_BUSY()
+
+#endif